@@ -0,0 +1,306 @@
+#include "AgrupadorEscrita.h"
+
+#include <string.h>
+
+#include "pico/time.h"
+
+namespace cartao_sd {
+
+AgrupadorEscrita::AgrupadorEscrita(DispositivoBloco &dispositivo_inferior)
+    : dispositivoInferior(dispositivo_inferior),
+      habilitado(false),
+      prazoDescargaMs(CARTAO_SD_PRAZO_AGRUPAMENTO_MS),
+      inicioPendenciaUs(0u),
+      falhaDescargaPendente(false),
+      estatisticas{},
+      quantidadePendentes(0u),
+      setoresPendentes{},
+      dadosPendentes{} {
+}
+
+bool AgrupadorEscrita::iniciar() {
+    if (dispositivoInferior.estaInicializado()) {
+        descarregar();
+    }
+
+    quantidadePendentes = 0u;
+    falhaDescargaPendente = false;
+    return dispositivoInferior.iniciar();
+}
+
+bool AgrupadorEscrita::estaInicializado() const {
+    return dispositivoInferior.estaInicializado();
+}
+
+bool AgrupadorEscrita::lerSetores(uint8_t *destino, uint32_t setor_inicial, uint32_t quantidade) {
+    if (destino == nullptr) {
+        return false;
+    }
+
+    if (quantidade == 0u) {
+        return true;
+    }
+
+    verificarPrazo();
+
+    if (quantidade == 1u) {
+        int32_t indice_pendente = buscarPendente(setor_inicial);
+        if (indice_pendente >= 0) {
+            memcpy(destino, dadosPendentes + (indice_pendente * TAMANHO_SETOR_DISPOSITIVO), TAMANHO_SETOR_DISPOSITIVO);
+            return true;
+        }
+    }
+
+    if (!dispositivoInferior.lerSetores(destino, setor_inicial, quantidade)) {
+        return false;
+    }
+
+    // Setores ainda no buffer são mais novos que o conteúdo do cartão.
+    for (size_t indice = 0; indice < quantidadePendentes; indice = indice + 1) {
+        uint32_t setor = setoresPendentes[indice];
+        if (setor < setor_inicial || setor - setor_inicial >= quantidade) {
+            continue;
+        }
+        memcpy(destino + ((setor - setor_inicial) * TAMANHO_SETOR_DISPOSITIVO),
+               dadosPendentes + (indice * TAMANHO_SETOR_DISPOSITIVO),
+               TAMANHO_SETOR_DISPOSITIVO);
+    }
+
+    return true;
+}
+
+bool AgrupadorEscrita::escreverSetores(const uint8_t *origem, uint32_t setor_inicial, uint32_t quantidade) {
+    if (origem == nullptr) {
+        return false;
+    }
+
+    if (quantidade == 0u) {
+        return true;
+    }
+
+    // Rajadas do tamanho do buffer já saem contíguas; o que estava pendente
+    // no mesmo intervalo fica obsoleto e é descartado.
+    if (!habilitado || quantidade >= CAPACIDADE_SETORES) {
+        descartarIntervalo(setor_inicial, setor_inicial + quantidade - 1u);
+        return dispositivoInferior.escreverSetores(origem, setor_inicial, quantidade);
+    }
+
+    // Tudo ou nada: se os setores novos não cabem, descarrega antes de copiar
+    // qualquer um, para uma falha não deixar parte do pedido na fila.
+    size_t setores_novos = 0u;
+    for (uint32_t deslocamento = 0; deslocamento < quantidade; deslocamento = deslocamento + 1) {
+        if (buscarPendente(setor_inicial + deslocamento) < 0) {
+            setores_novos = setores_novos + 1u;
+        }
+    }
+
+    if (quantidadePendentes + setores_novos > CAPACIDADE_SETORES) {
+        estatisticas.descargas_cheio = estatisticas.descargas_cheio + 1u;
+        if (!descarregar()) {
+            return false;
+        }
+    }
+
+    estatisticas.setores_recebidos = estatisticas.setores_recebidos + quantidade;
+
+    for (uint32_t deslocamento = 0; deslocamento < quantidade; deslocamento = deslocamento + 1) {
+        uint32_t setor = setor_inicial + deslocamento;
+        const uint8_t *dados = origem + (deslocamento * TAMANHO_SETOR_DISPOSITIVO);
+
+        int32_t indice_pendente = buscarPendente(setor);
+        if (indice_pendente < 0) {
+            if (quantidadePendentes == 0u) {
+                inicioPendenciaUs = time_us_64();
+            }
+
+            indice_pendente = static_cast<int32_t>(quantidadePendentes);
+            setoresPendentes[quantidadePendentes] = setor;
+            quantidadePendentes = quantidadePendentes + 1u;
+        }
+
+        memcpy(dadosPendentes + (indice_pendente * TAMANHO_SETOR_DISPOSITIVO), dados, TAMANHO_SETOR_DISPOSITIVO);
+    }
+
+    // Esta escrita já está no buffer; uma falha ao descarregar as anteriores
+    // fica para o próximo CTRL_SYNC.
+    verificarPrazo();
+    return true;
+}
+
+bool AgrupadorEscrita::apagarSetores(uint32_t setor_inicial, uint32_t setor_final) {
+    descartarIntervalo(setor_inicial, setor_final);
+    return dispositivoInferior.apagarSetores(setor_inicial, setor_final);
+}
+
+bool AgrupadorEscrita::sincronizar() {
+    if (quantidadePendentes > 0u) {
+        estatisticas.descargas_sincronizacao = estatisticas.descargas_sincronizacao + 1u;
+    }
+
+    bool descarregou = descarregar() && !falhaDescargaPendente;
+    falhaDescargaPendente = false;
+    bool sincronizou = dispositivoInferior.sincronizar();
+    return descarregou && sincronizou;
+}
+
+uint64_t AgrupadorEscrita::obterQuantidadeSetores() const {
+    return dispositivoInferior.obterQuantidadeSetores();
+}
+
+uint32_t AgrupadorEscrita::obterSetoresUnidadeAlocacao() const {
+    return dispositivoInferior.obterSetoresUnidadeAlocacao();
+}
+
+void AgrupadorEscrita::definirHabilitado(bool habilitar) {
+    if (!habilitar && !descarregar()) {
+        falhaDescargaPendente = true;
+    }
+    habilitado = habilitar;
+}
+
+bool AgrupadorEscrita::estaHabilitado() const {
+    return habilitado;
+}
+
+void AgrupadorEscrita::definirPrazoDescarga(uint32_t prazo_ms) {
+    prazoDescargaMs = prazo_ms;
+}
+
+uint32_t AgrupadorEscrita::obterPrazoDescarga() const {
+    return prazoDescargaMs;
+}
+
+bool AgrupadorEscrita::verificarPrazo() {
+    // Prazo zero deixa a descarga só para o CTRL_SYNC e o buffer cheio.
+    if (quantidadePendentes == 0u || prazoDescargaMs == 0u) {
+        return true;
+    }
+
+    uint64_t decorrido_us = time_us_64() - inicioPendenciaUs;
+    if (decorrido_us < static_cast<uint64_t>(prazoDescargaMs) * 1000u) {
+        return true;
+    }
+
+    estatisticas.descargas_prazo = estatisticas.descargas_prazo + 1u;
+    if (!descarregar()) {
+        falhaDescargaPendente = true;
+        return false;
+    }
+    return true;
+}
+
+EstatisticasAgrupamento AgrupadorEscrita::obterEstatisticas() const {
+    return estatisticas;
+}
+
+void AgrupadorEscrita::zerarEstatisticas() {
+    estatisticas = EstatisticasAgrupamento{};
+}
+
+int32_t AgrupadorEscrita::buscarPendente(uint32_t setor) const {
+    for (size_t indice = 0; indice < quantidadePendentes; indice = indice + 1) {
+        if (setoresPendentes[indice] == setor) {
+            return static_cast<int32_t>(indice);
+        }
+    }
+    return -1;
+}
+
+void AgrupadorEscrita::removerPendente(size_t indice) {
+    size_t ultimo = quantidadePendentes - 1u;
+    if (indice != ultimo) {
+        setoresPendentes[indice] = setoresPendentes[ultimo];
+        memcpy(dadosPendentes + (indice * TAMANHO_SETOR_DISPOSITIVO),
+               dadosPendentes + (ultimo * TAMANHO_SETOR_DISPOSITIVO),
+               TAMANHO_SETOR_DISPOSITIVO);
+    }
+    quantidadePendentes = ultimo;
+}
+
+void AgrupadorEscrita::descartarIntervalo(uint32_t setor_inicial, uint32_t setor_final) {
+    size_t indice = 0;
+    while (indice < quantidadePendentes) {
+        uint32_t setor = setoresPendentes[indice];
+        if (setor >= setor_inicial && setor <= setor_final) {
+            removerPendente(indice);
+        } else {
+            indice = indice + 1;
+        }
+    }
+}
+
+void AgrupadorEscrita::ordenarPendentes() {
+    // Ordenação por seleção: poucas comparações importam menos que mover
+    // cada setor de 512 bytes no máximo uma vez.
+    uint8_t temporario[TAMANHO_SETOR_DISPOSITIVO];
+
+    for (size_t indice = 0; indice + 1u < quantidadePendentes; indice = indice + 1) {
+        size_t menor = indice;
+        for (size_t candidato = indice + 1u; candidato < quantidadePendentes; candidato = candidato + 1) {
+            if (setoresPendentes[candidato] < setoresPendentes[menor]) {
+                menor = candidato;
+            }
+        }
+
+        if (menor == indice) {
+            continue;
+        }
+
+        uint32_t setor = setoresPendentes[indice];
+        setoresPendentes[indice] = setoresPendentes[menor];
+        setoresPendentes[menor] = setor;
+
+        uint8_t *dados_indice = dadosPendentes + (indice * TAMANHO_SETOR_DISPOSITIVO);
+        uint8_t *dados_menor = dadosPendentes + (menor * TAMANHO_SETOR_DISPOSITIVO);
+        memcpy(temporario, dados_indice, TAMANHO_SETOR_DISPOSITIVO);
+        memcpy(dados_indice, dados_menor, TAMANHO_SETOR_DISPOSITIVO);
+        memcpy(dados_menor, temporario, TAMANHO_SETOR_DISPOSITIVO);
+    }
+}
+
+bool AgrupadorEscrita::descarregar() {
+    if (quantidadePendentes == 0u) {
+        return true;
+    }
+
+    ordenarPendentes();
+
+    uint32_t setores_au = dispositivoInferior.obterSetoresUnidadeAlocacao();
+    size_t inicio = 0;
+
+    while (inicio < quantidadePendentes) {
+        size_t fim = inicio + 1u;
+        while (fim < quantidadePendentes) {
+            uint32_t setor = setoresPendentes[fim];
+            bool contiguo = setor == setoresPendentes[fim - 1u] + 1u;
+            bool nova_au = setores_au > 0u && (setor % setores_au) == 0u;
+            if (!contiguo || nova_au) {
+                break;
+            }
+            fim = fim + 1u;
+        }
+
+        uint32_t quantidade = static_cast<uint32_t>(fim - inicio);
+        if (!dispositivoInferior.escreverSetores(dadosPendentes + (inicio * TAMANHO_SETOR_DISPOSITIVO),
+                                                 setoresPendentes[inicio],
+                                                 quantidade)) {
+            // Mantém só o que ainda não foi gravado para uma nova tentativa.
+            size_t restantes = quantidadePendentes - inicio;
+            memmove(setoresPendentes, setoresPendentes + inicio, restantes * sizeof(setoresPendentes[0]));
+            memmove(dadosPendentes,
+                    dadosPendentes + (inicio * TAMANHO_SETOR_DISPOSITIVO),
+                    restantes * TAMANHO_SETOR_DISPOSITIVO);
+            quantidadePendentes = restantes;
+            return false;
+        }
+
+        estatisticas.rajadas = estatisticas.rajadas + 1u;
+        estatisticas.setores_gravados = estatisticas.setores_gravados + quantidade;
+        inicio = fim;
+    }
+
+    quantidadePendentes = 0u;
+    return true;
+}
+
+} // namespace cartao_sd
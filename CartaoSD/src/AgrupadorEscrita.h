@@ -0,0 +1,79 @@
+#ifndef AGRUPADORESCRITA_H
+#define AGRUPADORESCRITA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "DispositivoBloco.h"
+
+#ifndef CARTAO_SD_SETORES_AGRUPADOS
+#define CARTAO_SD_SETORES_AGRUPADOS 16
+#endif
+
+#ifndef CARTAO_SD_PRAZO_AGRUPAMENTO_MS
+#define CARTAO_SD_PRAZO_AGRUPAMENTO_MS 500
+#endif
+
+namespace cartao_sd {
+
+struct EstatisticasAgrupamento {
+    uint32_t setores_recebidos;
+    uint32_t setores_gravados;
+    uint32_t rajadas;
+    uint32_t descargas_sincronizacao;
+    uint32_t descargas_cheio;
+    uint32_t descargas_prazo;
+};
+
+// Acumula escritas curtas e as grava ordenadas por setor, agrupando setores
+// contíguos em escritas múltiplas que nunca atravessam a fronteira de uma
+// unidade de alocação (AU) do cartão. A descarga acontece no CTRL_SYNC, com
+// o buffer cheio ou quando a escrita mais antiga passa do prazo. Fica
+// desligado até definirHabilitado(true): com ele, uma escrita aceita pode
+// levar até o prazo para chegar ao cartão.
+class AgrupadorEscrita : public DispositivoBloco {
+public:
+    explicit AgrupadorEscrita(DispositivoBloco &dispositivo_inferior);
+
+    bool iniciar() override;
+    bool estaInicializado() const override;
+    bool lerSetores(uint8_t *destino, uint32_t setor_inicial, uint32_t quantidade) override;
+    bool escreverSetores(const uint8_t *origem, uint32_t setor_inicial, uint32_t quantidade) override;
+    bool apagarSetores(uint32_t setor_inicial, uint32_t setor_final) override;
+    bool sincronizar() override;
+    uint64_t obterQuantidadeSetores() const override;
+    uint32_t obterSetoresUnidadeAlocacao() const override;
+
+    void definirHabilitado(bool habilitar);
+    bool estaHabilitado() const;
+    void definirPrazoDescarga(uint32_t prazo_ms);
+    uint32_t obterPrazoDescarga() const;
+    bool verificarPrazo();
+    EstatisticasAgrupamento obterEstatisticas() const;
+    void zerarEstatisticas();
+
+private:
+    static constexpr size_t CAPACIDADE_SETORES = CARTAO_SD_SETORES_AGRUPADOS;
+
+    DispositivoBloco &dispositivoInferior;
+    bool habilitado;
+    uint32_t prazoDescargaMs;
+    uint64_t inicioPendenciaUs;
+    // Falha de uma descarga feita fora do CTRL_SYNC (prazo ou desligamento),
+    // guardada até o próximo sincronizar() para não ser atribuída a outra escrita.
+    bool falhaDescargaPendente;
+    EstatisticasAgrupamento estatisticas;
+    size_t quantidadePendentes;
+    uint32_t setoresPendentes[CAPACIDADE_SETORES];
+    uint8_t dadosPendentes[CAPACIDADE_SETORES * TAMANHO_SETOR_DISPOSITIVO];
+
+    int32_t buscarPendente(uint32_t setor) const;
+    void removerPendente(size_t indice);
+    void descartarIntervalo(uint32_t setor_inicial, uint32_t setor_final);
+    void ordenarPendentes();
+    bool descarregar();
+};
+
+} // namespace cartao_sd
+
+#endif
@@ -0,0 +1,273 @@
+#include "CacheSetores.h"
+
+#include <string.h>
+
+namespace cartao_sd {
+
+CacheSetores::CacheSetores(DispositivoBloco &dispositivo_inferior)
+    : dispositivoInferior(dispositivo_inferior),
+      politica(PoliticaCache::EscritaDireta),
+      estatisticas{},
+      relogioUso(0u),
+      linhas{} {
+}
+
+bool CacheSetores::iniciar() {
+    // Antes de reiniciar o cartão, grava o que ainda estiver pendente.
+    if (dispositivoInferior.estaInicializado()) {
+        descarregarSujas();
+    }
+
+    invalidar();
+    return dispositivoInferior.iniciar();
+}
+
+bool CacheSetores::estaInicializado() const {
+    return dispositivoInferior.estaInicializado();
+}
+
+bool CacheSetores::lerSetores(uint8_t *destino, uint32_t setor_inicial, uint32_t quantidade) {
+    if (destino == nullptr) {
+        return false;
+    }
+
+    if (quantidade == 0u) {
+        return true;
+    }
+
+    if (quantidade == 1u) {
+        LinhaCache *linha = buscarLinha(setor_inicial);
+        if (linha != nullptr) {
+            estatisticas.acertos = estatisticas.acertos + 1u;
+            marcarUso(*linha);
+            memcpy(destino, linha->dados, TAMANHO_SETOR_DISPOSITIVO);
+            return true;
+        }
+
+        estatisticas.falhas = estatisticas.falhas + 1u;
+        linha = reservarLinha();
+        if (linha == nullptr) {
+            return dispositivoInferior.lerSetores(destino, setor_inicial, 1u);
+        }
+
+        if (!dispositivoInferior.lerSetores(linha->dados, setor_inicial, 1u)) {
+            return false;
+        }
+
+        linha->setor = setor_inicial;
+        linha->valida = true;
+        linha->suja = false;
+        marcarUso(*linha);
+        memcpy(destino, linha->dados, TAMANHO_SETOR_DISPOSITIVO);
+        return true;
+    }
+
+    if (!dispositivoInferior.lerSetores(destino, setor_inicial, quantidade)) {
+        return false;
+    }
+
+    // Linhas sujas ainda não chegaram ao cartão e têm o conteúdo mais novo.
+    for (size_t indice = 0; indice < QUANTIDADE_LINHAS; indice = indice + 1) {
+        LinhaCache &linha = linhas[indice];
+        if (!linha.valida || !linha.suja) {
+            continue;
+        }
+        if (linha.setor < setor_inicial || linha.setor - setor_inicial >= quantidade) {
+            continue;
+        }
+        memcpy(destino + ((linha.setor - setor_inicial) * TAMANHO_SETOR_DISPOSITIVO), linha.dados, TAMANHO_SETOR_DISPOSITIVO);
+    }
+
+    return true;
+}
+
+bool CacheSetores::escreverSetores(const uint8_t *origem, uint32_t setor_inicial, uint32_t quantidade) {
+    if (origem == nullptr) {
+        return false;
+    }
+
+    if (quantidade == 0u) {
+        return true;
+    }
+
+    if (quantidade == 1u) {
+        LinhaCache *linha = buscarLinha(setor_inicial);
+        if (linha == nullptr) {
+            linha = reservarLinha();
+        }
+
+        if (linha == nullptr) {
+            return dispositivoInferior.escreverSetores(origem, setor_inicial, 1u);
+        }
+
+        memcpy(linha->dados, origem, TAMANHO_SETOR_DISPOSITIVO);
+        linha->setor = setor_inicial;
+        linha->valida = true;
+        marcarUso(*linha);
+
+        if (politica == PoliticaCache::EscritaAdiada) {
+            linha->suja = true;
+            return true;
+        }
+
+        linha->suja = false;
+        if (!dispositivoInferior.escreverSetores(origem, setor_inicial, 1u)) {
+            linha->valida = false;
+            return false;
+        }
+        return true;
+    }
+
+    bool escreveu = dispositivoInferior.escreverSetores(origem, setor_inicial, quantidade);
+
+    for (size_t indice = 0; indice < QUANTIDADE_LINHAS; indice = indice + 1) {
+        LinhaCache &linha = linhas[indice];
+        if (!linha.valida) {
+            continue;
+        }
+        if (linha.setor < setor_inicial || linha.setor - setor_inicial >= quantidade) {
+            continue;
+        }
+
+        if (escreveu || linha.suja) {
+            // Uma linha suja recebe os dados novos mesmo após falha: parte da
+            // sequência pode já ter chegado ao cartão, e descarregar o conteúdo
+            // antigo depois sobrescreveria o setor mais novo.
+            memcpy(linha.dados, origem + ((linha.setor - setor_inicial) * TAMANHO_SETOR_DISPOSITIVO), TAMANHO_SETOR_DISPOSITIVO);
+            linha.suja = !escreveu;
+        } else {
+            // Depois de uma falha o conteúdo no cartão é incerto.
+            linha.valida = false;
+        }
+    }
+
+    return escreveu;
+}
+
+bool CacheSetores::apagarSetores(uint32_t setor_inicial, uint32_t setor_final) {
+    for (size_t indice = 0; indice < QUANTIDADE_LINHAS; indice = indice + 1) {
+        LinhaCache &linha = linhas[indice];
+        if (linha.valida && linha.setor >= setor_inicial && linha.setor <= setor_final) {
+            linha.valida = false;
+            linha.suja = false;
+        }
+    }
+
+    return dispositivoInferior.apagarSetores(setor_inicial, setor_final);
+}
+
+bool CacheSetores::sincronizar() {
+    bool descarregou = descarregarSujas();
+    bool sincronizou = dispositivoInferior.sincronizar();
+    return descarregou && sincronizou;
+}
+
+uint64_t CacheSetores::obterQuantidadeSetores() const {
+    return dispositivoInferior.obterQuantidadeSetores();
+}
+
+uint32_t CacheSetores::obterSetoresUnidadeAlocacao() const {
+    return dispositivoInferior.obterSetoresUnidadeAlocacao();
+}
+
+void CacheSetores::definirPolitica(PoliticaCache nova_politica) {
+    if (nova_politica == PoliticaCache::EscritaDireta) {
+        descarregarSujas();
+    }
+    politica = nova_politica;
+}
+
+PoliticaCache CacheSetores::obterPolitica() const {
+    return politica;
+}
+
+EstatisticasCache CacheSetores::obterEstatisticas() const {
+    return estatisticas;
+}
+
+void CacheSetores::zerarEstatisticas() {
+    estatisticas = EstatisticasCache{};
+}
+
+void CacheSetores::invalidar() {
+    for (size_t indice = 0; indice < QUANTIDADE_LINHAS; indice = indice + 1) {
+        linhas[indice].valida = false;
+        linhas[indice].suja = false;
+    }
+}
+
+CacheSetores::LinhaCache *CacheSetores::buscarLinha(uint32_t setor) {
+    for (size_t indice = 0; indice < QUANTIDADE_LINHAS; indice = indice + 1) {
+        if (linhas[indice].valida && linhas[indice].setor == setor) {
+            return &linhas[indice];
+        }
+    }
+    return nullptr;
+}
+
+CacheSetores::LinhaCache *CacheSetores::reservarLinha() {
+    LinhaCache *escolhida = nullptr;
+
+    for (size_t indice = 0; indice < QUANTIDADE_LINHAS; indice = indice + 1) {
+        LinhaCache &linha = linhas[indice];
+        if (!linha.valida) {
+            return &linha;
+        }
+        if (escolhida == nullptr || linha.ultimo_uso < escolhida->ultimo_uso) {
+            escolhida = &linha;
+        }
+    }
+
+    if (escolhida == nullptr) {
+        return nullptr;
+    }
+
+    if (escolhida->suja && !gravarLinha(*escolhida)) {
+        return nullptr;
+    }
+
+    estatisticas.despejos = estatisticas.despejos + 1u;
+    escolhida->valida = false;
+    return escolhida;
+}
+
+void CacheSetores::marcarUso(LinhaCache &linha) {
+    relogioUso = relogioUso + 1u;
+    linha.ultimo_uso = relogioUso;
+}
+
+bool CacheSetores::gravarLinha(LinhaCache &linha) {
+    if (!dispositivoInferior.escreverSetores(linha.dados, linha.setor, 1u)) {
+        return false;
+    }
+
+    linha.suja = false;
+    estatisticas.descargas = estatisticas.descargas + 1u;
+    return true;
+}
+
+bool CacheSetores::descarregarSujas() {
+    // Grava em ordem crescente de setor para o cartão receber acessos próximos.
+    for (;;) {
+        LinhaCache *proxima = nullptr;
+        for (size_t indice = 0; indice < QUANTIDADE_LINHAS; indice = indice + 1) {
+            LinhaCache &linha = linhas[indice];
+            if (!linha.valida || !linha.suja) {
+                continue;
+            }
+            if (proxima == nullptr || linha.setor < proxima->setor) {
+                proxima = &linha;
+            }
+        }
+
+        if (proxima == nullptr) {
+            return true;
+        }
+
+        if (!gravarLinha(*proxima)) {
+            return false;
+        }
+    }
+}
+
+} // namespace cartao_sd
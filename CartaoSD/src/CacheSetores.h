@@ -0,0 +1,76 @@
+#ifndef CACHESETORES_H
+#define CACHESETORES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "DispositivoBloco.h"
+
+#ifndef CARTAO_SD_LINHAS_CACHE
+#define CARTAO_SD_LINHAS_CACHE 16
+#endif
+
+namespace cartao_sd {
+
+enum class PoliticaCache : uint8_t {
+    EscritaDireta,
+    EscritaAdiada
+};
+
+struct EstatisticasCache {
+    uint32_t acertos;
+    uint32_t falhas;
+    uint32_t despejos;
+    uint32_t descargas;
+};
+
+// Cache LRU totalmente associativo de setores isolados. Leituras e escritas
+// de vários setores passam direto para o dispositivo inferior, mantendo as
+// linhas já presentes coerentes, para que dados de arquivo em fluxo não
+// expulsem os setores de FAT e de diretório.
+class CacheSetores : public DispositivoBloco {
+public:
+    explicit CacheSetores(DispositivoBloco &dispositivo_inferior);
+
+    bool iniciar() override;
+    bool estaInicializado() const override;
+    bool lerSetores(uint8_t *destino, uint32_t setor_inicial, uint32_t quantidade) override;
+    bool escreverSetores(const uint8_t *origem, uint32_t setor_inicial, uint32_t quantidade) override;
+    bool apagarSetores(uint32_t setor_inicial, uint32_t setor_final) override;
+    bool sincronizar() override;
+    uint64_t obterQuantidadeSetores() const override;
+    uint32_t obterSetoresUnidadeAlocacao() const override;
+
+    void definirPolitica(PoliticaCache nova_politica);
+    PoliticaCache obterPolitica() const;
+    EstatisticasCache obterEstatisticas() const;
+    void zerarEstatisticas();
+    void invalidar();
+
+private:
+    struct LinhaCache {
+        uint32_t setor;
+        uint32_t ultimo_uso;
+        bool valida;
+        bool suja;
+        uint8_t dados[TAMANHO_SETOR_DISPOSITIVO];
+    };
+
+    static constexpr size_t QUANTIDADE_LINHAS = CARTAO_SD_LINHAS_CACHE;
+
+    DispositivoBloco &dispositivoInferior;
+    PoliticaCache politica;
+    EstatisticasCache estatisticas;
+    uint32_t relogioUso;
+    LinhaCache linhas[QUANTIDADE_LINHAS];
+
+    LinhaCache *buscarLinha(uint32_t setor);
+    LinhaCache *reservarLinha();
+    void marcarUso(LinhaCache &linha);
+    bool gravarLinha(LinhaCache &linha);
+    bool descarregarSujas();
+};
+
+} // namespace cartao_sd
+
+#endif
@@ -3,11 +3,27 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "FatFsFlagsArquivo.h"
 #include "FatFsPort.h"
+#include "diskio.h"
+#include "pico/platform.h"
 
 namespace {
 
 constexpr size_t TAMANHO_CAMINHO_TRABALHO = 512u;
+constexpr BYTE FLAG_MODIFICADO_FATFS = CARTAO_SD_FA_MODIFIED;
+// Com FF_FS_TINY o setor do arquivo fica na janela do volume e não em FIL::buf.
+static_assert(FF_FS_TINY == 0, "a escrita direta atualiza FIL::buf");
+constexpr BYTE FLAG_BUFFER_SUJO_FATFS = CARTAO_SD_FA_DIRTY;
+
+FSIZE_t bytesPorSetor(const FATFS* volume) {
+#if FF_MAX_SS != FF_MIN_SS
+    return volume->ssize;
+#else
+    (void)volume;
+    return FF_MAX_SS;
+#endif
+}
 
 void limparInformacoesEntrada(InformacoesEntradaFat &destino) {
     destino.tamanho_bytes = 0u;
@@ -38,6 +54,37 @@ void converterFilinfoParaInformacoes(const FILINFO &origem, InformacoesEntradaFa
 #endif
 }
 
+// Mapas de clusters (CLMT) do fast seek, emprestados aos arquivos abertos só
+// para leitura ou com MODO_ACESSO_ALEATORIO. O primeiro DWORD de cada mapa
+// leva o tamanho, como o f_lseek(CREATE_LINKMAP) espera.
+auto_init_mutex(mutexMapasClusters);
+DWORD mapasClusters[CARTAO_SD_MAPAS_CLUSTERS][CARTAO_SD_ENTRADAS_MAPA_CLUSTERS];
+bool mapaClustersOcupado[CARTAO_SD_MAPAS_CLUSTERS];
+
+DWORD* reservarMapaClusters() {
+    DWORD* mapa = nullptr;
+    mutex_enter_blocking(&mutexMapasClusters);
+    for (size_t indice = 0u; indice < CARTAO_SD_MAPAS_CLUSTERS; indice = indice + 1u) {
+        if (!mapaClustersOcupado[indice]) {
+            mapaClustersOcupado[indice] = true;
+            mapa = mapasClusters[indice];
+            break;
+        }
+    }
+    mutex_exit(&mutexMapasClusters);
+    return mapa;
+}
+
+void devolverMapaClusters(const DWORD* mapa) {
+    mutex_enter_blocking(&mutexMapasClusters);
+    for (size_t indice = 0u; indice < CARTAO_SD_MAPAS_CLUSTERS; indice = indice + 1u) {
+        if (mapasClusters[indice] == mapa) {
+            mapaClustersOcupado[indice] = false;
+        }
+    }
+    mutex_exit(&mutexMapasClusters);
+}
+
 MKFS_PARM converterParametrosFormatacao(const ParametrosFormatacaoFat &origem) {
     MKFS_PARM parametros;
     parametros.fmt = origem.formato;
@@ -52,43 +99,48 @@ MKFS_PARM converterParametrosFormatacao(const ParametrosFormatacaoFat &origem) {
 
 ArquivoSd::ArquivoSd() {
     aberto = false;
-    ehDiretorio = false;
-    ehEntradaEnumerada = false;
-    modoAbertura = 0;
+    modoAbertura = 0u;
+    mapaClusters = nullptr;
+    contiguo = false;
+    setorInicialContiguo = 0u;
     ultimoResultado = FR_OK;
-    memset(caminho, 0, sizeof(caminho));
     memset(&arquivo, 0, sizeof(arquivo));
-    memset(&diretorio, 0, sizeof(diretorio));
-    memset(&infoEntrada, 0, sizeof(infoEntrada));
 }
 
-bool ArquivoSd::validoParaArquivo() {
-    if (!aberto) {
-        CARTAO_SD_LOG("arquivo não está aberto\r\n");
-        return false;
-    }
-    if (ehDiretorio) {
-        CARTAO_SD_LOG("handle é de diretório\r\n");
-        return false;
-    }
-    if (ehEntradaEnumerada) {
-        CARTAO_SD_LOG("entrada de diretório não é arquivo aberto\r\n");
-        return false;
+ArquivoSd::~ArquivoSd() {
+    fechar();
+}
+
+ArquivoSd::ArquivoSd(ArquivoSd &&outro) {
+    assumir(outro);
+}
+
+ArquivoSd &ArquivoSd::operator=(ArquivoSd &&outro) {
+    if (this != &outro) {
+        fechar();
+        assumir(outro);
     }
-    return true;
+    return *this;
+}
+
+// O FIL não aponta para si mesmo (o buffer de setor é interno e o mapa de
+// clusters vem do pool), então mover é copiar e deixar a origem fechada.
+void ArquivoSd::assumir(ArquivoSd &outro) {
+    memcpy(&arquivo, &outro.arquivo, sizeof(arquivo));
+    mapaClusters = outro.mapaClusters;
+    setorInicialContiguo = outro.setorInicialContiguo;
+    ultimoResultado = outro.ultimoResultado;
+    modoAbertura = outro.modoAbertura;
+    aberto = outro.aberto;
+    contiguo = outro.contiguo;
+    outro.mapaClusters = nullptr;
+    outro.contiguo = false;
+    outro.invalidar();
 }
 
-bool ArquivoSd::validoParaDiretorio() {
+bool ArquivoSd::validoParaArquivo() {
     if (!aberto) {
-        CARTAO_SD_LOG("diretório não está aberto\r\n");
-        return false;
-    }
-    if (!ehDiretorio) {
-        CARTAO_SD_LOG("handle não é diretório\r\n");
-        return false;
-    }
-    if (ehEntradaEnumerada) {
-        CARTAO_SD_LOG("entrada enumerada não é diretório aberto\r\n");
+        CARTAO_SD_LOG("arquivo não está aberto\r\n");
         return false;
     }
     return true;
@@ -99,12 +151,8 @@ bool ArquivoSd::fechar() {
         ultimoResultado = FR_OK;
         return true;
     }
-    if (ehEntradaEnumerada) {
-        registrarResultado(FR_OK);
-        invalidar();
-        return true;
-    }
-    FRESULT resultado = ehDiretorio ? f_closedir(&diretorio) : f_close(&arquivo);
+    liberarMapaClusters();
+    FRESULT resultado = f_close(&arquivo);
     registrarResultado(resultado);
     if (resultado != FR_OK) {
         return false;
@@ -113,6 +161,10 @@ bool ArquivoSd::fechar() {
     return true;
 }
 
+// O f_lseek até o fim só acontece na abertura e depois de algo que tire a
+// posição do fim (buscar, leituras, expandir). Entre escritas sucessivas o FIL
+// já está no fim, e a comparação poupa uma chamada que valida o arquivo e
+// trava o volume a cada acréscimo.
 bool ArquivoSd::abrirParaAcrescentar() {
     if (!validoParaArquivo()) {
         return false;
@@ -121,6 +173,9 @@ bool ArquivoSd::abrirParaAcrescentar() {
         return true;
     }
     FSIZE_t tamanho_arquivo = f_size(&arquivo);
+    if (f_tell(&arquivo) == tamanho_arquivo) {
+        return true;
+    }
     FRESULT resultado_seek = f_lseek(&arquivo, tamanho_arquivo);
     registrarResultado(resultado_seek);
     if (resultado_seek == FR_OK) {
@@ -130,6 +185,107 @@ bool ArquivoSd::abrirParaAcrescentar() {
     return false;
 }
 
+// Arquivos de um só cluster não ganham nada com o mapa; nos demais, o f_lseek
+// e a troca de cluster no f_read deixam de percorrer a cadeia da FAT.
+void ArquivoSd::criarMapaClusters() {
+#if FF_USE_FASTSEEK
+    FATFS* volume = arquivo.obj.fs;
+    if (f_size(&arquivo) <= static_cast<FSIZE_t>(volume->csize) * bytesPorSetor(volume)) {
+        return;
+    }
+    DWORD* mapa = reservarMapaClusters();
+    if (mapa == nullptr) {
+        CARTAO_SD_LOG("nenhum mapa de clusters livre\r\n");
+        return;
+    }
+    mapa[0] = CARTAO_SD_ENTRADAS_MAPA_CLUSTERS;
+    arquivo.cltbl = mapa;
+    FRESULT resultado = f_lseek(&arquivo, CREATE_LINKMAP);
+    if (resultado != FR_OK) {
+        // Fragmentado demais para o mapa (FR_NOT_ENOUGH_CORE): segue com a busca comum.
+        arquivo.cltbl = nullptr;
+        devolverMapaClusters(mapa);
+        return;
+    }
+    mapaClusters = mapa;
+    // Um único fragmento (tamanho, início, terminador) é um arquivo contíguo,
+    // como o que o f_expand deixa.
+    if (mapa[3] == 0u) {
+        contiguo = true;
+        setorInicialContiguo = volume->database + static_cast<LBA_t>(mapa[2] - 2u) * volume->csize;
+    }
+#endif
+}
+
+void ArquivoSd::liberarMapaClusters() {
+    if (mapaClusters == nullptr) {
+        return;
+    }
+#if FF_USE_FASTSEEK
+    arquivo.cltbl = nullptr;
+#endif
+    devolverMapaClusters(mapaClusters);
+    mapaClusters = nullptr;
+    contiguo = false;
+}
+
+// Com o mapa ativo o FatFs não aumenta o arquivo; uma escrita que passa do
+// fim volta à busca comum.
+void ArquivoSd::prepararCrescimento(FSIZE_t bytes) {
+    if (mapaClusters == nullptr) {
+        return;
+    }
+    if (f_tell(&arquivo) + bytes > f_size(&arquivo)) {
+        liberarMapaClusters();
+    }
+}
+
+// Arquivo pré-alocado e contíguo: os setores inteiros vão direto ao
+// dispositivo em uma única escrita múltipla, sem consultar a FAT nem passar
+// pelo buffer do FIL. Início ou fim fora do limite de setor seguem pelo f_write.
+bool ArquivoSd::escreverSetoresDiretos(const uint8_t* dados, size_t tamanho, size_t &escritos) {
+    escritos = 0u;
+    if (!contiguo || (modoAbertura & MODO_PREALOCADO) == 0) {
+        return true;
+    }
+    FATFS* volume = arquivo.obj.fs;
+    FSIZE_t bytes_setor = bytesPorSetor(volume);
+    FSIZE_t posicao_atual = f_tell(&arquivo);
+    if ((posicao_atual % bytes_setor) != 0u) {
+        return true;
+    }
+    FSIZE_t setores = static_cast<FSIZE_t>(tamanho) / bytes_setor;
+    FSIZE_t setores_restantes = (f_size(&arquivo) - posicao_atual) / bytes_setor;
+    if (setores > setores_restantes) {
+        setores = setores_restantes;
+    }
+    if (setores == 0u) {
+        return true;
+    }
+
+    LBA_t setor = setorInicialContiguo + static_cast<LBA_t>(posicao_atual / bytes_setor);
+    if (disk_write(volume->pdrv, dados, setor, static_cast<UINT>(setores)) != RES_OK) {
+        registrarResultado(FR_DISK_ERR);
+        return false;
+    }
+    // Mesmo tratamento da escrita direta do f_write: se o setor do buffer do
+    // FIL foi reescrito, o buffer recebe os dados novos e deixa de estar sujo.
+    // Um buffer sujo fora do intervalo continua pendente para o f_sync.
+    if (arquivo.sect - setor < static_cast<LBA_t>(setores)) {
+        memcpy(arquivo.buf, dados + ((arquivo.sect - setor) * bytes_setor), static_cast<size_t>(bytes_setor));
+        arquivo.flag &= static_cast<BYTE>(~FLAG_BUFFER_SUJO_FATFS);
+    }
+    arquivo.flag |= FLAG_MODIFICADO_FATFS;
+
+    FRESULT resultado_seek = f_lseek(&arquivo, posicao_atual + (setores * bytes_setor));
+    registrarResultado(resultado_seek);
+    if (resultado_seek != FR_OK) {
+        return false;
+    }
+    escritos = static_cast<size_t>(setores * bytes_setor);
+    return true;
+}
+
 bool ArquivoSd::escreverTexto(const char* texto) {
     if (!validoParaArquivo()) {
         return false;
@@ -141,13 +297,14 @@ bool ArquivoSd::escreverTexto(const char* texto) {
     if (!abrirParaAcrescentar()) {
         return false;
     }
-    int quantidade_escrita = f_printf(&arquivo, "%s", texto);
-    if (quantidade_escrita < 0) {
-        registrarResultado(static_cast<FRESULT>(f_error(&arquivo)));
-        return false;
+    // Direto pelo f_write: o f_printf("%s") passava caractere a caractere pelo
+    // putbuff do FatFs, com um f_write a cada 64 bytes.
+    size_t tamanho_texto = strlen(texto);
+    if (tamanho_texto == 0u) {
+        registrarResultado(FR_OK);
+        return true;
     }
-    registrarResultado(FR_OK);
-    return true;
+    return escreverBytes(reinterpret_cast<const uint8_t*>(texto), tamanho_texto) == tamanho_texto;
 }
 
 size_t ArquivoSd::escreverBytes(const uint8_t* dados, size_t tamanho) {
@@ -165,14 +322,23 @@ size_t ArquivoSd::escreverBytes(const uint8_t* dados, size_t tamanho) {
         registrarResultado(FR_OK);
         return 0;
     }
+    prepararCrescimento(static_cast<FSIZE_t>(tamanho));
+
+    size_t escritos_diretos = 0u;
+    if (!escreverSetoresDiretos(dados, tamanho, escritos_diretos)) {
+        return 0;
+    }
+    if (escritos_diretos == tamanho) {
+        return tamanho;
+    }
 
     UINT quantidade_escrita = 0;
-    FRESULT resultado_escrita = f_write(&arquivo, dados, (UINT)tamanho, &quantidade_escrita);
+    FRESULT resultado_escrita = f_write(&arquivo, dados + escritos_diretos, (UINT)(tamanho - escritos_diretos), &quantidade_escrita);
     registrarResultado(resultado_escrita);
     if (resultado_escrita != FR_OK) {
-        return 0;
+        return escritos_diretos;
     }
-    return static_cast<size_t>(quantidade_escrita);
+    return escritos_diretos + static_cast<size_t>(quantidade_escrita);
 }
 
 size_t ArquivoSd::lerBytes(uint8_t* buffer, size_t tamanho) {
@@ -245,6 +411,9 @@ bool ArquivoSd::buscar(long posicao) {
     if (posicao < 0) {
         return false;
     }
+    if (static_cast<FSIZE_t>(posicao) > f_size(&arquivo)) {
+        liberarMapaClusters();
+    }
     FRESULT resultado_seek = f_lseek(&arquivo, (FSIZE_t)posicao);
     registrarResultado(resultado_seek);
     if (resultado_seek == FR_OK) {
@@ -268,69 +437,14 @@ long ArquivoSd::tamanho() {
     return static_cast<long>(f_size(&arquivo));
 }
 
-bool ArquivoSd::nome(char* destino, size_t capacidade) {
-    if (!destino) return false;
-    if (capacidade == 0) return false;
-    if (!aberto) return false;
-    size_t tamanho_nome = strlen(caminho);
-    if (tamanho_nome + 1 > capacidade) return false;
-    memcpy(destino, caminho, tamanho_nome + 1);
-    return true;
-}
-
-bool ArquivoSd::eDiretorio() {
-    if (!aberto) return false;
-    return ehDiretorio;
-}
-
-ArquivoSd ArquivoSd::abrirProximaEntrada() {
-    ArquivoSd handle_invalido;
-    if (!validoParaDiretorio()) {
-        return handle_invalido;
-    }
-    FILINFO informacao;
-    memset(&informacao, 0, sizeof(informacao));
-    FRESULT resultado_leitura = f_readdir(&diretorio, &informacao);
-    registrarResultado(resultado_leitura);
-    if (resultado_leitura != FR_OK) {
-        return handle_invalido;
-    }
-    if (informacao.fname[0] == 0) {
-        registrarResultado(FR_OK);
-        return handle_invalido;
-    }
-    ArquivoSd entrada_handle;
-    entrada_handle.aberto = true;
-    entrada_handle.ehDiretorio = (informacao.fattrib & AM_DIR) ? true : false;
-    entrada_handle.modoAbertura = MODO_LEITURA;
-    entrada_handle.ehEntradaEnumerada = true;
-    snprintf(entrada_handle.caminho, sizeof(entrada_handle.caminho), "%s/%s", caminho, informacao.fname);
-    memcpy(&entrada_handle.infoEntrada, &informacao, sizeof(FILINFO));
-    entrada_handle.ultimoResultado = resultado_leitura;
-    return entrada_handle;
-}
-
-bool ArquivoSd::reiniciarDiretorio() {
-    if (!validoParaDiretorio()) {
-        return false;
-    }
-    FRESULT resultado = f_rewinddir(&diretorio);
-    registrarResultado(resultado);
-    return resultado == FR_OK;
-}
-
-bool ArquivoSd::estaAberto() {
+bool ArquivoSd::estaAberto() const {
     return aberto;
 }
 
 void ArquivoSd::invalidar() {
     aberto = false;
-    ehDiretorio = false;
-    ehEntradaEnumerada = false;
-    caminho[0] = 0;
-    modoAbertura = 0;
+    modoAbertura = 0u;
     ultimoResultado = FR_OK;
-    memset(&infoEntrada, 0, sizeof(infoEntrada));
 }
 
 bool ArquivoSd::truncar() {
@@ -341,6 +455,7 @@ bool ArquivoSd::truncar() {
         CARTAO_SD_LOG("arquivo não aberto para truncar\r\n");
         return false;
     }
+    liberarMapaClusters();
     FRESULT resultado = f_truncate(&arquivo);
     registrarResultado(resultado);
     return resultado == FR_OK;
@@ -376,7 +491,7 @@ bool ArquivoSd::encaminharDados(FuncaoEncaminhamentoFat funcao_encaminhamento, U
 #endif
 }
 
-bool ArquivoSd::expandir(FSIZE_t tamanho_desejado, bool preencher_com_zero) {
+bool ArquivoSd::expandir(FSIZE_t tamanho_desejado, bool alocar_agora) {
     if (!validoParaArquivo()) {
         return false;
     }
@@ -384,7 +499,8 @@ bool ArquivoSd::expandir(FSIZE_t tamanho_desejado, bool preencher_com_zero) {
         CARTAO_SD_LOG("arquivo não aberto para expandir\r\n");
         return false;
     }
-    BYTE opcao = preencher_com_zero ? 1u : 0u;
+    BYTE opcao = alocar_agora ? 1u : 0u;
+    liberarMapaClusters();
 #if FF_USE_EXPAND
     FRESULT resultado = f_expand(&arquivo, tamanho_desejado, opcao);
     registrarResultado(resultado);
@@ -409,6 +525,7 @@ bool ArquivoSd::escreverCaractere(char caractere) {
     if (!abrirParaAcrescentar()) {
         return false;
     }
+    prepararCrescimento(1u);
     int resultado = f_putc(caractere, &arquivo);
     if (resultado < 0) {
         registrarResultado(static_cast<FRESULT>(f_error(&arquivo)));
@@ -418,24 +535,9 @@ bool ArquivoSd::escreverCaractere(char caractere) {
     return true;
 }
 
+// Como escreverTexto: o texto já traz o terminador que quiser.
 bool ArquivoSd::escreverLinha(const char* texto) {
-    if (!validoParaArquivo()) {
-        return false;
-    }
-    if ((modoAbertura & (MODO_ESCRITA | MODO_ACRESCENTAR)) == 0) {
-        CARTAO_SD_LOG("arquivo não aberto para escrita\r\n");
-        return false;
-    }
-    if (!abrirParaAcrescentar()) {
-        return false;
-    }
-    int resultado = f_puts(texto, &arquivo);
-    if (resultado < 0) {
-        registrarResultado(static_cast<FRESULT>(f_error(&arquivo)));
-        return false;
-    }
-    registrarResultado(FR_OK);
-    return true;
+    return escreverTexto(texto);
 }
 
 bool ArquivoSd::lerLinha(char* destino, size_t capacidade) {
@@ -461,9 +563,6 @@ bool ArquivoSd::estaNoFim() const {
     if (!aberto) {
         return true;
     }
-    if (ehDiretorio) {
-        return false;
-    }
     return f_eof(&arquivo) != 0;
 }
 
@@ -471,9 +570,6 @@ BYTE ArquivoSd::obterCodigoErro() const {
     if (!aberto) {
         return 0u;
     }
-    if (ehDiretorio) {
-        return 0u;
-    }
     return f_error(const_cast<FIL*>(&arquivo));
 }
 
@@ -490,37 +586,200 @@ bool ArquivoSd::reiniciarPosicao() {
     return resultado == FR_OK;
 }
 
-bool ArquivoSd::obterInformacoes(InformacoesEntradaFat &destino) const {
-    if (!aberto) {
+bool ArquivoSd::buscaRapidaAtiva() const {
+    return mapaClusters != nullptr;
+}
+
+bool ArquivoSd::escritaDiretaAtiva() const {
+    return contiguo && (modoAbertura & MODO_PREALOCADO) != 0;
+}
+
+void ArquivoSd::registrarResultado(FRESULT resultado) {
+    ultimoResultado = resultado;
+}
+
+EntradaDiretorio::EntradaDiretorio() : info(nullptr), caminhoDiretorio(nullptr) {
+}
+
+EntradaDiretorio::EntradaDiretorio(const FILINFO* info_entrada, const char* caminho_diretorio)
+    : info(info_entrada), caminhoDiretorio(caminho_diretorio) {
+}
+
+bool EntradaDiretorio::valida() const {
+    return info != nullptr;
+}
+
+const char* EntradaDiretorio::nome() const {
+    if (info == nullptr) {
+        return "";
+    }
+    return info->fname;
+}
+
+bool EntradaDiretorio::eDiretorio() const {
+    if (info == nullptr) {
+        return false;
+    }
+    return (info->fattrib & AM_DIR) != 0;
+}
+
+uint64_t EntradaDiretorio::tamanho() const {
+    if (info == nullptr) {
+        return 0u;
+    }
+    return static_cast<uint64_t>(info->fsize);
+}
+
+bool EntradaDiretorio::caminhoCompleto(char* destino, size_t capacidade) const {
+    if (info == nullptr || destino == nullptr || capacidade == 0u) {
         return false;
     }
-    if (ehEntradaEnumerada) {
-        converterFilinfoParaInformacoes(infoEntrada, destino);
+    int tamanho_caminho = snprintf(destino, capacidade, "%s/%s", caminhoDiretorio, info->fname);
+    return tamanho_caminho > 0 && static_cast<size_t>(tamanho_caminho) < capacidade;
+}
+
+bool EntradaDiretorio::obterInformacoes(InformacoesEntradaFat &destino) const {
+    if (info == nullptr) {
+        return false;
+    }
+    converterFilinfoParaInformacoes(*info, destino);
+    return true;
+}
+
+DiretorioSd::DiretorioSd() {
+    aberto = false;
+    ultimoResultado = FR_OK;
+    memset(caminho, 0, sizeof(caminho));
+    memset(&diretorio, 0, sizeof(diretorio));
+    memset(&infoEntrada, 0, sizeof(infoEntrada));
+}
+
+DiretorioSd::~DiretorioSd() {
+    fechar();
+}
+
+DiretorioSd::DiretorioSd(DiretorioSd &&outro) {
+    assumir(outro);
+}
+
+DiretorioSd &DiretorioSd::operator=(DiretorioSd &&outro) {
+    if (this != &outro) {
+        fechar();
+        assumir(outro);
+    }
+    return *this;
+}
+
+void DiretorioSd::assumir(DiretorioSd &outro) {
+    memcpy(&diretorio, &outro.diretorio, sizeof(diretorio));
+    memcpy(&infoEntrada, &outro.infoEntrada, sizeof(infoEntrada));
+    memcpy(caminho, outro.caminho, sizeof(caminho));
+    ultimoResultado = outro.ultimoResultado;
+    aberto = outro.aberto;
+    outro.aberto = false;
+    outro.caminho[0] = 0;
+}
+
+bool DiretorioSd::fechar() {
+    if (!aberto) {
+        ultimoResultado = FR_OK;
         return true;
     }
-    FILINFO informacao;
-    memset(&informacao, 0, sizeof(informacao));
-    FRESULT resultado = f_stat(caminho, &informacao);
-    const_cast<ArquivoSd*>(this)->registrarResultado(resultado);
+    FRESULT resultado = f_closedir(&diretorio);
+    registrarResultado(resultado);
     if (resultado != FR_OK) {
         return false;
     }
-    converterFilinfoParaInformacoes(informacao, destino);
+    aberto = false;
+    caminho[0] = 0;
     return true;
 }
 
-void ArquivoSd::registrarResultado(FRESULT resultado) {
+bool DiretorioSd::estaAberto() const {
+    return aberto;
+}
+
+// A entrada devolvida aponta para infoEntrada; sem mais entradas, ou em erro,
+// volta uma EntradaDiretorio inválida.
+EntradaDiretorio DiretorioSd::proximaEntrada() {
+    if (!aberto) {
+        CARTAO_SD_LOG("diretório não está aberto\r\n");
+        return EntradaDiretorio();
+    }
+    FRESULT resultado_leitura = f_readdir(&diretorio, &infoEntrada);
+    registrarResultado(resultado_leitura);
+    if (resultado_leitura != FR_OK || infoEntrada.fname[0] == 0) {
+        return EntradaDiretorio();
+    }
+    return EntradaDiretorio(&infoEntrada, caminho);
+}
+
+bool DiretorioSd::reiniciar() {
+    if (!aberto) {
+        CARTAO_SD_LOG("diretório não está aberto\r\n");
+        return false;
+    }
+    FRESULT resultado = f_rewinddir(&diretorio);
+    registrarResultado(resultado);
+    return resultado == FR_OK;
+}
+
+bool DiretorioSd::nome(char* destino, size_t capacidade) const {
+    if (!destino) return false;
+    if (capacidade == 0) return false;
+    if (!aberto) return false;
+    size_t tamanho_nome = strlen(caminho);
+    if (tamanho_nome + 1 > capacidade) return false;
+    memcpy(destino, caminho, tamanho_nome + 1);
+    return true;
+}
+
+FRESULT DiretorioSd::resultadoOperacao() const {
+    return ultimoResultado;
+}
+
+void DiretorioSd::registrarResultado(FRESULT resultado) {
     ultimoResultado = resultado;
 }
 
 CartaoSD::CartaoSD(spi_inst_t* instanciaSpi, uint8_t gpioMiso, uint8_t gpioMosi, uint8_t gpioSck, uint8_t gpioCs)
     : controladorSpi(instanciaSpi, gpioMiso, gpioMosi, gpioSck, gpioCs, FREQUENCIA_SPI_BAIXA, FREQUENCIA_SPI_ALTA),
       driverSd(controladorSpi),
+      dispositivoBase(driverSd),
+      leituraAntecipada(dispositivoBase),
+      agrupadorEscrita(leituraAntecipada),
+      cacheSetores(agrupadorEscrita),
+      montado(false),
+      unidadeLogica("0:") {
+    memset(&sistemaArquivos, 0, sizeof(sistemaArquivos));
+    memset(descritorReservado, 0, sizeof(descritorReservado));
+    mutex_init(&mutexDescritores);
+    recursive_mutex_init(&mutexMontagem);
+    for (uint32_t nucleo = 0u; nucleo < QUANTIDADE_NUCLEOS; nucleo = nucleo + 1u) {
+        ultimoResultado[nucleo] = FR_OK;
+    }
+    cartao_sd::registrarDispositivoFatFs(&cacheSetores);
+}
+
+// Usa outro dispositivo de blocos no lugar do cartão SPI (por exemplo, uma
+// imagem de disco na compilação para o host); o controlador SPI fica ocioso.
+CartaoSD::CartaoSD(cartao_sd::DispositivoBloco &dispositivo_base)
+    : controladorSpi(nullptr, 0u, 0u, 0u, 0u, FREQUENCIA_SPI_BAIXA, FREQUENCIA_SPI_ALTA),
+      driverSd(controladorSpi),
+      dispositivoBase(dispositivo_base),
+      leituraAntecipada(dispositivoBase),
+      agrupadorEscrita(leituraAntecipada),
+      cacheSetores(agrupadorEscrita),
       montado(false),
-      unidadeLogica("0:"),
-      ultimoResultado(FR_OK) {
+      unidadeLogica("0:") {
     memset(&sistemaArquivos, 0, sizeof(sistemaArquivos));
-    cartao_sd::registrarDriverFatFs(&driverSd);
+    memset(descritorReservado, 0, sizeof(descritorReservado));
+    mutex_init(&mutexDescritores);
+    recursive_mutex_init(&mutexMontagem);
+    for (uint32_t nucleo = 0u; nucleo < QUANTIDADE_NUCLEOS; nucleo = nucleo + 1u) {
+        ultimoResultado[nucleo] = FR_OK;
+    }
+    cartao_sd::registrarDispositivoFatFs(&cacheSetores);
 }
 
 CartaoSD::~CartaoSD() {
@@ -528,13 +787,15 @@ CartaoSD::~CartaoSD() {
 }
 
 bool CartaoSD::garantirInicio() {
-    bool iniciou = driverSd.iniciar();
+    cartao_sd::travarDispositivoFatFs();
+    bool iniciou = cacheSetores.iniciar();
+    cartao_sd::liberarDispositivoFatFs();
     if (!iniciou) {
         CARTAO_SD_LOG("falha ao iniciar comunicação com cartão\r\n");
-        ultimoResultado = FR_NOT_READY;
+        registrarResultado(FR_NOT_READY);
         return false;
     }
-    ultimoResultado = FR_OK;
+    registrarResultado(FR_OK);
     return true;
 }
 
@@ -543,19 +804,27 @@ bool CartaoSD::iniciarSpi() {
 }
 
 bool CartaoSD::montarSistemaArquivos() {
+    // Os dois núcleos chegam aqui em toda operação; a trava impede que ambos
+    // vejam o volume desmontado e chamem f_mount ao mesmo tempo.
+    recursive_mutex_enter_blocking(&mutexMontagem);
     if (montado) {
-        ultimoResultado = FR_OK;
+        recursive_mutex_exit(&mutexMontagem);
+        registrarResultado(FR_OK);
         return true;
     }
 
     if (!garantirInicio()) {
+        recursive_mutex_exit(&mutexMontagem);
         return false;
     }
 
     FRESULT resultado_montagem = f_mount(&sistemaArquivos, unidadeLogica, 1);
-    ultimoResultado = resultado_montagem;
+    registrarResultado(resultado_montagem);
     if (resultado_montagem == FR_OK) {
         montado = true;
+    }
+    recursive_mutex_exit(&mutexMontagem);
+    if (resultado_montagem == FR_OK) {
         return true;
     }
 
@@ -564,15 +833,27 @@ bool CartaoSD::montarSistemaArquivos() {
 }
 
 bool CartaoSD::desmontarSistemaArquivos() {
+    recursive_mutex_enter_blocking(&mutexMontagem);
     if (!montado) {
-        ultimoResultado = FR_OK;
+        recursive_mutex_exit(&mutexMontagem);
+        registrarResultado(FR_OK);
         return true;
     }
 
+    fecharDescritores();
+
+    // O f_unmount não emite CTRL_SYNC; setores adiados no cache são gravados aqui.
+    cartao_sd::travarDispositivoFatFs();
+    cacheSetores.sincronizar();
+    cartao_sd::liberarDispositivoFatFs();
+
     FRESULT resultado_desmontagem = f_unmount(unidadeLogica);
-    ultimoResultado = resultado_desmontagem;
+    registrarResultado(resultado_desmontagem);
     if (resultado_desmontagem == FR_OK) {
         montado = false;
+    }
+    recursive_mutex_exit(&mutexMontagem);
+    if (resultado_desmontagem == FR_OK) {
         return true;
     }
 
@@ -587,7 +868,7 @@ bool CartaoSD::existeCaminho(const char* caminho_consulta) {
     FILINFO info;
     memset(&info, 0, sizeof(info));
     FRESULT resultado_stat = f_stat(caminho_consulta, &info);
-    ultimoResultado = resultado_stat;
+    registrarResultado(resultado_stat);
     if (resultado_stat == FR_OK) {
         return true;
     }
@@ -603,7 +884,7 @@ bool CartaoSD::criarDiretorio(const char* caminho_criar) {
         return false;
     }
     FRESULT resultado_mkdir = f_mkdir(caminho_criar);
-    ultimoResultado = resultado_mkdir;
+    registrarResultado(resultado_mkdir);
     if (resultado_mkdir == FR_OK) {
         return true;
     }
@@ -619,7 +900,7 @@ bool CartaoSD::removerDiretorio(const char* caminho_remover) {
         return false;
     }
     FRESULT resultado_unlink = f_unlink(caminho_remover);
-    ultimoResultado = resultado_unlink;
+    registrarResultado(resultado_unlink);
     if (resultado_unlink == FR_OK) {
         return true;
     }
@@ -629,7 +910,7 @@ bool CartaoSD::removerDiretorio(const char* caminho_remover) {
 
 bool CartaoSD::removerDiretorioRecursivo(const char* caminho_remover) {
     if (caminho_remover == nullptr || caminho_remover[0] == 0) {
-        ultimoResultado = FR_INVALID_NAME;
+        registrarResultado(FR_INVALID_NAME);
         return false;
     }
 
@@ -637,7 +918,7 @@ bool CartaoSD::removerDiretorioRecursivo(const char* caminho_remover) {
     if ((strcmp(caminho_remover, "/") == 0) ||
         (strcmp(caminho_remover, "0:") == 0) ||
         (strcmp(caminho_remover, "0:/") == 0)) {
-        ultimoResultado = FR_DENIED;
+        registrarResultado(FR_DENIED);
         CARTAO_SD_LOG("remocao recursiva da raiz bloqueada\r\n");
         return false;
     }
@@ -646,50 +927,34 @@ bool CartaoSD::removerDiretorioRecursivo(const char* caminho_remover) {
         return false;
     }
 
-    ArquivoSd diretorio = abrir(caminho_remover, MODO_DIRETORIO | MODO_LEITURA);
+    DiretorioSd diretorio = abrirDiretorio(caminho_remover);
     if (!diretorio.estaAberto()) {
         CARTAO_SD_LOG("falha ao abrir diretório para remoção recursiva: %d\r\n", resultadoOperacao());
         return false;
     }
 
     for (;;) {
-        ArquivoSd entrada = diretorio.abrirProximaEntrada();
-        if (!entrada.estaAberto()) {
+        EntradaDiretorio entrada = diretorio.proximaEntrada();
+        if (!entrada.valida()) {
             break;
         }
 
-        InformacoesEntradaFat info{};
-        if (!entrada.obterInformacoes(info)) {
-            entrada.fechar();
-            continue;
-        }
-
-        const char* nome = info.nome_curto;
-#if FF_USE_LFN
-        if (info.nome_completo[0] != 0) {
-            nome = info.nome_completo;
-        }
-#endif
-
+        const char* nome = entrada.nome();
         if ((strcmp(nome, ".") == 0) || (strcmp(nome, "..") == 0)) {
-            entrada.fechar();
             continue;
         }
 
         char caminho_completo[TAMANHO_CAMINHO_TRABALHO];
-        if (!entrada.nome(caminho_completo, sizeof(caminho_completo))) {
-            entrada.fechar();
+        if (!entrada.caminhoCompleto(caminho_completo, sizeof(caminho_completo))) {
             diretorio.fechar();
-            ultimoResultado = FR_INVALID_NAME;
+            registrarResultado(FR_INVALID_NAME);
             return false;
         }
 
         bool sucesso = false;
-        if ((info.atributos & AM_DIR) != 0) {
-            entrada.fechar();
+        if (entrada.eDiretorio()) {
             sucesso = removerDiretorioRecursivo(caminho_completo);
         } else {
-            entrada.fechar();
             sucesso = removerArquivo(caminho_completo);
         }
 
@@ -708,7 +973,7 @@ bool CartaoSD::removerArquivo(const char* caminho_remover) {
         return false;
     }
     FRESULT resultado_unlink = f_unlink(caminho_remover);
-    ultimoResultado = resultado_unlink;
+    registrarResultado(resultado_unlink);
     if (resultado_unlink == FR_OK) {
         return true;
     }
@@ -718,49 +983,164 @@ bool CartaoSD::removerArquivo(const char* caminho_remover) {
 
 ArquivoSd CartaoSD::abrir(const char* caminho_abrir, int modo) {
     ArquivoSd handle;
+    abrirEm(handle, caminho_abrir, modo);
+    return handle;
+}
+
+// Abre direto no handle informado, que pode ser uma posição da tabela de
+// descritores, sem passar o FIL por um handle temporário.
+bool CartaoSD::abrirEm(ArquivoSd &handle, const char* caminho_abrir, int modo) {
     if (!montarSistemaArquivos()) {
-        return handle;
-    }
-    if ((modo & MODO_DIRETORIO) != 0) {
-        FRESULT resultado = f_opendir(&handle.diretorio, caminho_abrir);
-        ultimoResultado = resultado;
-        handle.registrarResultado(resultado);
-        if (resultado != FR_OK) {
-            return handle;
-        }
-        handle.aberto = true;
-        handle.ehDiretorio = true;
-        handle.modoAbertura = modo;
-        strncpy(handle.caminho, caminho_abrir, sizeof(handle.caminho) - 1u);
-        handle.caminho[sizeof(handle.caminho) - 1u] = 0;
-        return handle;
+        return false;
     }
     BYTE flags_fatfs = 0;
     if (modo & MODO_LEITURA) flags_fatfs |= FA_READ;
     if (modo & MODO_ESCRITA) flags_fatfs |= FA_WRITE | FA_OPEN_ALWAYS;
     if (modo & MODO_ACRESCENTAR) flags_fatfs |= FA_WRITE | FA_OPEN_ALWAYS;
     FRESULT resultado = f_open(&handle.arquivo, caminho_abrir, flags_fatfs);
-    ultimoResultado = resultado;
+    registrarResultado(resultado);
     handle.registrarResultado(resultado);
     if (resultado != FR_OK) {
-        return handle;
+        return false;
     }
     handle.aberto = true;
-    handle.ehDiretorio = false;
-    handle.modoAbertura = modo;
-    strncpy(handle.caminho, caminho_abrir, sizeof(handle.caminho) - 1u);
-    handle.caminho[sizeof(handle.caminho) - 1u] = 0;
+    handle.modoAbertura = static_cast<uint8_t>(modo);
     if ((modo & MODO_ACRESCENTAR) == 0) {
-        return handle;
+        if ((modo & MODO_ESCRITA) == 0 || (modo & (MODO_ACESSO_ALEATORIO | MODO_PREALOCADO)) != 0) {
+            handle.criarMapaClusters();
+        }
+        return true;
     }
     bool posicionou_fim = handle.abrirParaAcrescentar();
-    ultimoResultado = handle.resultadoOperacao();
+    registrarResultado(handle.resultadoOperacao());
     if (posicionou_fim) {
-        return handle;
+        return true;
     }
     handle.fechar();
-    ArquivoSd handle_invalido;
-    return handle_invalido;
+    return false;
+}
+
+// A posição é reservada antes do f_open para que o outro núcleo não a tome
+// enquanto o arquivo abre; o descritor é o índice na tabela.
+int CartaoSD::abrirDescritor(const char* caminho_abrir, int modo) {
+    int descritor = DESCRITOR_INVALIDO;
+    mutex_enter_blocking(&mutexDescritores);
+    for (int indice = 0; indice < CARTAO_SD_DESCRITORES; indice = indice + 1) {
+        if (!descritorReservado[indice]) {
+            descritorReservado[indice] = true;
+            descritor = indice;
+            break;
+        }
+    }
+    mutex_exit(&mutexDescritores);
+    if (descritor == DESCRITOR_INVALIDO) {
+        registrarResultado(FR_TOO_MANY_OPEN_FILES);
+        CARTAO_SD_LOG("tabela de descritores cheia\r\n");
+        return DESCRITOR_INVALIDO;
+    }
+    if (abrirEm(descritores[descritor], caminho_abrir, modo)) {
+        return descritor;
+    }
+    mutex_enter_blocking(&mutexDescritores);
+    descritorReservado[descritor] = false;
+    mutex_exit(&mutexDescritores);
+    return DESCRITOR_INVALIDO;
+}
+
+ArquivoSd* CartaoSD::arquivoDescritor(int descritor) {
+    if (descritor < 0 || descritor >= CARTAO_SD_DESCRITORES || !descritores[descritor].estaAberto()) {
+        registrarResultado(FR_INVALID_OBJECT);
+        return nullptr;
+    }
+    return &descritores[descritor];
+}
+
+size_t CartaoSD::lerDescritor(int descritor, uint8_t* buffer, size_t tamanho) {
+    ArquivoSd* arquivo = arquivoDescritor(descritor);
+    if (arquivo == nullptr) {
+        return 0u;
+    }
+    size_t lidos = arquivo->lerBytes(buffer, tamanho);
+    registrarResultado(arquivo->resultadoOperacao());
+    return lidos;
+}
+
+size_t CartaoSD::escreverDescritor(int descritor, const uint8_t* dados, size_t tamanho) {
+    ArquivoSd* arquivo = arquivoDescritor(descritor);
+    if (arquivo == nullptr) {
+        return 0u;
+    }
+    size_t escritos = arquivo->escreverBytes(dados, tamanho);
+    registrarResultado(arquivo->resultadoOperacao());
+    return escritos;
+}
+
+bool CartaoSD::fecharDescritor(int descritor) {
+    ArquivoSd* arquivo = arquivoDescritor(descritor);
+    if (arquivo == nullptr) {
+        return false;
+    }
+    bool fechou = arquivo->fechar();
+    registrarResultado(arquivo->resultadoOperacao());
+    if (!fechou) {
+        return false;
+    }
+    mutex_enter_blocking(&mutexDescritores);
+    descritorReservado[descritor] = false;
+    mutex_exit(&mutexDescritores);
+    return true;
+}
+
+// Chamado na desmontagem: descritores esquecidos abertos têm os dados
+// gravados e a posição liberada antes do f_unmount.
+void CartaoSD::fecharDescritores() {
+    for (int indice = 0; indice < CARTAO_SD_DESCRITORES; indice = indice + 1) {
+        if (!descritores[indice].estaAberto()) {
+            continue;
+        }
+        if (!descritores[indice].fechar()) {
+            // Depois do f_unmount o FIL não serve mais: a posição é liberada mesmo assim.
+            descritores[indice].invalidar();
+        }
+        mutex_enter_blocking(&mutexDescritores);
+        descritorReservado[indice] = false;
+        mutex_exit(&mutexDescritores);
+    }
+}
+
+DiretorioSd CartaoSD::abrirDiretorio(const char* caminho_abrir) {
+    DiretorioSd handle;
+    if (!montarSistemaArquivos()) {
+        return handle;
+    }
+    FRESULT resultado = f_opendir(&handle.diretorio, caminho_abrir);
+    registrarResultado(resultado);
+    handle.registrarResultado(resultado);
+    if (resultado != FR_OK) {
+        return handle;
+    }
+    handle.aberto = true;
+    strncpy(handle.caminho, caminho_abrir, sizeof(handle.caminho) - 1u);
+    handle.caminho[sizeof(handle.caminho) - 1u] = 0;
+    return handle;
+}
+
+// Recria o arquivo com tamanho_bytes em clusters contíguos já alocados
+// (f_expand), para que gravações posteriores não alternem dados e FAT. O
+// conteúdo inicial é o que estava nos clusters.
+bool CartaoSD::prealocar(const char* caminho, FSIZE_t tamanho_bytes) {
+    ArquivoSd arquivo = abrir(caminho, MODO_ESCRITA);
+    if (!arquivo.estaAberto()) {
+        return false;
+    }
+    bool alocou = arquivo.truncar() && arquivo.expandir(tamanho_bytes, true);
+    FRESULT resultado = arquivo.resultadoOperacao();
+    bool fechou = arquivo.fechar();
+    registrarResultado(alocou ? arquivo.resultadoOperacao() : resultado);
+    if (!alocou) {
+        CARTAO_SD_LOG("falha ao pre-alocar arquivo: %d\r\n", resultado);
+    }
+    return alocou && fechou;
 }
 
 bool CartaoSD::renomear(const char* caminho_original, const char* caminho_destino) {
@@ -768,7 +1148,7 @@ bool CartaoSD::renomear(const char* caminho_original, const char* caminho_destin
         return false;
     }
     FRESULT resultado = f_rename(caminho_original, caminho_destino);
-    ultimoResultado = resultado;
+    registrarResultado(resultado);
     if (resultado == FR_OK) {
         return true;
     }
@@ -783,7 +1163,7 @@ bool CartaoSD::obterInformacoes(const char* caminho, InformacoesEntradaFat &dest
     FILINFO informacao;
     memset(&informacao, 0, sizeof(informacao));
     FRESULT resultado = f_stat(caminho, &informacao);
-    ultimoResultado = resultado;
+    registrarResultado(resultado);
     if (resultado != FR_OK) {
         return false;
     }
@@ -797,13 +1177,13 @@ bool CartaoSD::alterarAtributos(const char* caminho, uint8_t atributos, uint8_t
     }
 #if FF_USE_CHMOD
     FRESULT resultado = f_chmod(caminho, atributos, mascara);
-    ultimoResultado = resultado;
+    registrarResultado(resultado);
     return resultado == FR_OK;
 #else
     (void)caminho;
     (void)atributos;
     (void)mascara;
-    ultimoResultado = FR_NOT_ENABLED;
+    registrarResultado(FR_NOT_ENABLED);
     CARTAO_SD_LOG("f_chmod desabilitado na configuracao do FatFs\r\n");
     return false;
 #endif
@@ -819,12 +1199,12 @@ bool CartaoSD::alterarHorario(const char* caminho, const CarimboTempoFat &tempo)
     informacao.fdate = tempo.data;
     informacao.ftime = tempo.hora;
     FRESULT resultado = f_utime(caminho, &informacao);
-    ultimoResultado = resultado;
+    registrarResultado(resultado);
     return resultado == FR_OK;
 #else
     (void)caminho;
     (void)tempo;
-    ultimoResultado = FR_NOT_ENABLED;
+    registrarResultado(FR_NOT_ENABLED);
     CARTAO_SD_LOG("f_utime desabilitado na configuracao do FatFs\r\n");
     return false;
 #endif
@@ -835,13 +1215,13 @@ bool CartaoSD::alterarDiretorioAtual(const char* caminho) {
         return false;
     }
     FRESULT resultado = f_chdir(caminho);
-    ultimoResultado = resultado;
+    registrarResultado(resultado);
     return resultado == FR_OK;
 }
 
 bool CartaoSD::alterarUnidadeAtual(const char* unidade) {
     FRESULT resultado = f_chdrive(unidade);
-    ultimoResultado = resultado;
+    registrarResultado(resultado);
     return resultado == FR_OK;
 }
 
@@ -853,7 +1233,7 @@ bool CartaoSD::obterDiretorioAtual(char* destino, size_t capacidade) {
         return false;
     }
     FRESULT resultado = f_getcwd(destino, static_cast<UINT>(capacidade));
-    ultimoResultado = resultado;
+    registrarResultado(resultado);
     return resultado == FR_OK;
 }
 
@@ -864,7 +1244,7 @@ bool CartaoSD::obterEspacoLivre(const char* caminho, EstatisticaEspacoLivreFat &
     FATFS* referencia = nullptr;
     DWORD clusters_livres = 0u;
     FRESULT resultado = f_getfree(caminho, &clusters_livres, &referencia);
-    ultimoResultado = resultado;
+    registrarResultado(resultado);
     if (resultado != FR_OK || referencia == nullptr) {
         return false;
     }
@@ -890,7 +1270,7 @@ bool CartaoSD::obterRotulo(const char* caminho, char* destino_rotulo, size_t cap
     TCHAR rotulo_local[FF_SFN_BUF + 1u];
     DWORD serie = 0u;
     FRESULT resultado = f_getlabel(caminho, rotulo_local, &serie);
-    ultimoResultado = resultado;
+    registrarResultado(resultado);
     if (resultado != FR_OK) {
         return false;
     }
@@ -912,7 +1292,7 @@ bool CartaoSD::obterRotulo(const char* caminho, char* destino_rotulo, size_t cap
     (void)destino_rotulo;
     (void)capacidade;
     numero_serie = 0u;
-    ultimoResultado = FR_NOT_ENABLED;
+    registrarResultado(FR_NOT_ENABLED);
     CARTAO_SD_LOG("f_getlabel desabilitado na configuracao do FatFs\r\n");
     return false;
 #endif
@@ -924,55 +1304,54 @@ bool CartaoSD::definirRotulo(const char* rotulo) {
     }
 #if FF_USE_LABEL
     FRESULT resultado = f_setlabel(rotulo);
-    ultimoResultado = resultado;
+    registrarResultado(resultado);
     return resultado == FR_OK;
 #else
     (void)rotulo;
-    ultimoResultado = FR_NOT_ENABLED;
+    registrarResultado(FR_NOT_ENABLED);
     CARTAO_SD_LOG("f_setlabel desabilitado na configuracao do FatFs\r\n");
     return false;
 #endif
 }
 
 bool CartaoSD::formatar(const char* caminho, const ParametrosFormatacaoFat &parametros, void* area_trabalho, size_t tamanho_area) {
-    if (montado) {
-        if (!desmontarSistemaArquivos()) {
-            return false;
-        }
-    }
-    if (!garantirInicio()) {
+    if (area_trabalho == nullptr || tamanho_area == 0u) {
         return false;
     }
-    MKFS_PARM configuracao = converterParametrosFormatacao(parametros);
-    if (area_trabalho == nullptr || tamanho_area == 0u) {
+    // f_mkfs não é reentrante: a trava de montagem segura o outro núcleo
+    // até o volume novo estar pronto para ser montado.
+    recursive_mutex_enter_blocking(&mutexMontagem);
+    if (!desmontarSistemaArquivos() || !garantirInicio()) {
+        recursive_mutex_exit(&mutexMontagem);
         return false;
     }
+    MKFS_PARM configuracao = converterParametrosFormatacao(parametros);
     FRESULT resultado = f_mkfs(caminho, &configuracao, area_trabalho, static_cast<UINT>(tamanho_area));
-    ultimoResultado = resultado;
+    registrarResultado(resultado);
+    recursive_mutex_exit(&mutexMontagem);
     return resultado == FR_OK;
 }
 
 bool CartaoSD::criarParticoes(uint8_t unidade_fisica, const LBA_t tabela_particoes[], void* area_trabalho) {
-    if (montado) {
-        if (!desmontarSistemaArquivos()) {
-            return false;
-        }
-    }
-    if (!garantirInicio()) {
+    if (tabela_particoes == nullptr) {
         return false;
     }
-    if (tabela_particoes == nullptr) {
+    recursive_mutex_enter_blocking(&mutexMontagem);
+    if (!desmontarSistemaArquivos() || !garantirInicio()) {
+        recursive_mutex_exit(&mutexMontagem);
         return false;
     }
 #if FF_MULTI_PARTITION
     FRESULT resultado = f_fdisk(unidade_fisica, tabela_particoes, area_trabalho);
-    ultimoResultado = resultado;
+    registrarResultado(resultado);
+    recursive_mutex_exit(&mutexMontagem);
     return resultado == FR_OK;
 #else
     (void)unidade_fisica;
     (void)tabela_particoes;
     (void)area_trabalho;
-    ultimoResultado = FR_NOT_ENABLED;
+    registrarResultado(FR_NOT_ENABLED);
+    recursive_mutex_exit(&mutexMontagem);
     CARTAO_SD_LOG("f_fdisk desabilitado na configuracao do FatFs\r\n");
     return false;
 #endif
@@ -981,11 +1360,11 @@ bool CartaoSD::criarParticoes(uint8_t unidade_fisica, const LBA_t tabela_partico
 bool CartaoSD::definirPaginaCodigo(uint16_t codigo_pagina) {
 #if FF_CODE_PAGE == 0
     FRESULT resultado = f_setcp(codigo_pagina);
-    ultimoResultado = resultado;
+    registrarResultado(resultado);
     return resultado == FR_OK;
 #else
     (void)codigo_pagina;
-    ultimoResultado = FR_NOT_ENABLED;
+    registrarResultado(FR_NOT_ENABLED);
     CARTAO_SD_LOG("f_setcp desabilitado na configuracao do FatFs\r\n");
     return false;
 #endif
@@ -999,7 +1378,7 @@ bool CartaoSD::buscarPrimeiro(const char* caminho, const char* padrao, Informaco
     FILINFO informacao;
     memset(&informacao, 0, sizeof(informacao));
     FRESULT resultado = f_findfirst(&contexto.diretorio, &informacao, caminho, padrao);
-    ultimoResultado = resultado;
+    registrarResultado(resultado);
     if (resultado != FR_OK) {
         contexto.ativo = false;
         return false;
@@ -1020,7 +1399,7 @@ bool CartaoSD::buscarProximo(InformacoesEntradaFat &destino, ContextoBuscaFat &c
     FILINFO informacao;
     memset(&informacao, 0, sizeof(informacao));
     FRESULT resultado = f_findnext(&contexto.diretorio, &informacao);
-    ultimoResultado = resultado;
+    registrarResultado(resultado);
     if (resultado != FR_OK) {
         return false;
     }
@@ -1034,15 +1413,152 @@ bool CartaoSD::buscarProximo(InformacoesEntradaFat &destino, ContextoBuscaFat &c
 
 bool CartaoSD::finalizarBusca(ContextoBuscaFat &contexto) {
     if (!contexto.ativo) {
-        ultimoResultado = FR_OK;
+        registrarResultado(FR_OK);
         return true;
     }
     FRESULT resultado = f_closedir(&contexto.diretorio);
     contexto.ativo = false;
-    ultimoResultado = resultado;
+    registrarResultado(resultado);
     return resultado == FR_OK;
 }
 
+void CartaoSD::definirEscritaAdiada(bool habilitar) {
+    driverSd.definirEscritaAdiada(habilitar);
+}
+
+void CartaoSD::definirDescarte(bool habilitar) {
+    cartao_sd::definirDescarteFatFs(habilitar);
+}
+
+bool CartaoSD::descarteHabilitado() const {
+    return cartao_sd::descarteFatFsHabilitado();
+}
+
+uint32_t CartaoSD::obterFrequenciaSpi() const {
+    return driverSd.obterFrequenciaOperacao();
+}
+
+cartao_sd::MotivoFrequencia CartaoSD::obterMotivoFrequencia() const {
+    return driverSd.obterMotivoFrequencia();
+}
+
+bool CartaoSD::estaEmAltaVelocidade() const {
+    return driverSd.estaEmAltaVelocidade();
+}
+
+bool CartaoSD::estaComVerificacaoCrc() const {
+    return driverSd.estaComVerificacaoCrc();
+}
+
+cartao_sd::InformacoesCartao CartaoSD::obterInformacoesCartao() const {
+    return driverSd.obterInformacoes();
+}
+
+uint32_t CartaoSD::obterErrosCrc() const {
+    return driverSd.obterErrosCrc();
+}
+
+void CartaoSD::definirEstrategiaEspera(cartao_sd::EstrategiaEspera estrategia) {
+    driverSd.definirEstrategiaEspera(estrategia);
+}
+
+cartao_sd::EstrategiaEspera CartaoSD::obterEstrategiaEspera() const {
+    return driverSd.obterEstrategiaEspera();
+}
+
+cartao_sd::EstatisticasEspera CartaoSD::obterEstatisticasEspera() const {
+    return driverSd.obterEstatisticasEspera();
+}
+
+void CartaoSD::zerarEstatisticasEspera() {
+    driverSd.zerarEstatisticasEspera();
+}
+
+#ifdef HABILITAR_HISTOGRAMAS_CARTAO_SD
+const cartao_sd::HistogramasComandos &CartaoSD::obterHistogramasComandos() const {
+    return driverSd.obterHistogramas();
+}
+
+void CartaoSD::zerarHistogramasComandos() {
+    driverSd.zerarHistogramas();
+}
+#endif
+
+void CartaoSD::definirPoliticaCache(cartao_sd::PoliticaCache politica) {
+    cartao_sd::travarDispositivoFatFs();
+    cacheSetores.definirPolitica(politica);
+    cartao_sd::liberarDispositivoFatFs();
+}
+
+cartao_sd::PoliticaCache CartaoSD::obterPoliticaCache() const {
+    return cacheSetores.obterPolitica();
+}
+
+cartao_sd::EstatisticasCache CartaoSD::obterEstatisticasCache() const {
+    return cacheSetores.obterEstatisticas();
+}
+
+void CartaoSD::zerarEstatisticasCache() {
+    cacheSetores.zerarEstatisticas();
+}
+
+void CartaoSD::definirLeituraAntecipada(bool habilitar) {
+    cartao_sd::travarDispositivoFatFs();
+    leituraAntecipada.definirHabilitada(habilitar);
+    cartao_sd::liberarDispositivoFatFs();
+}
+
+bool CartaoSD::leituraAntecipadaHabilitada() const {
+    return leituraAntecipada.estaHabilitada();
+}
+
+cartao_sd::EstatisticasLeituraAntecipada CartaoSD::obterEstatisticasLeituraAntecipada() const {
+    return leituraAntecipada.obterEstatisticas();
+}
+
+void CartaoSD::zerarEstatisticasLeituraAntecipada() {
+    leituraAntecipada.zerarEstatisticas();
+}
+
+void CartaoSD::definirAgrupamentoEscrita(bool habilitar) {
+    cartao_sd::travarDispositivoFatFs();
+    agrupadorEscrita.definirHabilitado(habilitar);
+    cartao_sd::liberarDispositivoFatFs();
+}
+
+bool CartaoSD::agrupamentoEscritaHabilitado() const {
+    return agrupadorEscrita.estaHabilitado();
+}
+
+void CartaoSD::definirPrazoAgrupamento(uint32_t prazo_ms) {
+    agrupadorEscrita.definirPrazoDescarga(prazo_ms);
+}
+
+uint32_t CartaoSD::obterPrazoAgrupamento() const {
+    return agrupadorEscrita.obterPrazoDescarga();
+}
+
+bool CartaoSD::verificarPrazoEscrita() {
+    cartao_sd::travarDispositivoFatFs();
+    bool descarregou = agrupadorEscrita.verificarPrazo();
+    cartao_sd::liberarDispositivoFatFs();
+    return descarregou;
+}
+
+cartao_sd::EstatisticasAgrupamento CartaoSD::obterEstatisticasAgrupamento() const {
+    return agrupadorEscrita.obterEstatisticas();
+}
+
+void CartaoSD::zerarEstatisticasAgrupamento() {
+    agrupadorEscrita.zerarEstatisticas();
+}
+
+// Cada núcleo enxerga o resultado da sua última operação; sem isso, uma falha
+// no núcleo 1 apareceria como resultado de uma chamada do núcleo 0.
 FRESULT CartaoSD::resultadoOperacao() const {
-    return ultimoResultado;
+    return ultimoResultado[get_core_num()];
+}
+
+void CartaoSD::registrarResultado(FRESULT resultado) const {
+    ultimoResultado[get_core_num()] = resultado;
 }
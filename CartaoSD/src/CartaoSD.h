@@ -5,11 +5,33 @@
 #include <stdint.h>
 
 #include "hardware/spi.h"
+#include "pico/mutex.h"
 
+#include "AgrupadorEscrita.h"
+#include "CacheSetores.h"
 #include "ControladorSpiCartao.h"
 #include "DriverCartaoSd.h"
+#include "LeituraAntecipada.h"
 #include "ff.h"
 
+#ifndef CARTAO_SD_MAPAS_CLUSTERS
+#define CARTAO_SD_MAPAS_CLUSTERS 4
+#endif
+
+#ifndef CARTAO_SD_ENTRADAS_MAPA_CLUSTERS
+#define CARTAO_SD_ENTRADAS_MAPA_CLUSTERS 64
+#endif
+
+// Tabela de descritores do CartaoSD: por padrão um por arquivo que o
+// controle de arquivos abertos do FatFs (FF_FS_LOCK) admite.
+#ifndef CARTAO_SD_DESCRITORES
+#if FF_FS_LOCK > 0
+#define CARTAO_SD_DESCRITORES FF_FS_LOCK
+#else
+#define CARTAO_SD_DESCRITORES 8
+#endif
+#endif
+
 #ifdef HABILITAR_LOG_CARTAO_SD
 #include <stdio.h>
 #define CARTAO_SD_LOG(...) printf(__VA_ARGS__)
@@ -20,7 +42,10 @@
 constexpr uint8_t MODO_LEITURA = 0x01u;
 constexpr uint8_t MODO_ESCRITA = 0x02u;
 constexpr uint8_t MODO_ACRESCENTAR = 0x04u;
-constexpr uint8_t MODO_DIRETORIO = 0x08u;
+constexpr uint8_t MODO_ACESSO_ALEATORIO = 0x10u;
+constexpr uint8_t MODO_PREALOCADO = 0x20u;
+
+constexpr int DESCRITOR_INVALIDO = -1;
 
 struct CarimboTempoFat {
     uint16_t data;
@@ -61,9 +86,16 @@ struct ContextoBuscaFat {
 
 using FuncaoEncaminhamentoFat = UINT (*)(const BYTE*, UINT);
 
+// Handles só se movem: cada um é dono de um objeto aberto no FatFs (e do mapa
+// de clusters emprestado), e o destrutor fecha o que ainda estiver aberto.
 class ArquivoSd {
 public:
     ArquivoSd();
+    ~ArquivoSd();
+    ArquivoSd(ArquivoSd &&outro);
+    ArquivoSd &operator=(ArquivoSd &&outro);
+    ArquivoSd(const ArquivoSd &) = delete;
+    ArquivoSd &operator=(const ArquivoSd &) = delete;
     bool fechar();
     bool escreverTexto(const char* texto);
     size_t escreverBytes(const uint8_t* dados, size_t tamanho);
@@ -74,15 +106,11 @@ public:
     bool buscar(long posicao);
     long posicao();
     long tamanho();
-    bool nome(char* destino, size_t capacidade);
-    bool eDiretorio();
-    ArquivoSd abrirProximaEntrada();
-    bool reiniciarDiretorio();
-    bool estaAberto();
+    bool estaAberto() const;
     bool truncar();
     bool sincronizar();
     bool encaminharDados(FuncaoEncaminhamentoFat funcao_encaminhamento, UINT bytes_transferir, UINT &bytes_processados);
-    bool expandir(FSIZE_t tamanho_desejado, bool preencher_com_zero);
+    bool expandir(FSIZE_t tamanho_desejado, bool alocar_agora);
     bool escreverCaractere(char caractere);
     bool escreverLinha(const char* texto);
     template<typename... Argumentos>
@@ -97,6 +125,7 @@ public:
         if (!abrirParaAcrescentar()) {
             return -1;
         }
+        liberarMapaClusters();
         int quantidade_escrita = f_printf(&arquivo, formato, argumentos...);
         if (quantidade_escrita < 0) {
             registrarResultado(static_cast<FRESULT>(f_error(&arquivo)));
@@ -110,30 +139,76 @@ public:
     BYTE obterCodigoErro() const;
     FRESULT resultadoOperacao() const;
     bool reiniciarPosicao();
-    bool obterInformacoes(InformacoesEntradaFat &destino) const;
+    bool buscaRapidaAtiva() const;
+    bool escritaDiretaAtiva() const;
 private:
     FIL arquivo;
-    DIR diretorio;
-    FILINFO infoEntrada;
+    DWORD* mapaClusters;
+    LBA_t setorInicialContiguo;
+    FRESULT ultimoResultado;
+    uint8_t modoAbertura;
     bool aberto;
-    bool ehDiretorio;
-    bool ehEntradaEnumerada;
-    int modoAbertura;
-    mutable FRESULT ultimoResultado;
-    static constexpr size_t TAMANHO_MAXIMO_CAMINHO = 256u;
-    static constexpr size_t TAMANHO_MAXIMO_NOME = 256u;
-    char caminho[TAMANHO_MAXIMO_CAMINHO];
+    bool contiguo;
+    void assumir(ArquivoSd &outro);
     bool validoParaArquivo();
-    bool validoParaDiretorio();
     bool abrirParaAcrescentar();
+    void criarMapaClusters();
+    void liberarMapaClusters();
+    void prepararCrescimento(FSIZE_t bytes);
+    bool escreverSetoresDiretos(const uint8_t* dados, size_t tamanho, size_t &escritos);
     void invalidar();
     void registrarResultado(FRESULT resultado);
     friend class CartaoSD;
 };
 
+// Vista da entrada lida por DiretorioSd::proximaEntrada(). Aponta para dados
+// do diretório e vale só até a próxima leitura ou o fechamento dele.
+class EntradaDiretorio {
+public:
+    EntradaDiretorio();
+    bool valida() const;
+    const char* nome() const;
+    bool eDiretorio() const;
+    uint64_t tamanho() const;
+    bool caminhoCompleto(char* destino, size_t capacidade) const;
+    bool obterInformacoes(InformacoesEntradaFat &destino) const;
+private:
+    EntradaDiretorio(const FILINFO* info_entrada, const char* caminho_diretorio);
+    const FILINFO* info;
+    const char* caminhoDiretorio;
+    friend class DiretorioSd;
+};
+
+class DiretorioSd {
+public:
+    DiretorioSd();
+    ~DiretorioSd();
+    DiretorioSd(DiretorioSd &&outro);
+    DiretorioSd &operator=(DiretorioSd &&outro);
+    DiretorioSd(const DiretorioSd &) = delete;
+    DiretorioSd &operator=(const DiretorioSd &) = delete;
+    bool fechar();
+    bool estaAberto() const;
+    EntradaDiretorio proximaEntrada();
+    bool reiniciar();
+    bool nome(char* destino, size_t capacidade) const;
+    FRESULT resultadoOperacao() const;
+private:
+    static constexpr size_t TAMANHO_MAXIMO_CAMINHO = 256u;
+    DIR diretorio;
+    FILINFO infoEntrada;
+    FRESULT ultimoResultado;
+    bool aberto;
+    char caminho[TAMANHO_MAXIMO_CAMINHO];
+    void assumir(DiretorioSd &outro);
+    void registrarResultado(FRESULT resultado);
+    friend class CartaoSD;
+};
+
 class CartaoSD {
 public:
     CartaoSD(spi_inst_t* instanciaSpi, uint8_t gpioMiso, uint8_t gpioMosi, uint8_t gpioSck, uint8_t gpioCs);
+    explicit CartaoSD(cartao_sd::DispositivoBloco &dispositivo_base);
     ~CartaoSD();
     bool iniciarSpi();
     bool montarSistemaArquivos();
@@ -144,6 +219,13 @@ public:
     bool removerDiretorioRecursivo(const char* caminho);
     bool removerArquivo(const char* caminho);
     ArquivoSd abrir(const char* caminho, int modo);
+    DiretorioSd abrirDiretorio(const char* caminho);
+    int abrirDescritor(const char* caminho, int modo);
+    size_t lerDescritor(int descritor, uint8_t* buffer, size_t tamanho);
+    size_t escreverDescritor(int descritor, const uint8_t* dados, size_t tamanho);
+    ArquivoSd* arquivoDescritor(int descritor);
+    bool fecharDescritor(int descritor);
+    bool prealocar(const char* caminho, FSIZE_t tamanho_bytes);
     bool renomear(const char* caminho_original, const char* caminho_destino);
     bool obterInformacoes(const char* caminho, InformacoesEntradaFat &destino);
     bool alterarAtributos(const char* caminho, uint8_t atributos, uint8_t mascara);
@@ -160,15 +242,60 @@ public:
     bool buscarPrimeiro(const char* caminho, const char* padrao, InformacoesEntradaFat &destino, ContextoBuscaFat &contexto);
     bool buscarProximo(InformacoesEntradaFat &destino, ContextoBuscaFat &contexto);
     bool finalizarBusca(ContextoBuscaFat &contexto);
+    void definirEscritaAdiada(bool habilitar);
+    void definirDescarte(bool habilitar);
+    bool descarteHabilitado() const;
+    uint32_t obterFrequenciaSpi() const;
+    cartao_sd::MotivoFrequencia obterMotivoFrequencia() const;
+    bool estaEmAltaVelocidade() const;
+    bool estaComVerificacaoCrc() const;
+    cartao_sd::InformacoesCartao obterInformacoesCartao() const;
+    uint32_t obterErrosCrc() const;
+    void definirEstrategiaEspera(cartao_sd::EstrategiaEspera estrategia);
+    cartao_sd::EstrategiaEspera obterEstrategiaEspera() const;
+    cartao_sd::EstatisticasEspera obterEstatisticasEspera() const;
+    void zerarEstatisticasEspera();
+#ifdef HABILITAR_HISTOGRAMAS_CARTAO_SD
+    const cartao_sd::HistogramasComandos &obterHistogramasComandos() const;
+    void zerarHistogramasComandos();
+#endif
+    void definirPoliticaCache(cartao_sd::PoliticaCache politica);
+    cartao_sd::PoliticaCache obterPoliticaCache() const;
+    cartao_sd::EstatisticasCache obterEstatisticasCache() const;
+    void zerarEstatisticasCache();
+    void definirLeituraAntecipada(bool habilitar);
+    bool leituraAntecipadaHabilitada() const;
+    cartao_sd::EstatisticasLeituraAntecipada obterEstatisticasLeituraAntecipada() const;
+    void zerarEstatisticasLeituraAntecipada();
+    void definirAgrupamentoEscrita(bool habilitar);
+    bool agrupamentoEscritaHabilitado() const;
+    void definirPrazoAgrupamento(uint32_t prazo_ms);
+    uint32_t obterPrazoAgrupamento() const;
+    bool verificarPrazoEscrita();
+    cartao_sd::EstatisticasAgrupamento obterEstatisticasAgrupamento() const;
+    void zerarEstatisticasAgrupamento();
     FRESULT resultadoOperacao() const;
 private:
     cartao_sd::ControladorSpiCartao controladorSpi;
     cartao_sd::DriverCartaoSd driverSd;
+    cartao_sd::DispositivoBloco &dispositivoBase;
+    cartao_sd::LeituraAntecipada leituraAntecipada;
+    cartao_sd::AgrupadorEscrita agrupadorEscrita;
+    cartao_sd::CacheSetores cacheSetores;
+    static constexpr uint32_t QUANTIDADE_NUCLEOS = 2u;
     FATFS sistemaArquivos;
+    // Depois do FATFS: os arquivos ainda abertos são fechados antes de ele sair.
+    ArquivoSd descritores[CARTAO_SD_DESCRITORES];
+    bool descritorReservado[CARTAO_SD_DESCRITORES];
+    mutex_t mutexDescritores;
+    recursive_mutex_t mutexMontagem;
     bool montado;
     const char* unidadeLogica;
-    mutable FRESULT ultimoResultado;
+    mutable FRESULT ultimoResultado[QUANTIDADE_NUCLEOS];
     bool garantirInicio();
+    bool abrirEm(ArquivoSd &handle, const char* caminho, int modo);
+    void fecharDescritores();
+    void registrarResultado(FRESULT resultado) const;
     static constexpr uint32_t FREQUENCIA_SPI_BAIXA = 400000u;
     static constexpr uint32_t FREQUENCIA_SPI_ALTA = 12500000u;
 };
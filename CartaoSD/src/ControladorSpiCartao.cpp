@@ -2,15 +2,26 @@
 
 #include <string.h>
 
+#include "CrcCartaoSd.h"
+
+#include "hardware/clocks.h"
 #include "hardware/gpio.h"
+#include "hardware/irq.h"
 #include "pico/stdlib.h"
 
 namespace cartao_sd {
 
 namespace {
 constexpr uint8_t SPI_FILL_CHAR = 0xFFu;
+constexpr size_t TAMANHO_MINIMO_DMA = 16u;
+constexpr int CANAL_DMA_INVALIDO = -1;
+constexpr uint32_t INTERVALO_MAXIMO_SONO_US = 1000u;
+constexpr uint MODO_SNIFFER_CRC16_CCITT = 0x2u;
+uint8_t descarteRecepcaoDma = 0u;
 }
 
+ControladorSpiCartao *ControladorSpiCartao::controladorEmEspera = nullptr;
+
 ControladorSpiCartao::ControladorSpiCartao(spi_inst_t *instancia_spi,
                                            uint8_t gpio_miso,
                                            uint8_t gpio_mosi,
@@ -25,7 +36,12 @@ ControladorSpiCartao::ControladorSpiCartao(spi_inst_t *instancia_spi,
       gpioCs(gpio_cs),
       frequenciaBaixaHz(frequencia_baixa_hz),
       frequenciaAltaHz(frequencia_alta_hz),
-      hardwareInicializado(false) {
+      frequenciaAtualHz(0u),
+      hardwareInicializado(false),
+      canalDmaTx(CANAL_DMA_INVALIDO),
+      canalDmaRx(CANAL_DMA_INVALIDO),
+      tratadorMisoRegistrado(false),
+      misoLiberado(false) {
     mutex_init(&mutexAcesso);
 }
 
@@ -38,12 +54,17 @@ bool ControladorSpiCartao::configurarHardware() {
     gpio_set_dir(gpioCs, GPIO_OUT);
     gpio_put(gpioCs, 1);
 
-    spi_init(instanciaSpi, frequenciaBaixaHz);
+    frequenciaAtualHz = spi_init(instanciaSpi, frequenciaBaixaHz);
     gpio_set_function(gpioMiso, GPIO_FUNC_SPI);
     gpio_set_function(gpioMosi, GPIO_FUNC_SPI);
     gpio_set_function(gpioSck, GPIO_FUNC_SPI);
+    // Com o cartão liberado o MISO precisa ler nível alto mesmo sem clock.
+    gpio_pull_up(gpioMiso);
     spi_set_format(instanciaSpi, 8, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
 
+    // Sem canais livres as transferências seguem pelo caminho bloqueante do SDK.
+    reservarCanaisDma();
+
     hardwareInicializado = true;
     return true;
 }
@@ -53,7 +74,7 @@ void ControladorSpiCartao::ajustarFrequenciaBaixa() {
         return;
     }
 
-    spi_set_baudrate(instanciaSpi, frequenciaBaixaHz);
+    frequenciaAtualHz = spi_set_baudrate(instanciaSpi, frequenciaBaixaHz);
 }
 
 void ControladorSpiCartao::ajustarFrequenciaAlta() {
@@ -61,7 +82,28 @@ void ControladorSpiCartao::ajustarFrequenciaAlta() {
         return;
     }
 
-    spi_set_baudrate(instanciaSpi, frequenciaAltaHz);
+    frequenciaAtualHz = spi_set_baudrate(instanciaSpi, frequenciaAltaHz);
+}
+
+uint32_t ControladorSpiCartao::ajustarFrequencia(uint32_t frequencia_hz) {
+    if (!hardwareInicializado) {
+        return 0u;
+    }
+
+    frequenciaAtualHz = spi_set_baudrate(instanciaSpi, frequencia_hz);
+    return frequenciaAtualHz;
+}
+
+uint32_t ControladorSpiCartao::obterFrequenciaAtual() const {
+    return frequenciaAtualHz;
+}
+
+uint32_t ControladorSpiCartao::obterFrequenciaAlta() const {
+    return frequenciaAltaHz;
+}
+
+uint32_t ControladorSpiCartao::obterFrequenciaPeriferica() const {
+    return clock_get_hz(clk_peri);
 }
 
 void ControladorSpiCartao::enviarClocksInicializacao() {
@@ -117,27 +159,165 @@ bool ControladorSpiCartao::transferirBuffer(const uint8_t *origem, uint8_t *dest
         return false;
     }
 
-    const uint8_t *ponteiro_origem = origem;
-    uint8_t *ponteiro_destino = destino;
-    size_t indice = 0;
+    if (quantidade >= TAMANHO_MINIMO_DMA && canalDmaTx != CANAL_DMA_INVALIDO) {
+        return transferirBufferDma(origem, destino, quantidade, nullptr);
+    }
+
+    return transferirBufferBloqueante(origem, destino, quantidade);
+}
+
+bool ControladorSpiCartao::transferirBufferComCrc(const uint8_t *origem, uint8_t *destino, size_t quantidade, uint16_t &crc) {
+    if (origem == nullptr && destino == nullptr) {
+        return false;
+    }
+
+#if CARTAO_SD_CRC_POR_DMA
+    if (quantidade >= TAMANHO_MINIMO_DMA && canalDmaTx != CANAL_DMA_INVALIDO) {
+        return transferirBufferDma(origem, destino, quantidade, &crc);
+    }
+#endif
+
+    bool transferiu = transferirBuffer(origem, destino, quantidade);
+    const uint8_t *carga = (destino != nullptr) ? destino : origem;
+    crc = calcularCrc16(carga, quantidade);
+    return transferiu;
+}
+
+bool ControladorSpiCartao::reservarCanaisDma() {
+    int canal_tx = dma_claim_unused_channel(false);
+    if (canal_tx < 0) {
+        return false;
+    }
+
+    int canal_rx = dma_claim_unused_channel(false);
+    if (canal_rx < 0) {
+        dma_channel_unclaim(static_cast<uint>(canal_tx));
+        return false;
+    }
+
+    canalDmaTx = canal_tx;
+    canalDmaRx = canal_rx;
+    return true;
+}
+
+bool ControladorSpiCartao::transferirBufferDma(const uint8_t *origem, uint8_t *destino, size_t quantidade, uint16_t *crc) {
+    spi_hw_t *registradores = spi_get_hw(instanciaSpi);
+
+    // Resíduos na FIFO de recepção deslocariam os dados copiados pelo canal RX.
+    while (spi_is_readable(instanciaSpi)) {
+        (void)registradores->dr;
+    }
+
+    uint canal_tx = static_cast<uint>(canalDmaTx);
+    uint canal_rx = static_cast<uint>(canalDmaRx);
+
+    dma_channel_config configuracao_tx = dma_channel_get_default_config(canal_tx);
+    channel_config_set_transfer_data_size(&configuracao_tx, DMA_SIZE_8);
+    channel_config_set_read_increment(&configuracao_tx, origem != nullptr);
+    channel_config_set_write_increment(&configuracao_tx, false);
+    channel_config_set_dreq(&configuracao_tx, spi_get_dreq(instanciaSpi, true));
+
+    dma_channel_config configuracao_rx = dma_channel_get_default_config(canal_rx);
+    channel_config_set_transfer_data_size(&configuracao_rx, DMA_SIZE_8);
+    channel_config_set_read_increment(&configuracao_rx, false);
+    channel_config_set_write_increment(&configuracao_rx, destino != nullptr);
+    channel_config_set_dreq(&configuracao_rx, spi_get_dreq(instanciaSpi, false));
+
+    const uint8_t *endereco_origem = (origem != nullptr) ? origem : &SPI_FILL_CHAR;
+    uint8_t *endereco_destino = (destino != nullptr) ? destino : &descarteRecepcaoDma;
+
+    // O sniffer acompanha o canal que carrega a carga útil: RX nas leituras,
+    // TX nas escritas. O CRC16-CCITT sai pronto ao fim da transferência.
+    uint canal_sniffer = (destino != nullptr) ? canal_rx : canal_tx;
+    if (crc != nullptr) {
+        channel_config_set_sniff_enable((destino != nullptr) ? &configuracao_rx : &configuracao_tx, true);
+        dma_sniffer_set_data_accumulator(0u);
+        dma_sniffer_enable(canal_sniffer, MODO_SNIFFER_CRC16_CCITT, true);
+    }
+
+    dma_channel_configure(canal_tx, &configuracao_tx, &registradores->dr, endereco_origem, static_cast<uint>(quantidade), false);
+    dma_channel_configure(canal_rx, &configuracao_rx, endereco_destino, &registradores->dr, static_cast<uint>(quantidade), false);
+
+    dma_start_channel_mask((1u << canal_tx) | (1u << canal_rx));
+    dma_channel_wait_for_finish_blocking(canal_rx);
+
+    if (crc != nullptr) {
+        *crc = static_cast<uint16_t>(dma_sniffer_get_data_accumulator() & 0xFFFFu);
+        dma_sniffer_disable();
+    }
+
+    return true;
+}
+
+bool ControladorSpiCartao::transferirBufferBloqueante(const uint8_t *origem, uint8_t *destino, size_t quantidade) {
+    int transferidos = 0;
+
+    if (origem == nullptr) {
+        transferidos = spi_read_blocking(instanciaSpi, SPI_FILL_CHAR, destino, quantidade);
+    } else if (destino == nullptr) {
+        transferidos = spi_write_blocking(instanciaSpi, origem, quantidade);
+    } else {
+        transferidos = spi_write_read_blocking(instanciaSpi, origem, destino, quantidade);
+    }
+
+    return transferidos == static_cast<int>(quantidade);
+}
+
+bool ControladorSpiCartao::aguardarMisoLiberado(absolute_time_t tempo_limite) {
+    // A tabela de vetores é compartilhada, então o tratador entra uma vez só;
+    // já o NVIC e a habilitação da borda são de cada núcleo, e o núcleo que
+    // espera precisa habilitar o IO_IRQ_BANK0 no seu próprio NVIC para acordar.
+    // O NVIC é consultado a cada espera porque multicore_reset_core1() limpa o
+    // do núcleo 1.
+    if (!tratadorMisoRegistrado) {
+        gpio_add_raw_irq_handler(gpioMiso, &ControladorSpiCartao::tratarBordaMiso);
+        tratadorMisoRegistrado = true;
+    }
+
+    if (!irq_is_enabled(IO_IRQ_BANK0)) {
+        irq_set_enabled(IO_IRQ_BANK0, true);
+    }
 
-    while (indice < quantidade) {
-        uint8_t dado_envio = SPI_FILL_CHAR;
-        if (ponteiro_origem != nullptr) {
-            dado_envio = ponteiro_origem[indice];
+    misoLiberado = false;
+    controladorEmEspera = this;
+    gpio_acknowledge_irq(gpioMiso, GPIO_IRQ_EDGE_RISE);
+    gpio_set_irq_enabled(gpioMiso, GPIO_IRQ_EDGE_RISE, true);
+
+    // O sono é limitado para que a linha volte a ser conferida mesmo que a
+    // borda de subida se perca.
+    while (!misoLiberado && !gpio_get(gpioMiso)) {
+        absolute_time_t proximo_despertar = make_timeout_time_us(INTERVALO_MAXIMO_SONO_US);
+        if (absolute_time_diff_us(proximo_despertar, tempo_limite) < 0) {
+            proximo_despertar = tempo_limite;
         }
 
-        uint8_t recebido = SPI_FILL_CHAR;
-        spi_write_read_blocking(instanciaSpi, &dado_envio, &recebido, 1);
+        best_effort_wfe_or_timeout(proximo_despertar);
 
-        if (ponteiro_destino != nullptr) {
-            ponteiro_destino[indice] = recebido;
+        if (absolute_time_diff_us(get_absolute_time(), tempo_limite) <= 0) {
+            break;
         }
+    }
 
-        indice = indice + 1;
+    gpio_set_irq_enabled(gpioMiso, GPIO_IRQ_EDGE_RISE, false);
+    controladorEmEspera = nullptr;
+
+    return misoLiberado || gpio_get(gpioMiso);
+}
+
+void ControladorSpiCartao::tratarBordaMiso() {
+    ControladorSpiCartao *controlador = controladorEmEspera;
+    if (controlador == nullptr) {
+        return;
     }
 
-    return true;
+    if ((gpio_get_irq_event_mask(controlador->gpioMiso) & GPIO_IRQ_EDGE_RISE) == 0u) {
+        return;
+    }
+
+    gpio_acknowledge_irq(controlador->gpioMiso, GPIO_IRQ_EDGE_RISE);
+    gpio_set_irq_enabled(controlador->gpioMiso, GPIO_IRQ_EDGE_RISE, false);
+    controlador->misoLiberado = true;
+    __sev();
 }
 
 uint8_t ControladorSpiCartao::obterGpioCs() const {
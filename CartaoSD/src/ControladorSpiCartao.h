@@ -4,11 +4,19 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "hardware/dma.h"
 #include "hardware/spi.h"
 #include "pico/mutex.h"
+#include "pico/time.h"
+
+#ifndef CARTAO_SD_CRC_POR_DMA
+#define CARTAO_SD_CRC_POR_DMA 1
+#endif
 
 namespace cartao_sd {
 
+// Os métodos usados pelo DriverCartaoSd são virtuais para que o barramento
+// possa ser substituído por um modelo do cartão na compilação do host.
 class ControladorSpiCartao {
 public:
     ControladorSpiCartao(spi_inst_t *instancia_spi,
@@ -18,16 +26,23 @@ public:
                          uint8_t gpio_cs,
                          uint32_t frequencia_baixa_hz,
                          uint32_t frequencia_alta_hz);
+    virtual ~ControladorSpiCartao() = default;
 
-    bool configurarHardware();
-    void ajustarFrequenciaBaixa();
-    void ajustarFrequenciaAlta();
-    void enviarClocksInicializacao();
-    void adquirirBarramento();
-    void liberarBarramento();
+    virtual bool configurarHardware();
+    virtual void ajustarFrequenciaBaixa();
+    virtual void ajustarFrequenciaAlta();
+    virtual uint32_t ajustarFrequencia(uint32_t frequencia_hz);
+    virtual uint32_t obterFrequenciaAtual() const;
+    virtual uint32_t obterFrequenciaAlta() const;
+    virtual uint32_t obterFrequenciaPeriferica() const;
+    virtual void enviarClocksInicializacao();
+    virtual void adquirirBarramento();
+    virtual void liberarBarramento();
     void desselecionarPulso();
-    uint8_t transferirByte(uint8_t dado);
-    bool transferirBuffer(const uint8_t *origem, uint8_t *destino, size_t quantidade);
+    virtual uint8_t transferirByte(uint8_t dado);
+    virtual bool transferirBuffer(const uint8_t *origem, uint8_t *destino, size_t quantidade);
+    virtual bool transferirBufferComCrc(const uint8_t *origem, uint8_t *destino, size_t quantidade, uint16_t &crc);
+    virtual bool aguardarMisoLiberado(absolute_time_t tempo_limite);
     uint8_t obterGpioCs() const;
 
 private:
@@ -38,11 +53,22 @@ private:
     uint8_t gpioCs;
     uint32_t frequenciaBaixaHz;
     uint32_t frequenciaAltaHz;
+    uint32_t frequenciaAtualHz;
     bool hardwareInicializado;
+    int canalDmaTx;
+    int canalDmaRx;
     mutex_t mutexAcesso;
+    bool tratadorMisoRegistrado;
+    volatile bool misoLiberado;
+
+    static ControladorSpiCartao *controladorEmEspera;
+    static void tratarBordaMiso();
 
     void selecionar();
     void desselecionar();
+    bool reservarCanaisDma();
+    bool transferirBufferDma(const uint8_t *origem, uint8_t *destino, size_t quantidade, uint16_t *crc);
+    bool transferirBufferBloqueante(const uint8_t *origem, uint8_t *destino, size_t quantidade);
 };
 
 } // namespace cartao_sd
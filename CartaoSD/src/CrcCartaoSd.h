@@ -0,0 +1,92 @@
+#ifndef CRCCARTAOSD_H
+#define CRCCARTAOSD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace cartao_sd {
+
+// CRC7 (x^7 + x^3 + 1) dos comandos e CRC16-CCITT (x^16 + x^12 + x^5 + 1)
+// dos blocos de dados, ambos com tabelas montadas em tempo de compilação.
+
+struct TabelaCrc7 {
+    uint8_t valores[256];
+};
+
+struct TabelaCrc16 {
+    uint16_t valores[256];
+};
+
+constexpr TabelaCrc7 gerarTabelaCrc7() {
+    TabelaCrc7 tabela{};
+    for (uint32_t indice = 0; indice < 256u; ++indice) {
+        // O registrador fica alinhado nos 7 bits mais altos do byte.
+        uint8_t crc = static_cast<uint8_t>(indice);
+        for (uint8_t bit = 0; bit < 8u; ++bit) {
+            if ((crc & 0x80u) != 0u) {
+                crc = static_cast<uint8_t>((crc << 1u) ^ 0x12u);
+            } else {
+                crc = static_cast<uint8_t>(crc << 1u);
+            }
+        }
+        tabela.valores[indice] = crc;
+    }
+    return tabela;
+}
+
+constexpr TabelaCrc16 gerarTabelaCrc16() {
+    TabelaCrc16 tabela{};
+    for (uint32_t indice = 0; indice < 256u; ++indice) {
+        uint16_t crc = static_cast<uint16_t>(indice << 8u);
+        for (uint8_t bit = 0; bit < 8u; ++bit) {
+            if ((crc & 0x8000u) != 0u) {
+                crc = static_cast<uint16_t>((crc << 1u) ^ 0x1021u);
+            } else {
+                crc = static_cast<uint16_t>(crc << 1u);
+            }
+        }
+        tabela.valores[indice] = crc;
+    }
+    return tabela;
+}
+
+inline constexpr TabelaCrc7 TABELA_CRC7 = gerarTabelaCrc7();
+inline constexpr TabelaCrc16 TABELA_CRC16 = gerarTabelaCrc16();
+
+// Retorna o último byte do pacote de comando: CRC7 seguido do bit de fim.
+constexpr uint8_t calcularByteCrc7(const uint8_t *dados, size_t tamanho) {
+    uint8_t crc = 0u;
+    for (size_t indice = 0; indice < tamanho; ++indice) {
+        crc = TABELA_CRC7.valores[crc ^ dados[indice]];
+    }
+    return static_cast<uint8_t>(crc | 0x01u);
+}
+
+constexpr uint16_t calcularCrc16(const uint8_t *dados, size_t tamanho) {
+    uint16_t crc = 0u;
+    for (size_t indice = 0; indice < tamanho; ++indice) {
+        crc = static_cast<uint16_t>((crc << 8u) ^ TABELA_CRC16.valores[((crc >> 8u) ^ dados[indice]) & 0xFFu]);
+    }
+    return crc;
+}
+
+namespace detalhe_crc {
+constexpr uint8_t PACOTE_CMD0[5] = {0x40u, 0x00u, 0x00u, 0x00u, 0x00u};
+constexpr uint8_t PACOTE_CMD8[5] = {0x48u, 0x00u, 0x00u, 0x01u, 0xAAu};
+
+constexpr uint16_t calcularCrc16Repetido(uint8_t valor, size_t quantidade) {
+    uint16_t crc = 0u;
+    for (size_t indice = 0; indice < quantidade; ++indice) {
+        crc = static_cast<uint16_t>((crc << 8u) ^ TABELA_CRC16.valores[((crc >> 8u) ^ valor) & 0xFFu]);
+    }
+    return crc;
+}
+}
+
+static_assert(calcularByteCrc7(detalhe_crc::PACOTE_CMD0, 5u) == 0x95u, "CRC7 do CMD0 deve ser 0x95");
+static_assert(calcularByteCrc7(detalhe_crc::PACOTE_CMD8, 5u) == 0x87u, "CRC7 do CMD8 deve ser 0x87");
+static_assert(detalhe_crc::calcularCrc16Repetido(0xFFu, 512u) == 0x7FA1u, "CRC16 de um setor 0xFF deve ser 0x7FA1");
+
+} // namespace cartao_sd
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef DISPOSITIVOBLOCO_H
+#define DISPOSITIVOBLOCO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace cartao_sd {
+
+constexpr size_t TAMANHO_SETOR_DISPOSITIVO = 512u;
+
+// Interface comum da camada de blocos vista pelo FatFs. O driver do cartão
+// fica na base e as camadas intermediárias (cache, leitura antecipada...)
+// encapsulam outro dispositivo com a mesma interface.
+class DispositivoBloco {
+public:
+    virtual ~DispositivoBloco() = default;
+
+    virtual bool iniciar() = 0;
+    virtual bool estaInicializado() const = 0;
+    virtual bool lerSetores(uint8_t *destino, uint32_t setor_inicial, uint32_t quantidade) = 0;
+    virtual bool escreverSetores(const uint8_t *origem, uint32_t setor_inicial, uint32_t quantidade) = 0;
+    virtual bool apagarSetores(uint32_t setor_inicial, uint32_t setor_final) = 0;
+    virtual bool sincronizar() = 0;
+    virtual uint64_t obterQuantidadeSetores() const = 0;
+    // Tamanho da unidade de alocação (AU) do cartão em setores; 0 se desconhecido.
+    virtual uint32_t obterSetoresUnidadeAlocacao() const = 0;
+};
+
+} // namespace cartao_sd
+
+#endif
@@ -5,40 +5,121 @@
 #include "pico/stdlib.h"
 #include "pico/time.h"
 
+#include "CrcCartaoSd.h"
+
+// Com HABILITAR_HISTOGRAMAS_CARTAO_SD cada espera pelo cartão entra no
+// histograma do comando em curso; sem a macro nada é medido nem guardado.
+#ifdef HABILITAR_HISTOGRAMAS_CARTAO_SD
+#define CARTAO_SD_MARCAR_INICIO(variavel) uint64_t variavel = time_us_64()
+#define CARTAO_SD_REGISTRAR_FASE(fase, inicio_us) \
+    histogramas.registrar(tipoComandoAtual, (fase), static_cast<uint32_t>(time_us_64() - (inicio_us)))
+#else
+#define CARTAO_SD_MARCAR_INICIO(variavel)
+#define CARTAO_SD_REGISTRAR_FASE(fase, inicio_us)
+#endif
+
 namespace cartao_sd {
 
 namespace {
 constexpr uint32_t TAMANHO_SETOR_BYTES = 512u;
 constexpr uint8_t COMANDO_GO_IDLE = 0u;
+constexpr uint8_t COMANDO_SWITCH_FUNC = 6u;
 constexpr uint8_t COMANDO_SEND_IF_COND = 8u;
 constexpr uint8_t COMANDO_SEND_CSD = 9u;
+constexpr uint8_t COMANDO_SEND_CID = 10u;
 constexpr uint8_t COMANDO_STOP_TRANSMISSION = 12u;
+constexpr uint8_t COMANDO_SEND_STATUS = 13u;
 constexpr uint8_t COMANDO_SET_BLOCKLEN = 16u;
 constexpr uint8_t COMANDO_READ_SINGLE = 17u;
+constexpr uint8_t COMANDO_READ_MULTIPLE = 18u;
 constexpr uint8_t COMANDO_WRITE_SINGLE = 24u;
+constexpr uint8_t COMANDO_WRITE_MULTIPLE = 25u;
+constexpr uint8_t COMANDO_ERASE_WR_BLK_START = 32u;
+constexpr uint8_t COMANDO_ERASE_WR_BLK_END = 33u;
+constexpr uint8_t COMANDO_ERASE = 38u;
 constexpr uint8_t COMANDO_APP_CMD = 55u;
 constexpr uint8_t COMANDO_READ_OCR = 58u;
+constexpr uint8_t COMANDO_CRC_ON_OFF = 59u;
 constexpr uint8_t COMANDO_APP_SEND_OP_COND = 41u;
 constexpr uint8_t COMANDO_APP_SET_WR_BLK = 23u;
+constexpr uint8_t COMANDO_APP_SEND_NUM_WR_BLOCKS = 22u;
+constexpr uint8_t COMANDO_APP_SD_STATUS = 13u;
 constexpr uint8_t TOKEN_INICIO_DADOS = 0xFEu;
+constexpr uint8_t TOKEN_ESCRITA_MULTIPLA = 0xFCu;
+constexpr uint8_t TOKEN_PARADA_ESCRITA = 0xFDu;
+constexpr uint32_t MASCARA_CONTAGEM_PRE_APAGAMENTO = 0x007FFFFFu;
 constexpr uint8_t RESPOSTA_IDLE = 0x01u;
 constexpr uint8_t RESPOSTA_PRONTA = 0x00u;
 constexpr uint32_t ARGUMENTO_HCS = 0x40000000u;
 constexpr uint8_t MASCARA_RESPOSTA_ERRO = 0x80u;
 constexpr uint8_t MASCARA_RESPOSTA_ESCRITA = 0x1Fu;
 constexpr uint8_t RESPOSTA_ESCRITA_OK = 0x05u;
+constexpr uint8_t RESPOSTA_ESCRITA_ERRO_CRC = 0x0Bu;
+constexpr uint32_t TENTATIVAS_CRC_MAXIMAS = 3u;
 constexpr uint32_t TEMPO_TIMEOUT_COMANDO_MS = 200u;
 constexpr uint32_t TEMPO_TIMEOUT_DADOS_MS = 500u;
 constexpr uint32_t TEMPO_TIMEOUT_INICIALIZACAO_MS = 1000u;
-constexpr uint8_t CRC_CMD0 = 0x95u;
-constexpr uint8_t CRC_CMD8 = 0x87u;
+constexpr uint32_t TEMPO_TIMEOUT_APAGAMENTO_MS = 30000u;
+constexpr uint32_t ARGUMENTO_SWITCH_CONSULTAR_ALTA_VELOCIDADE = 0x00FFFFF1u;
+constexpr uint32_t ARGUMENTO_SWITCH_ATIVAR_ALTA_VELOCIDADE = 0x80FFFFF1u;
+constexpr size_t TAMANHO_STATUS_SWITCH = 64u;
+constexpr uint16_t CLASSE_COMANDO_SWITCH = 1u << 10u;
+constexpr uint32_t FREQUENCIA_MAXIMA_PADRAO_HZ = 25000000u;
+constexpr uint32_t FREQUENCIA_MAXIMA_ALTA_VELOCIDADE_HZ = 50000000u;
+constexpr uint32_t DIVISOR_MINIMO_SPI = 2u;
+constexpr uint32_t SETOR_VERIFICACAO = 0u;
+constexpr uint32_t LEITURAS_VERIFICACAO = 4u;
+constexpr uint32_t INTERVALO_AMOSTRA_TOKEN_INICIAL_US = 8u;
+constexpr uint32_t INTERVALO_AMOSTRA_TOKEN_MAXIMO_US = 256u;
+// Com a latência típica do token conhecida, o primeiro sono cobre 3/4 dela e
+// o intervalo entre amostras não passa de 1/8, limitando o atraso após a
+// chegada do token a uma fração da latência.
+constexpr uint32_t DIVISOR_INTERVALO_LATENCIA_TOKEN = 8u;
+}
+
+const char *descreverMotivoFrequencia(MotivoFrequencia motivo) {
+    switch (motivo) {
+        case MotivoFrequencia::LimiteVelocidadePadrao:
+            return "limite de 25 MHz do modo padrao";
+        case MotivoFrequencia::LimiteAltaVelocidade:
+            return "limite de 50 MHz do modo alta velocidade";
+        case MotivoFrequencia::LimiteDivisorPeriferico:
+            return "menor divisor do clk_peri alcancado";
+        case MotivoFrequencia::FalhaVerificacao:
+            return "passo seguinte falhou na leitura de verificacao";
+        case MotivoFrequencia::NaoNegociada:
+        default:
+            return "frequencia base, sem negociacao";
+    }
 }
 
 DriverCartaoSd::DriverCartaoSd(ControladorSpiCartao &controlador_spi)
     : controlador(controlador_spi),
       cartaoInicializado(false),
       cartaoAltaCapacidade(false),
-      quantidadeSetores(0u) {}
+      escritaAdiada(false),
+      programacaoPendente(false),
+      escritaNaoConfirmada(false),
+      estrategiaEspera(EstrategiaEspera::Varredura),
+      estatisticasEspera{},
+      latenciaTokenUs(0u),
+      quantidadeSetores(0u),
+      modoAltaVelocidade(false),
+      motivoFrequencia(MotivoFrequencia::NaoNegociada),
+      ultimoCrcDados(0u),
+      verificacaoCrcSolicitada(true),
+      verificacaoCrcAtiva(false),
+      ultimaFalhaCrc(false),
+      errosCrc(0u),
+      setoresUnidadeAlocacao(0u),
+      informacoes{}
+#ifdef HABILITAR_HISTOGRAMAS_CARTAO_SD
+      , histogramas(),
+      tipoComandoAtual(TipoComando::Outros),
+      ultimoComandoEnviado(0u)
+#endif
+{
+}
 
 bool DriverCartaoSd::iniciar() {
     if (cartaoInicializado) {
@@ -76,6 +157,13 @@ bool DriverCartaoSd::iniciar() {
         return false;
     }
 
+    verificacaoCrcAtiva = false;
+    if (verificacaoCrcSolicitada) {
+        uint8_t resposta_cmd59[1] = {0};
+        bool enviou_cmd59 = enviarComando(COMANDO_CRC_ON_OFF, 1u, resposta_cmd59, sizeof(resposta_cmd59));
+        verificacaoCrcAtiva = enviou_cmd59 && resposta_cmd59[0] == RESPOSTA_IDLE;
+    }
+
     bool iniciou = false;
     absolute_time_t tempo_limite = make_timeout_time_ms(TEMPO_TIMEOUT_INICIALIZACAO_MS);
 
@@ -130,11 +218,16 @@ bool DriverCartaoSd::iniciar() {
 
     controlador.ajustarFrequenciaAlta();
 
-    if (!atualizarQuantidadeSetores()) {
+    if (!atualizarRegistros()) {
         return false;
     }
 
     cartaoInicializado = true;
+
+    modoAltaVelocidade = negociarAltaVelocidade();
+    ajustarFrequenciaMaxima();
+    atualizarUnidadeAlocacao();
+
     return true;
 }
 
@@ -151,18 +244,43 @@ bool DriverCartaoSd::lerSetores(uint8_t *destino, uint32_t setor_inicial, uint32
         return false;
     }
 
-    uint32_t indice = 0;
+    if (quantidade == 0u) {
+        return true;
+    }
 
-    while (indice < quantidade) {
-        uint32_t setor_atual = setor_inicial + indice;
-        uint8_t *destino_bloco = destino + (indice * TAMANHO_SETOR_BYTES);
+    // Falhas de CRC repetem apenas o trecho a partir do bloco corrompido,
+    // com limite de tentativas por bloco.
+    uint32_t lidos = 0u;
+    uint32_t tentativas = 0u;
+
+    while (lidos < quantidade) {
+        uint8_t *destino_trecho = destino + (lidos * TAMANHO_SETOR_BYTES);
+        uint32_t setor_trecho = setor_inicial + lidos;
+        uint32_t restantes = quantidade - lidos;
+        uint32_t lidos_trecho = 0u;
+
+        bool leu = false;
+        if (restantes == 1u) {
+            leu = lerBloco(destino_trecho, setor_trecho);
+            lidos_trecho = leu ? 1u : 0u;
+        } else {
+            leu = lerBlocosMultiplos(destino_trecho, setor_trecho, restantes, lidos_trecho);
+        }
+
+        lidos = lidos + lidos_trecho;
+        if (leu) {
+            continue;
+        }
 
-        bool leu = lerBloco(destino_bloco, setor_atual);
-        if (!leu) {
+        if (lidos_trecho > 0u) {
+            tentativas = 0u;
+        }
+
+        if (!ultimaFalhaCrc || tentativas >= TENTATIVAS_CRC_MAXIMAS) {
             return false;
         }
 
-        indice = indice + 1;
+        tentativas = tentativas + 1u;
     }
 
     return true;
@@ -177,32 +295,166 @@ bool DriverCartaoSd::escreverSetores(const uint8_t *origem, uint32_t setor_inici
         return false;
     }
 
-    uint32_t indice = 0;
+    if (quantidade == 0u) {
+        return true;
+    }
 
-    while (indice < quantidade) {
-        uint32_t setor_atual = setor_inicial + indice;
-        const uint8_t *origem_bloco = origem + (indice * TAMANHO_SETOR_BYTES);
+    if (quantidade == 1u) {
+        return escreverBloco(origem, setor_inicial);
+    }
 
-        bool escreveu = escreverBloco(origem_bloco, setor_atual);
-        if (!escreveu) {
-            return false;
+    return escreverBlocosMultiplos(origem, setor_inicial, quantidade);
+}
+
+bool DriverCartaoSd::apagarSetores(uint32_t setor_inicial, uint32_t setor_final) {
+    if (!cartaoInicializado) {
+        return false;
+    }
+
+    if (setor_final < setor_inicial || setor_final >= quantidadeSetores) {
+        return false;
+    }
+
+    controlador.adquirirBarramento();
+
+    uint8_t resposta_cmd32[1] = {0};
+    bool enviou = enviarComando(COMANDO_ERASE_WR_BLK_START, ajustarArgumentoSetor(setor_inicial), resposta_cmd32, sizeof(resposta_cmd32));
+    if (!enviou || resposta_cmd32[0] != RESPOSTA_PRONTA) {
+        controlador.liberarBarramento();
+        return false;
+    }
+
+    uint8_t resposta_cmd33[1] = {0};
+    enviou = enviarComando(COMANDO_ERASE_WR_BLK_END, ajustarArgumentoSetor(setor_final), resposta_cmd33, sizeof(resposta_cmd33));
+    if (!enviou || resposta_cmd33[0] != RESPOSTA_PRONTA) {
+        controlador.liberarBarramento();
+        return false;
+    }
+
+    uint8_t resposta_cmd38[1] = {0};
+    enviou = enviarComando(COMANDO_ERASE, 0u, resposta_cmd38, sizeof(resposta_cmd38));
+    if (!enviou || resposta_cmd38[0] != RESPOSTA_PRONTA) {
+        controlador.liberarBarramento();
+        return false;
+    }
+
+    // Para intervalos grandes, a estimativa do SD Status pode passar do limite fixo.
+    uint32_t tempo_limite_ms = TEMPO_TIMEOUT_APAGAMENTO_MS;
+    if (informacoes.status_valido) {
+        uint32_t estimativa_ms = estimarTempoApagamentoMs(informacoes.status, setor_final - setor_inicial + 1u);
+        if (estimativa_ms > tempo_limite_ms) {
+            tempo_limite_ms = estimativa_ms;
         }
+    }
 
-        indice = indice + 1;
+    bool apagou = aguardarPronto(tempo_limite_ms);
+
+    controlador.liberarBarramento();
+    return apagou;
+}
+
+bool DriverCartaoSd::sincronizar() {
+    if (!cartaoInicializado) {
+        return false;
     }
 
-    return true;
+    // Outro comando pode já ter aguardado a programação sem ler o status; só o
+    // CMD13 revela proteção contra escrita, ECC ou erro interno do cartão.
+    if (!escritaNaoConfirmada) {
+        return true;
+    }
+
+    escritaNaoConfirmada = false;
+
+    controlador.adquirirBarramento();
+
+    // O CMD13 aguarda o fim da programação pendente e confirma que ela não falhou.
+    uint8_t resposta_cmd13[2] = {0};
+    bool enviou = enviarComando(COMANDO_SEND_STATUS, 0u, resposta_cmd13, sizeof(resposta_cmd13));
+
+    controlador.liberarBarramento();
+
+    return enviou && resposta_cmd13[0] == RESPOSTA_PRONTA && resposta_cmd13[1] == 0u;
+}
+
+void DriverCartaoSd::definirEscritaAdiada(bool habilitar) {
+    escritaAdiada = habilitar;
+}
+
+void DriverCartaoSd::definirVerificacaoCrc(bool habilitar) {
+    verificacaoCrcSolicitada = habilitar;
+}
+
+bool DriverCartaoSd::estaComVerificacaoCrc() const {
+    return verificacaoCrcAtiva;
+}
+
+uint32_t DriverCartaoSd::obterErrosCrc() const {
+    return errosCrc;
+}
+
+void DriverCartaoSd::definirEstrategiaEspera(EstrategiaEspera estrategia) {
+    estrategiaEspera = estrategia;
+}
+
+EstrategiaEspera DriverCartaoSd::obterEstrategiaEspera() const {
+    return estrategiaEspera;
+}
+
+EstatisticasEspera DriverCartaoSd::obterEstatisticasEspera() const {
+    return estatisticasEspera;
+}
+
+void DriverCartaoSd::zerarEstatisticasEspera() {
+    estatisticasEspera = EstatisticasEspera{};
+}
+
+#ifdef HABILITAR_HISTOGRAMAS_CARTAO_SD
+const HistogramasComandos &DriverCartaoSd::obterHistogramas() const {
+    return histogramas;
+}
+
+void DriverCartaoSd::zerarHistogramas() {
+    histogramas.zerar();
 }
+#endif
 
 uint64_t DriverCartaoSd::obterQuantidadeSetores() const {
     return quantidadeSetores;
 }
 
+uint32_t DriverCartaoSd::obterSetoresUnidadeAlocacao() const {
+    return setoresUnidadeAlocacao;
+}
+
+InformacoesCartao DriverCartaoSd::obterInformacoes() const {
+    return informacoes;
+}
+
+uint32_t DriverCartaoSd::obterFrequenciaOperacao() const {
+    return controlador.obterFrequenciaAtual();
+}
+
+MotivoFrequencia DriverCartaoSd::obterMotivoFrequencia() const {
+    return motivoFrequencia;
+}
+
+bool DriverCartaoSd::estaEmAltaVelocidade() const {
+    return modoAltaVelocidade;
+}
+
 bool DriverCartaoSd::enviarComando(uint8_t comando, uint32_t argumento, uint8_t *resposta, size_t tamanho_resposta) {
     if (resposta == nullptr || tamanho_resposta == 0) {
         return false;
     }
 
+    if (programacaoPendente) {
+        programacaoPendente = false;
+        if (!aguardarPronto(TEMPO_TIMEOUT_DADOS_MS)) {
+            return false;
+        }
+    }
+
     uint8_t pacote[6];
     pacote[0] = static_cast<uint8_t>(0x40u | comando);
     pacote[1] = static_cast<uint8_t>((argumento >> 24u) & 0xFFu);
@@ -210,22 +462,29 @@ bool DriverCartaoSd::enviarComando(uint8_t comando, uint32_t argumento, uint8_t
     pacote[3] = static_cast<uint8_t>((argumento >> 8u) & 0xFFu);
     pacote[4] = static_cast<uint8_t>(argumento & 0xFFu);
 
-    uint8_t crc = 0xFFu;
-    if (comando == COMANDO_GO_IDLE) {
-        crc = CRC_CMD0;
-    } else if (comando == COMANDO_SEND_IF_COND) {
-        crc = CRC_CMD8;
-    }
-
-    pacote[5] = crc;
+    pacote[5] = calcularByteCrc7(pacote, 5u);
 
     controlador.transferirBuffer(pacote, nullptr, sizeof(pacote));
 
+#ifdef HABILITAR_HISTOGRAMAS_CARTAO_SD
+    // A espera de ocupado que vier depois é cobrada deste comando; um ACMD é
+    // reconhecido pelo CMD55 que o precede.
+    tipoComandoAtual = classificarComando(comando, ultimoComandoEnviado == COMANDO_APP_CMD);
+    ultimoComandoEnviado = comando;
+#endif
+    CARTAO_SD_MARCAR_INICIO(inicio_resposta_us);
+
+    if (comando == COMANDO_STOP_TRANSMISSION) {
+        // O byte seguinte ao CMD12 ainda pertence ao bloco interrompido.
+        controlador.transferirByte(0xFFu);
+    }
+
     absolute_time_t tempo_limite = make_timeout_time_ms(TEMPO_TIMEOUT_COMANDO_MS);
 
     while (absolute_time_diff_us(get_absolute_time(), tempo_limite) > 0) {
         uint8_t valor = controlador.transferirByte(0xFFu);
         if ((valor & MASCARA_RESPOSTA_ERRO) == 0u) {
+            CARTAO_SD_REGISTRAR_FASE(FaseComando::Resposta, inicio_resposta_us);
             resposta[0] = valor;
 
             size_t indice = 1;
@@ -238,6 +497,7 @@ bool DriverCartaoSd::enviarComando(uint8_t comando, uint32_t argumento, uint8_t
         }
     }
 
+    CARTAO_SD_REGISTRAR_FASE(FaseComando::Resposta, inicio_resposta_us);
     return false;
 }
 
@@ -252,10 +512,23 @@ bool DriverCartaoSd::enviarComandoAplicativo(uint8_t comando, uint32_t argumento
 }
 
 bool DriverCartaoSd::aguardarPronto(uint32_t tempo_limite_ms) {
+    uint64_t inicio_us = time_us_64();
     absolute_time_t tempo_limite = make_timeout_time_ms(tempo_limite_ms);
+    uint32_t bytes_amostrados = 0u;
+
+    bool pronto = (estrategiaEspera == EstrategiaEspera::Evento)
+        ? aguardarProntoPorEvento(tempo_limite, bytes_amostrados)
+        : aguardarProntoPorVarredura(tempo_limite, bytes_amostrados);
+
+    registrarEspera(inicio_us, bytes_amostrados);
+    CARTAO_SD_REGISTRAR_FASE(FaseComando::Ocupado, inicio_us);
+    return pronto;
+}
 
+bool DriverCartaoSd::aguardarProntoPorVarredura(absolute_time_t tempo_limite, uint32_t &bytes_amostrados) {
     while (absolute_time_diff_us(get_absolute_time(), tempo_limite) > 0) {
         uint8_t valor = controlador.transferirByte(0xFFu);
+        bytes_amostrados = bytes_amostrados + 1u;
         if (valor == 0xFFu) {
             return true;
         }
@@ -264,11 +537,50 @@ bool DriverCartaoSd::aguardarPronto(uint32_t tempo_limite_ms) {
     return false;
 }
 
+bool DriverCartaoSd::aguardarProntoPorEvento(absolute_time_t tempo_limite, uint32_t &bytes_amostrados) {
+    // Enquanto ocupado o cartão mantém o MISO em nível baixo; o núcleo dorme
+    // até a borda de subida e um byte de clock confirma a liberação.
+    while (absolute_time_diff_us(get_absolute_time(), tempo_limite) > 0) {
+        uint8_t valor = controlador.transferirByte(0xFFu);
+        bytes_amostrados = bytes_amostrados + 1u;
+        if (valor == 0xFFu) {
+            return true;
+        }
+
+        controlador.aguardarMisoLiberado(tempo_limite);
+    }
+
+    return false;
+}
+
+bool DriverCartaoSd::concluirProgramacao() {
+    if (escritaAdiada) {
+        programacaoPendente = true;
+        escritaNaoConfirmada = true;
+        return true;
+    }
+
+    return aguardarPronto(TEMPO_TIMEOUT_DADOS_MS);
+}
+
 bool DriverCartaoSd::aguardarToken(uint8_t token, uint32_t tempo_limite_ms, uint8_t &valor_recebido) {
+    uint64_t inicio_us = time_us_64();
     absolute_time_t tempo_limite = make_timeout_time_ms(tempo_limite_ms);
+    uint32_t bytes_amostrados = 0u;
+
+    bool recebeu = (estrategiaEspera == EstrategiaEspera::Evento)
+        ? aguardarTokenPorEvento(token, tempo_limite, valor_recebido, bytes_amostrados)
+        : aguardarTokenPorVarredura(token, tempo_limite, valor_recebido, bytes_amostrados);
 
+    registrarEspera(inicio_us, bytes_amostrados);
+    CARTAO_SD_REGISTRAR_FASE(FaseComando::Token, inicio_us);
+    return recebeu;
+}
+
+bool DriverCartaoSd::aguardarTokenPorVarredura(uint8_t token, absolute_time_t tempo_limite, uint8_t &valor_recebido, uint32_t &bytes_amostrados) {
     while (absolute_time_diff_us(get_absolute_time(), tempo_limite) > 0) {
         uint8_t valor = controlador.transferirByte(0xFFu);
+        bytes_amostrados = bytes_amostrados + 1u;
         if (valor == token) {
             valor_recebido = valor;
             return true;
@@ -284,6 +596,100 @@ bool DriverCartaoSd::aguardarToken(uint8_t token, uint32_t tempo_limite_ms, uint
     return false;
 }
 
+bool DriverCartaoSd::aguardarTokenPorEvento(uint8_t token, absolute_time_t tempo_limite, uint8_t &valor_recebido, uint32_t &bytes_amostrados) {
+    // O token só sai do cartão com clock, então a linha é amostrada um byte
+    // por vez com intervalos crescentes em que o núcleo fica dormindo.
+    uint64_t inicio_us = time_us_64();
+    uint64_t amostra_anterior_us = 0u;
+    uint32_t intervalo_us = INTERVALO_AMOSTRA_TOKEN_INICIAL_US;
+    uint32_t intervalo_maximo_us = INTERVALO_AMOSTRA_TOKEN_MAXIMO_US;
+    if (latenciaTokenUs > 0u) {
+        intervalo_us = (latenciaTokenUs * 3u) / 4u;
+        intervalo_maximo_us = latenciaTokenUs / DIVISOR_INTERVALO_LATENCIA_TOKEN;
+        if (intervalo_maximo_us < INTERVALO_AMOSTRA_TOKEN_INICIAL_US) {
+            intervalo_maximo_us = INTERVALO_AMOSTRA_TOKEN_INICIAL_US;
+        } else if (intervalo_maximo_us > INTERVALO_AMOSTRA_TOKEN_MAXIMO_US) {
+            intervalo_maximo_us = INTERVALO_AMOSTRA_TOKEN_MAXIMO_US;
+        }
+    }
+
+    while (absolute_time_diff_us(get_absolute_time(), tempo_limite) > 0) {
+        uint8_t valor = controlador.transferirByte(0xFFu);
+        bytes_amostrados = bytes_amostrados + 1u;
+        uint64_t amostra_us = time_us_64() - inicio_us;
+        if (valor == token) {
+            // O token chegou entre a amostra anterior e esta; o ponto médio
+            // entra numa média móvel (3/4 da anterior) da latência.
+            uint32_t latencia_us = static_cast<uint32_t>((amostra_anterior_us + amostra_us) / 2u);
+            latenciaTokenUs = (latenciaTokenUs == 0u) ? latencia_us : ((latenciaTokenUs * 3u) + latencia_us) / 4u;
+            valor_recebido = valor;
+            return true;
+        }
+
+        if (valor != 0xFFu) {
+            valor_recebido = valor;
+            return false;
+        }
+
+        amostra_anterior_us = amostra_us;
+        absolute_time_t proxima_amostra = make_timeout_time_us(intervalo_us);
+        if (absolute_time_diff_us(proxima_amostra, tempo_limite) < 0) {
+            proxima_amostra = tempo_limite;
+        }
+        while (!best_effort_wfe_or_timeout(proxima_amostra)) {
+        }
+
+        intervalo_us = (intervalo_us > intervalo_maximo_us) ? INTERVALO_AMOSTRA_TOKEN_INICIAL_US : intervalo_us * 2u;
+        if (intervalo_us > intervalo_maximo_us) {
+            intervalo_us = intervalo_maximo_us;
+        }
+    }
+
+    valor_recebido = 0xFFu;
+    return false;
+}
+
+void DriverCartaoSd::registrarEspera(uint64_t inicio_us, uint32_t bytes_amostrados) {
+    uint64_t duracao_us = time_us_64() - inicio_us;
+
+    if (estrategiaEspera == EstrategiaEspera::Evento) {
+        estatisticasEspera.esperas_evento = estatisticasEspera.esperas_evento + 1u;
+        estatisticasEspera.tempo_evento_us = estatisticasEspera.tempo_evento_us + duracao_us;
+        estatisticasEspera.bytes_evento = estatisticasEspera.bytes_evento + bytes_amostrados;
+        return;
+    }
+
+    estatisticasEspera.esperas_varredura = estatisticasEspera.esperas_varredura + 1u;
+    estatisticasEspera.tempo_varredura_us = estatisticasEspera.tempo_varredura_us + duracao_us;
+    estatisticasEspera.bytes_varredura = estatisticasEspera.bytes_varredura + bytes_amostrados;
+}
+
+bool DriverCartaoSd::receberBlocoDados(uint8_t *destino, size_t tamanho) {
+    ultimaFalhaCrc = false;
+
+    uint8_t token = 0u;
+    bool recebeu_token = aguardarToken(TOKEN_INICIO_DADOS, TEMPO_TIMEOUT_DADOS_MS, token);
+    if (!recebeu_token || token != TOKEN_INICIO_DADOS) {
+        return false;
+    }
+
+    uint16_t crc_calculado = 0u;
+    bool leu = verificacaoCrcAtiva
+        ? controlador.transferirBufferComCrc(nullptr, destino, tamanho, crc_calculado)
+        : controlador.transferirBuffer(nullptr, destino, tamanho);
+    uint8_t crc_alto = controlador.transferirByte(0xFFu);
+    uint8_t crc_baixo = controlador.transferirByte(0xFFu);
+    ultimoCrcDados = static_cast<uint16_t>((crc_alto << 8u) | crc_baixo);
+
+    if (leu && verificacaoCrcAtiva && crc_calculado != ultimoCrcDados) {
+        ultimaFalhaCrc = true;
+        errosCrc = errosCrc + 1u;
+        return false;
+    }
+
+    return leu;
+}
+
 bool DriverCartaoSd::lerBloco(uint8_t *destino, uint32_t setor) {
     controlador.adquirirBarramento();
 
@@ -296,111 +702,384 @@ bool DriverCartaoSd::lerBloco(uint8_t *destino, uint32_t setor) {
         return false;
     }
 
-    uint8_t token = 0u;
-    bool recebeu_token = aguardarToken(TOKEN_INICIO_DADOS, TEMPO_TIMEOUT_DADOS_MS, token);
-    if (!recebeu_token || token != TOKEN_INICIO_DADOS) {
+    bool leu = receberBlocoDados(destino, TAMANHO_SETOR_BYTES);
+
+    controlador.liberarBarramento();
+    return leu;
+}
+
+bool DriverCartaoSd::lerBlocosMultiplos(uint8_t *destino, uint32_t setor_inicial, uint32_t quantidade, uint32_t &blocos_lidos) {
+    blocos_lidos = 0u;
+
+    controlador.adquirirBarramento();
+
+    uint8_t resposta_cmd[1] = {0};
+    uint32_t argumento = ajustarArgumentoSetor(setor_inicial);
+
+    bool enviou = enviarComando(COMANDO_READ_MULTIPLE, argumento, resposta_cmd, sizeof(resposta_cmd));
+    if (!enviou || resposta_cmd[0] != RESPOSTA_PRONTA) {
         controlador.liberarBarramento();
         return false;
     }
 
-    bool leu = controlador.transferirBuffer(nullptr, destino, TAMANHO_SETOR_BYTES);
-    controlador.transferirByte(0xFFu);
-    controlador.transferirByte(0xFFu);
+    bool leu = true;
+    uint32_t indice = 0;
+
+    while (indice < quantidade) {
+        uint8_t *destino_bloco = destino + (indice * TAMANHO_SETOR_BYTES);
+        if (!receberBlocoDados(destino_bloco, TAMANHO_SETOR_BYTES)) {
+            leu = false;
+            break;
+        }
+
+        indice = indice + 1;
+    }
+
+    blocos_lidos = indice;
+
+    // O CMD12 é obrigatório mesmo após falha, senão o cartão continua transmitindo.
+    bool falha_crc = ultimaFalhaCrc;
+    bool encerrou = encerrarTransmissao();
+    ultimaFalhaCrc = falha_crc;
 
     controlador.liberarBarramento();
-    return leu;
+    return leu && encerrou;
+}
+
+bool DriverCartaoSd::encerrarTransmissao() {
+    uint8_t resposta_cmd[1] = {0};
+    bool enviou = enviarComando(COMANDO_STOP_TRANSMISSION, 0u, resposta_cmd, sizeof(resposta_cmd));
+    if (!enviou || resposta_cmd[0] != RESPOSTA_PRONTA) {
+        return false;
+    }
+
+    return aguardarPronto(TEMPO_TIMEOUT_DADOS_MS);
+}
+
+bool DriverCartaoSd::enviarBlocoDados(uint8_t token, const uint8_t *origem) {
+    // Entre blocos de um CMD25 o cartão sinaliza ocupado; a espera também
+    // garante o byte de intervalo exigido antes do token.
+    if (!aguardarPronto(TEMPO_TIMEOUT_DADOS_MS)) {
+        return false;
+    }
+
+    controlador.transferirByte(token);
+
+    uint16_t crc = 0xFFFFu;
+    bool escreveu = verificacaoCrcAtiva
+        ? controlador.transferirBufferComCrc(origem, nullptr, TAMANHO_SETOR_BYTES, crc)
+        : controlador.transferirBuffer(origem, nullptr, TAMANHO_SETOR_BYTES);
+    controlador.transferirByte(static_cast<uint8_t>(crc >> 8u));
+    controlador.transferirByte(static_cast<uint8_t>(crc & 0xFFu));
+
+    uint8_t resposta_dados = controlador.transferirByte(0xFFu);
+    bool aceitou = (resposta_dados & MASCARA_RESPOSTA_ESCRITA) == RESPOSTA_ESCRITA_OK;
+
+    if ((resposta_dados & MASCARA_RESPOSTA_ESCRITA) == RESPOSTA_ESCRITA_ERRO_CRC) {
+        ultimaFalhaCrc = true;
+        errosCrc = errosCrc + 1u;
+    }
+
+    return escreveu && aceitou;
 }
 
 bool DriverCartaoSd::escreverBloco(const uint8_t *origem, uint32_t setor) {
+    uint32_t tentativas = 0u;
+
+    for (;;) {
+        bool escreveu = tentarEscreverBloco(origem, setor);
+        if (escreveu || !ultimaFalhaCrc || tentativas >= TENTATIVAS_CRC_MAXIMAS) {
+            return escreveu;
+        }
+
+        tentativas = tentativas + 1u;
+    }
+}
+
+bool DriverCartaoSd::tentarEscreverBloco(const uint8_t *origem, uint32_t setor) {
+    ultimaFalhaCrc = false;
+
     controlador.adquirirBarramento();
 
-    bool pronto = aguardarPronto(TEMPO_TIMEOUT_DADOS_MS);
-    if (!pronto) {
+    uint8_t resposta_cmd[1] = {0};
+    uint32_t argumento = ajustarArgumentoSetor(setor);
+
+    bool enviou = enviarComando(COMANDO_WRITE_SINGLE, argumento, resposta_cmd, sizeof(resposta_cmd));
+    if (!enviou || resposta_cmd[0] != RESPOSTA_PRONTA) {
         controlador.liberarBarramento();
         return false;
     }
 
+    bool escreveu = enviarBlocoDados(TOKEN_INICIO_DADOS, origem);
+    bool finalizou = escreveu ? concluirProgramacao() : aguardarPronto(TEMPO_TIMEOUT_DADOS_MS);
+
+    controlador.liberarBarramento();
+
+    return escreveu && finalizou;
+}
+
+bool DriverCartaoSd::escreverBlocosMultiplos(const uint8_t *origem, uint32_t setor_inicial, uint32_t quantidade) {
+    controlador.adquirirBarramento();
+
+    // ACMD23 é apenas uma dica de pré-apagamento; a escrita segue mesmo se recusado.
+    uint8_t resposta_acmd[1] = {0};
+    enviarComandoAplicativo(COMANDO_APP_SET_WR_BLK, quantidade & MASCARA_CONTAGEM_PRE_APAGAMENTO, resposta_acmd, sizeof(resposta_acmd));
+
     uint8_t resposta_cmd[1] = {0};
-    uint32_t argumento = ajustarArgumentoSetor(setor);
+    uint32_t argumento = ajustarArgumentoSetor(setor_inicial);
 
-    bool enviou = enviarComando(COMANDO_WRITE_SINGLE, argumento, resposta_cmd, sizeof(resposta_cmd));
+    bool enviou = enviarComando(COMANDO_WRITE_MULTIPLE, argumento, resposta_cmd, sizeof(resposta_cmd));
     if (!enviou || resposta_cmd[0] != RESPOSTA_PRONTA) {
         controlador.liberarBarramento();
         return false;
     }
 
-    controlador.transferirByte(TOKEN_INICIO_DADOS);
+    uint32_t indice = 0;
 
-    bool escreveu = controlador.transferirBuffer(origem, nullptr, TAMANHO_SETOR_BYTES);
-    controlador.transferirByte(0xFFu);
-    controlador.transferirByte(0xFFu);
+    while (indice < quantidade) {
+        const uint8_t *origem_bloco = origem + (indice * TAMANHO_SETOR_BYTES);
+        if (!enviarBlocoDados(TOKEN_ESCRITA_MULTIPLA, origem_bloco)) {
+            break;
+        }
 
-    uint8_t resposta_dados = controlador.transferirByte(0xFFu);
-    bool aceitou = (resposta_dados & MASCARA_RESPOSTA_ESCRITA) == RESPOSTA_ESCRITA_OK;
+        indice = indice + 1;
+    }
+
+    if (indice == quantidade) {
+        bool pronto = aguardarPronto(TEMPO_TIMEOUT_DADOS_MS);
+        controlador.transferirByte(TOKEN_PARADA_ESCRITA);
+        controlador.transferirByte(0xFFu);
+        bool finalizou = pronto && concluirProgramacao();
+
+        controlador.liberarBarramento();
+        return finalizou;
+    }
 
-    bool finalizou = aguardarPronto(TEMPO_TIMEOUT_DADOS_MS);
+    // Bloco rejeitado: a transmissão é abortada com CMD12 e o ACMD22 informa
+    // quantos blocos o cartão gravou sem erro antes da falha.
+    aguardarPronto(TEMPO_TIMEOUT_DADOS_MS);
+    encerrarTransmissao();
+
+    uint32_t blocos_gravados = 0u;
+    if (!obterBlocosGravados(blocos_gravados) || blocos_gravados > indice) {
+        blocos_gravados = indice;
+    }
 
     controlador.liberarBarramento();
 
-    return escreveu && aceitou && finalizou;
+    // Os blocos restantes são reenviados um a um, uma única vez.
+    uint32_t restante = blocos_gravados;
+    while (restante < quantidade) {
+        const uint8_t *origem_bloco = origem + (restante * TAMANHO_SETOR_BYTES);
+        if (!escreverBloco(origem_bloco, setor_inicial + restante)) {
+            return false;
+        }
+
+        restante = restante + 1;
+    }
+
+    return true;
 }
 
-bool DriverCartaoSd::atualizarQuantidadeSetores() {
-    uint8_t csd[16];
-    bool leu_csd = lerCsd(csd, sizeof(csd));
-    if (!leu_csd) {
+bool DriverCartaoSd::obterBlocosGravados(uint32_t &blocos_gravados) {
+    uint8_t resposta_acmd[1] = {0};
+    bool enviou = enviarComandoAplicativo(COMANDO_APP_SEND_NUM_WR_BLOCKS, 0u, resposta_acmd, sizeof(resposta_acmd));
+    if (!enviou || resposta_acmd[0] != RESPOSTA_PRONTA) {
         return false;
     }
 
-    uint8_t versao = (csd[0] >> 6u) & 0x03u;
-
-    if (versao == 1u) {
-        uint32_t c_size = ((uint32_t)(csd[7] & 0x3Fu) << 16u) |
-                          ((uint32_t)csd[8] << 8u) |
-                          csd[9];
-        quantidadeSetores = (static_cast<uint64_t>(c_size) + 1u) * 1024u;
-        return true;
+    uint8_t contagem[4] = {0};
+    if (!receberBlocoDados(contagem, sizeof(contagem))) {
+        return false;
     }
 
-    uint32_t c_size = (((uint32_t)(csd[6] & 0x03u)) << 10u) |
-                      ((uint32_t)csd[7] << 2u) |
-                      ((csd[8] & 0xC0u) >> 6u);
+    blocos_gravados = ((uint32_t)contagem[0] << 24u) |
+                      ((uint32_t)contagem[1] << 16u) |
+                      ((uint32_t)contagem[2] << 8u) |
+                      contagem[3];
+    return true;
+}
 
-    uint32_t c_size_mult = ((csd[9] & 0x03u) << 1u) | ((csd[10] & 0x80u) >> 7u);
-    uint32_t block_len = csd[5] & 0x0Fu;
+bool DriverCartaoSd::lerStatusSd(uint8_t *status, size_t tamanho_status) {
+    if (status == nullptr || tamanho_status < TAMANHO_STATUS_SD) {
+        return false;
+    }
 
-    uint32_t mult = 1u << (c_size_mult + 2u);
-    uint32_t block_len_bytes = 1u << block_len;
-    uint64_t capacidade = (static_cast<uint64_t>(c_size) + 1u) * mult * block_len_bytes;
+    controlador.adquirirBarramento();
 
-    quantidadeSetores = capacidade / TAMANHO_SETOR_BYTES;
-    return quantidadeSetores != 0u;
+    // O ACMD13 responde com R2 seguido de um bloco de dados de 64 bytes.
+    uint8_t resposta_acmd[2] = {0};
+    bool enviou = enviarComandoAplicativo(COMANDO_APP_SD_STATUS, 0u, resposta_acmd, sizeof(resposta_acmd));
+    bool leu = enviou && resposta_acmd[0] == RESPOSTA_PRONTA &&
+               receberBlocoDados(status, TAMANHO_STATUS_SD);
+
+    controlador.liberarBarramento();
+    return leu;
 }
 
-bool DriverCartaoSd::lerCsd(uint8_t *dados_csd, size_t tamanho_csd) {
-    if (dados_csd == nullptr || tamanho_csd != 16u) {
-        return false;
+void DriverCartaoSd::atualizarUnidadeAlocacao() {
+    setoresUnidadeAlocacao = 0u;
+    informacoes.status_valido = false;
+
+    uint8_t status[TAMANHO_STATUS_SD] = {0};
+    if (!lerStatusSd(status, sizeof(status))) {
+        return;
     }
 
+    interpretarStatusSd(status, informacoes.status);
+    informacoes.status_valido = true;
+    setoresUnidadeAlocacao = informacoes.status.setores_unidade_alocacao;
+}
+
+bool DriverCartaoSd::enviarComandoSwitch(uint32_t argumento, uint8_t *status, size_t tamanho_status) {
     controlador.adquirirBarramento();
 
     uint8_t resposta_cmd[1] = {0};
-    bool enviou = enviarComando(COMANDO_SEND_CSD, 0u, resposta_cmd, sizeof(resposta_cmd));
+    bool enviou = enviarComando(COMANDO_SWITCH_FUNC, argumento, resposta_cmd, sizeof(resposta_cmd));
     if (!enviou || resposta_cmd[0] != RESPOSTA_PRONTA) {
         controlador.liberarBarramento();
         return false;
     }
 
-    uint8_t token = 0u;
-    bool recebeu_token = aguardarToken(TOKEN_INICIO_DADOS, TEMPO_TIMEOUT_DADOS_MS, token);
-    if (!recebeu_token || token != TOKEN_INICIO_DADOS) {
+    bool leu = receberBlocoDados(status, tamanho_status);
+
+    controlador.liberarBarramento();
+    return leu;
+}
+
+bool DriverCartaoSd::negociarAltaVelocidade() {
+    if ((informacoes.csd.classes_comando & CLASSE_COMANDO_SWITCH) == 0u) {
+        return false;
+    }
+
+    // Status de 512 bits: o bit 401 indica suporte à função 1 do grupo 1 e
+    // os bits 379:376 confirmam a função efetivamente selecionada.
+    uint8_t status[TAMANHO_STATUS_SWITCH];
+    if (!enviarComandoSwitch(ARGUMENTO_SWITCH_CONSULTAR_ALTA_VELOCIDADE, status, sizeof(status))) {
+        return false;
+    }
+
+    if ((status[13] & 0x02u) == 0u) {
+        return false;
+    }
+
+    if (!enviarComandoSwitch(ARGUMENTO_SWITCH_ATIVAR_ALTA_VELOCIDADE, status, sizeof(status))) {
+        return false;
+    }
+
+    return (status[16] & 0x0Fu) == 0x01u;
+}
+
+void DriverCartaoSd::ajustarFrequenciaMaxima() {
+    uint32_t limite_hz = modoAltaVelocidade ? FREQUENCIA_MAXIMA_ALTA_VELOCIDADE_HZ : FREQUENCIA_MAXIMA_PADRAO_HZ;
+    uint32_t frequencia_estavel = controlador.obterFrequenciaAtual();
+    uint32_t frequencia_periferica = controlador.obterFrequenciaPeriferica();
+
+    uint8_t referencia[TAMANHO_SETOR_BYTES];
+    if (frequencia_estavel == 0u ||
+        !lerBloco(referencia, SETOR_VERIFICACAO) ||
+        calcularCrc16(referencia, sizeof(referencia)) != ultimoCrcDados) {
+        motivoFrequencia = MotivoFrequencia::FalhaVerificacao;
+        return;
+    }
+
+    // O divisor do SPI do RP2040 é par; cada passo tenta o próximo divisor
+    // menor e só é aceito se as leituras repetidas baterem com a referência.
+    uint32_t divisor = (frequencia_periferica + frequencia_estavel - 1u) / frequencia_estavel;
+    if ((divisor % 2u) != 0u) {
+        divisor = divisor + 1u;
+    }
+
+    motivoFrequencia = MotivoFrequencia::LimiteDivisorPeriferico;
+
+    while (divisor > DIVISOR_MINIMO_SPI) {
+        divisor = divisor - 2u;
+        uint32_t candidata_hz = frequencia_periferica / divisor;
+
+        if (candidata_hz > limite_hz) {
+            motivoFrequencia = modoAltaVelocidade ? MotivoFrequencia::LimiteAltaVelocidade
+                                                  : MotivoFrequencia::LimiteVelocidadePadrao;
+            break;
+        }
+
+        uint32_t aplicada_hz = controlador.ajustarFrequencia(candidata_hz);
+        if (!verificarLeituraTeste(referencia)) {
+            controlador.ajustarFrequencia(frequencia_estavel);
+            ressincronizarTransmissao();
+            motivoFrequencia = MotivoFrequencia::FalhaVerificacao;
+            break;
+        }
+
+        frequencia_estavel = aplicada_hz;
+    }
+}
+
+bool DriverCartaoSd::verificarLeituraTeste(const uint8_t *referencia) {
+    uint8_t bloco[TAMANHO_SETOR_BYTES];
+    uint32_t leitura = 0u;
+
+    while (leitura < LEITURAS_VERIFICACAO) {
+        if (!lerBloco(bloco, SETOR_VERIFICACAO)) {
+            return false;
+        }
+
+        if (calcularCrc16(bloco, sizeof(bloco)) != ultimoCrcDados) {
+            return false;
+        }
+
+        if (memcmp(bloco, referencia, sizeof(bloco)) != 0) {
+            return false;
+        }
+
+        leitura = leitura + 1u;
+    }
+
+    return true;
+}
+
+void DriverCartaoSd::ressincronizarTransmissao() {
+    // Uma leitura corrompida pode deixar o cartão no meio da transmissão;
+    // o CMD12 interrompe o que restar antes do próximo comando.
+    controlador.adquirirBarramento();
+    encerrarTransmissao();
+    controlador.liberarBarramento();
+}
+
+bool DriverCartaoSd::atualizarRegistros() {
+    uint8_t registro_csd[TAMANHO_REGISTRO_CSD] = {0};
+    informacoes.csd_valido = lerRegistro(COMANDO_SEND_CSD, registro_csd, sizeof(registro_csd));
+    if (!informacoes.csd_valido) {
+        return false;
+    }
+
+    interpretarCsd(registro_csd, informacoes.csd);
+    quantidadeSetores = informacoes.csd.quantidade_setores;
+
+    // O CID é só informativo; uma falha aqui não impede o uso do cartão.
+    uint8_t registro_cid[TAMANHO_REGISTRO_CID] = {0};
+    informacoes.cid_valido = lerRegistro(COMANDO_SEND_CID, registro_cid, sizeof(registro_cid));
+    if (informacoes.cid_valido) {
+        interpretarCid(registro_cid, informacoes.cid);
+    }
+
+    return quantidadeSetores != 0u;
+}
+
+bool DriverCartaoSd::lerRegistro(uint8_t comando, uint8_t *dados, size_t tamanho) {
+    if (dados == nullptr || tamanho != 16u) {
+        return false;
+    }
+
+    controlador.adquirirBarramento();
+
+    uint8_t resposta_cmd[1] = {0};
+    bool enviou = enviarComando(comando, 0u, resposta_cmd, sizeof(resposta_cmd));
+    if (!enviou || resposta_cmd[0] != RESPOSTA_PRONTA) {
         controlador.liberarBarramento();
         return false;
     }
 
-    bool leu = controlador.transferirBuffer(nullptr, dados_csd, tamanho_csd);
-    controlador.transferirByte(0xFFu);
-    controlador.transferirByte(0xFFu);
+    bool leu = receberBlocoDados(dados, tamanho);
 
     controlador.liberarBarramento();
     return leu;
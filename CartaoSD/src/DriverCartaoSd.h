@@ -5,33 +5,119 @@
 #include <stdint.h>
 
 #include "ControladorSpiCartao.h"
+#include "DispositivoBloco.h"
+#include "HistogramasComandos.h"
+#include "InformacoesCartao.h"
 
 namespace cartao_sd {
 
-class DriverCartaoSd {
+enum class EstrategiaEspera : uint8_t {
+    Varredura,
+    Evento
+};
+
+enum class MotivoFrequencia : uint8_t {
+    NaoNegociada,
+    LimiteVelocidadePadrao,
+    LimiteAltaVelocidade,
+    LimiteDivisorPeriferico,
+    FalhaVerificacao
+};
+
+const char *descreverMotivoFrequencia(MotivoFrequencia motivo);
+
+struct EstatisticasEspera {
+    uint32_t esperas_varredura;
+    uint64_t tempo_varredura_us;
+    uint32_t bytes_varredura;
+    uint32_t esperas_evento;
+    uint64_t tempo_evento_us;
+    uint32_t bytes_evento;
+};
+
+class DriverCartaoSd : public DispositivoBloco {
 public:
     explicit DriverCartaoSd(ControladorSpiCartao &controlador_spi);
 
-    bool iniciar();
-    bool estaInicializado() const;
-    bool lerSetores(uint8_t *destino, uint32_t setor_inicial, uint32_t quantidade);
-    bool escreverSetores(const uint8_t *origem, uint32_t setor_inicial, uint32_t quantidade);
-    uint64_t obterQuantidadeSetores() const;
+    bool iniciar() override;
+    bool estaInicializado() const override;
+    bool lerSetores(uint8_t *destino, uint32_t setor_inicial, uint32_t quantidade) override;
+    bool escreverSetores(const uint8_t *origem, uint32_t setor_inicial, uint32_t quantidade) override;
+    bool apagarSetores(uint32_t setor_inicial, uint32_t setor_final) override;
+    bool sincronizar() override;
+    void definirEscritaAdiada(bool habilitar);
+    void definirVerificacaoCrc(bool habilitar);
+    bool estaComVerificacaoCrc() const;
+    uint32_t obterErrosCrc() const;
+    void definirEstrategiaEspera(EstrategiaEspera estrategia);
+    EstrategiaEspera obterEstrategiaEspera() const;
+    EstatisticasEspera obterEstatisticasEspera() const;
+    void zerarEstatisticasEspera();
+#ifdef HABILITAR_HISTOGRAMAS_CARTAO_SD
+    const HistogramasComandos &obterHistogramas() const;
+    void zerarHistogramas();
+#endif
+    uint64_t obterQuantidadeSetores() const override;
+    uint32_t obterSetoresUnidadeAlocacao() const override;
+    InformacoesCartao obterInformacoes() const;
+    uint32_t obterFrequenciaOperacao() const;
+    MotivoFrequencia obterMotivoFrequencia() const;
+    bool estaEmAltaVelocidade() const;
 
 private:
     ControladorSpiCartao &controlador;
     bool cartaoInicializado;
     bool cartaoAltaCapacidade;
+    bool escritaAdiada;
+    bool programacaoPendente;
+    bool escritaNaoConfirmada;
+    EstrategiaEspera estrategiaEspera;
+    EstatisticasEspera estatisticasEspera;
+    uint32_t latenciaTokenUs;
     uint64_t quantidadeSetores;
+    bool modoAltaVelocidade;
+    MotivoFrequencia motivoFrequencia;
+    uint16_t ultimoCrcDados;
+    bool verificacaoCrcSolicitada;
+    bool verificacaoCrcAtiva;
+    bool ultimaFalhaCrc;
+    uint32_t errosCrc;
+    uint32_t setoresUnidadeAlocacao;
+    InformacoesCartao informacoes;
+#ifdef HABILITAR_HISTOGRAMAS_CARTAO_SD
+    HistogramasComandos histogramas;
+    TipoComando tipoComandoAtual;
+    uint8_t ultimoComandoEnviado;
+#endif
 
     bool enviarComando(uint8_t comando, uint32_t argumento, uint8_t *resposta, size_t tamanho_resposta);
     bool enviarComandoAplicativo(uint8_t comando, uint32_t argumento, uint8_t *resposta, size_t tamanho_resposta);
     bool aguardarPronto(uint32_t tempo_limite_ms);
+    bool aguardarProntoPorVarredura(absolute_time_t tempo_limite, uint32_t &bytes_amostrados);
+    bool aguardarProntoPorEvento(absolute_time_t tempo_limite, uint32_t &bytes_amostrados);
+    bool concluirProgramacao();
     bool aguardarToken(uint8_t token, uint32_t tempo_limite_ms, uint8_t &valor_recebido);
+    bool aguardarTokenPorVarredura(uint8_t token, absolute_time_t tempo_limite, uint8_t &valor_recebido, uint32_t &bytes_amostrados);
+    bool aguardarTokenPorEvento(uint8_t token, absolute_time_t tempo_limite, uint8_t &valor_recebido, uint32_t &bytes_amostrados);
+    void registrarEspera(uint64_t inicio_us, uint32_t bytes_amostrados);
+    bool receberBlocoDados(uint8_t *destino, size_t tamanho);
     bool lerBloco(uint8_t *destino, uint32_t setor);
+    bool lerBlocosMultiplos(uint8_t *destino, uint32_t setor_inicial, uint32_t quantidade, uint32_t &blocos_lidos);
+    bool encerrarTransmissao();
+    bool enviarBlocoDados(uint8_t token, const uint8_t *origem);
     bool escreverBloco(const uint8_t *origem, uint32_t setor);
-    bool atualizarQuantidadeSetores();
-    bool lerCsd(uint8_t *dados_csd, size_t tamanho_csd);
+    bool tentarEscreverBloco(const uint8_t *origem, uint32_t setor);
+    bool escreverBlocosMultiplos(const uint8_t *origem, uint32_t setor_inicial, uint32_t quantidade);
+    bool obterBlocosGravados(uint32_t &blocos_gravados);
+    bool lerStatusSd(uint8_t *status, size_t tamanho_status);
+    void atualizarUnidadeAlocacao();
+    bool enviarComandoSwitch(uint32_t argumento, uint8_t *status, size_t tamanho_status);
+    bool negociarAltaVelocidade();
+    void ajustarFrequenciaMaxima();
+    bool verificarLeituraTeste(const uint8_t *referencia);
+    void ressincronizarTransmissao();
+    bool atualizarRegistros();
+    bool lerRegistro(uint8_t comando, uint8_t *dados, size_t tamanho);
     uint32_t ajustarArgumentoSetor(uint32_t setor) const;
 };
 
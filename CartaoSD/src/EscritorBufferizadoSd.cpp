@@ -0,0 +1,195 @@
+#include "EscritorBufferizadoSd.h"
+
+#include <string.h>
+
+namespace {
+constexpr size_t TAMANHO_SETOR_ESCRITOR = FF_MIN_SS;
+// 20 dígitos de um uint64_t, sinal e ponto decimal.
+constexpr size_t TAMANHO_NUMERO_ESCRITOR = 24u;
+constexpr uint32_t POTENCIAS_DEZ[] = {
+    1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u
+};
+
+static_assert(ESCRITOR_SD_CASAS_MAXIMAS < sizeof(POTENCIAS_DEZ) / sizeof(POTENCIAS_DEZ[0]),
+              "ESCRITOR_SD_CASAS_MAXIMAS acima da tabela de potencias de dez");
+
+// Escreve os dígitos de trás para frente, terminando em fim, com pelo menos
+// digitos_minimos (zeros à esquerda). O M0+ não divide por hardware e a divisão
+// de 64 bits custa bem mais que a de 32 (feita pelo divisor do SIO), por isso
+// só os valores acima de 32 bits passam pelo primeiro laço.
+char* converterDigitos(uint64_t valor, char* fim, uint8_t digitos_minimos) {
+    char* cursor = fim;
+    uint8_t digitos = 0u;
+    while (valor > UINT32_MAX) {
+        cursor = cursor - 1;
+        *cursor = static_cast<char>('0' + static_cast<uint32_t>(valor % 10u));
+        valor = valor / 10u;
+        digitos = digitos + 1u;
+    }
+    uint32_t valor_curto = static_cast<uint32_t>(valor);
+    do {
+        cursor = cursor - 1;
+        *cursor = static_cast<char>('0' + (valor_curto % 10u));
+        valor_curto = valor_curto / 10u;
+        digitos = digitos + 1u;
+    } while (valor_curto != 0u || digitos < digitos_minimos);
+    return cursor;
+}
+
+uint64_t magnitude(int64_t valor) {
+    // Sem negar o int64_t: INT64_MIN não tem oposto positivo.
+    return valor < 0 ? (0u - static_cast<uint64_t>(valor)) : static_cast<uint64_t>(valor);
+}
+}
+
+EscritorBufferizadoSd::EscritorBufferizadoSd(ArquivoSd &arquivo_destino, char* buffer_escrita, size_t capacidade_buffer)
+    : arquivo(arquivo_destino),
+      buffer(buffer_escrita),
+      capacidade(buffer_escrita != nullptr ? capacidade_buffer : 0u),
+      ocupado(0u),
+      erroEscrita(false),
+      estatisticas{} {
+}
+
+EscritorBufferizadoSd::~EscritorBufferizadoSd() {
+    descarregar();
+}
+
+bool EscritorBufferizadoSd::escreverTexto(std::string_view texto) {
+    return acrescentar(texto.data(), texto.size());
+}
+
+bool EscritorBufferizadoSd::escreverCaractere(char caractere) {
+    if (ocupado < capacidade && !erroEscrita) {
+        buffer[ocupado] = caractere;
+        ocupado = ocupado + 1u;
+        return true;
+    }
+    return acrescentar(&caractere, 1u);
+}
+
+bool EscritorBufferizadoSd::escreverNatural(uint64_t valor) {
+    char numero[TAMANHO_NUMERO_ESCRITOR];
+    char* fim = numero + sizeof(numero);
+    char* inicio = converterDigitos(valor, fim, 1u);
+    return acrescentar(inicio, static_cast<size_t>(fim - inicio));
+}
+
+bool EscritorBufferizadoSd::escreverInteiro(int64_t valor) {
+    char numero[TAMANHO_NUMERO_ESCRITOR];
+    char* fim = numero + sizeof(numero);
+    char* inicio = converterDigitos(magnitude(valor), fim, 1u);
+    if (valor < 0) {
+        inicio = inicio - 1;
+        *inicio = '-';
+    }
+    return acrescentar(inicio, static_cast<size_t>(fim - inicio));
+}
+
+bool EscritorBufferizadoSd::escreverDecimal(int64_t valor_escalado, uint8_t casas) {
+    if (casas > ESCRITOR_SD_CASAS_MAXIMAS) {
+        return false;
+    }
+    if (casas == 0u) {
+        return escreverInteiro(valor_escalado);
+    }
+
+    char numero[TAMANHO_NUMERO_ESCRITOR];
+    char* fim = numero + sizeof(numero);
+    uint64_t valor = magnitude(valor_escalado);
+    uint32_t escala = POTENCIAS_DEZ[casas];
+    char* inicio = converterDigitos(valor % escala, fim, casas);
+    inicio = inicio - 1;
+    *inicio = '.';
+    inicio = converterDigitos(valor / escala, inicio, 1u);
+    if (valor_escalado < 0) {
+        inicio = inicio - 1;
+        *inicio = '-';
+    }
+    return acrescentar(inicio, static_cast<size_t>(fim - inicio));
+}
+
+bool EscritorBufferizadoSd::terminarLinha() {
+    return acrescentar("\r\n", 2u);
+}
+
+bool EscritorBufferizadoSd::descarregar() {
+    if (erroEscrita) {
+        return false;
+    }
+    if (ocupado == 0u) {
+        return true;
+    }
+    if (!gravar(ocupado)) {
+        return false;
+    }
+    ocupado = 0u;
+    return true;
+}
+
+size_t EscritorBufferizadoSd::pendentes() const {
+    return ocupado;
+}
+
+bool EscritorBufferizadoSd::falhou() const {
+    return erroEscrita;
+}
+
+EstatisticasEscritorBufferizado EscritorBufferizadoSd::obterEstatisticas() const {
+    return estatisticas;
+}
+
+bool EscritorBufferizadoSd::acrescentar(const char* dados, size_t tamanho) {
+    if (erroEscrita || capacidade == 0u) {
+        return false;
+    }
+    while (tamanho > 0u) {
+        if (ocupado == capacidade && !descarregarSetores()) {
+            return false;
+        }
+        size_t livre = capacidade - ocupado;
+        size_t copiar = tamanho < livre ? tamanho : livre;
+        memcpy(buffer + ocupado, dados, copiar);
+        ocupado = ocupado + copiar;
+        dados = dados + copiar;
+        tamanho = tamanho - copiar;
+    }
+    return true;
+}
+
+// Buffer cheio: grava a maior parte dele que termina em fronteira de setor do
+// arquivo e move o resto para o início. Só no primeiro trecho de um arquivo
+// desalinhado (ou com buffer menor que um setor) a descarga não é alinhada.
+bool EscritorBufferizadoSd::descarregarSetores() {
+    long posicao_arquivo = arquivo.posicao();
+    size_t deslocamento = posicao_arquivo > 0 ? static_cast<size_t>(posicao_arquivo) % TAMANHO_SETOR_ESCRITOR : 0u;
+    size_t trecho = ocupado;
+    if (deslocamento + ocupado >= TAMANHO_SETOR_ESCRITOR) {
+        trecho = (((deslocamento + ocupado) / TAMANHO_SETOR_ESCRITOR) * TAMANHO_SETOR_ESCRITOR) - deslocamento;
+    }
+    if (!gravar(trecho)) {
+        return false;
+    }
+    ocupado = ocupado - trecho;
+    if (ocupado > 0u) {
+        memmove(buffer, buffer + trecho, ocupado);
+    }
+    return true;
+}
+
+bool EscritorBufferizadoSd::gravar(size_t tamanho) {
+    long posicao_arquivo = arquivo.posicao();
+    size_t escritos = arquivo.escreverBytes(reinterpret_cast<const uint8_t*>(buffer), tamanho);
+    if (escritos != tamanho) {
+        erroEscrita = true;
+        return false;
+    }
+    estatisticas.bytes = estatisticas.bytes + tamanho;
+    estatisticas.descargas = estatisticas.descargas + 1u;
+    if (posicao_arquivo >= 0 &&
+        static_cast<size_t>(posicao_arquivo) % TAMANHO_SETOR_ESCRITOR == 0u &&
+        tamanho % TAMANHO_SETOR_ESCRITOR == 0u) {
+        estatisticas.descargas_alinhadas = estatisticas.descargas_alinhadas + 1u;
+    }
+    return true;
+}
@@ -0,0 +1,60 @@
+#ifndef ESCRITORBUFFERIZADOSD_H
+#define ESCRITORBUFFERIZADOSD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string_view>
+
+#include "CartaoSD.h"
+
+#ifndef ESCRITOR_SD_CASAS_MAXIMAS
+#define ESCRITOR_SD_CASAS_MAXIMAS 9u
+#endif
+
+struct EstatisticasEscritorBufferizado {
+    uint64_t bytes;
+    uint32_t descargas;
+    uint32_t descargas_alinhadas;
+};
+
+// Monta texto e números no buffer informado e só chama escreverBytes quando
+// ele enche. Cada descarga por buffer cheio termina em fronteira de setor do
+// arquivo (o resto volta para o início do buffer), de modo que o f_write grava
+// setores inteiros direto no cartão em vez de passar pelo buffer do FIL. Os
+// números são convertidos só com inteiros, sem printf nem ponto flutuante:
+// escreverDecimal recebe o valor já escalado (1234 com 2 casas vira "12.34").
+// O destrutor descarrega o que ficou pendente; depois de uma falha de escrita
+// as chamadas seguintes devolvem false.
+class EscritorBufferizadoSd {
+public:
+    EscritorBufferizadoSd(ArquivoSd &arquivo_destino, char* buffer_escrita, size_t capacidade_buffer);
+    ~EscritorBufferizadoSd();
+    EscritorBufferizadoSd(const EscritorBufferizadoSd &) = delete;
+    EscritorBufferizadoSd &operator=(const EscritorBufferizadoSd &) = delete;
+
+    bool escreverTexto(std::string_view texto);
+    bool escreverCaractere(char caractere);
+    bool escreverNatural(uint64_t valor);
+    bool escreverInteiro(int64_t valor);
+    bool escreverDecimal(int64_t valor_escalado, uint8_t casas);
+    bool terminarLinha();
+    bool descarregar();
+    size_t pendentes() const;
+    bool falhou() const;
+    EstatisticasEscritorBufferizado obterEstatisticas() const;
+
+private:
+    ArquivoSd &arquivo;
+    char* buffer;
+    size_t capacidade;
+    size_t ocupado;
+    bool erroEscrita;
+    EstatisticasEscritorBufferizado estatisticas;
+
+    bool acrescentar(const char* dados, size_t tamanho);
+    bool descarregarSetores();
+    bool gravar(size_t tamanho);
+};
+
+#endif
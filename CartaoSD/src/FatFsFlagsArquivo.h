@@ -0,0 +1,13 @@
+#ifndef FATFSFLAGSARQUIVO_H
+#define FATFSFLAGSARQUIVO_H
+
+/* Bits de FIL.flag que o ff.c define só para uso interno (FA_MODIFIED e
+ * FA_DIRTY). A escrita direta de ArquivoSd grava setores por fora do f_write
+ * e marca o arquivo como o próprio f_write marcaria. O ff.c inclui este
+ * cabeçalho logo depois das suas definições e confere os valores com
+ * _Static_assert: uma versão do FatFs que os mude deixa de compilar. Ao
+ * trocar o ff.c, reaplique esse trecho. */
+#define CARTAO_SD_FA_MODIFIED 0x40
+#define CARTAO_SD_FA_DIRTY 0x80
+
+#endif
@@ -1,19 +1,40 @@
 #include "FatFsPort.h"
 
+#include "pico/mutex.h"
+
 extern "C" {
 #include "ff.h"
 #include "diskio.h"
 }
 
 namespace {
-cartao_sd::DriverCartaoSd *driverRegistrado = nullptr;
+auto_init_mutex(mutexDispositivo);
+cartao_sd::DispositivoBloco *dispositivoRegistrado = nullptr;
+bool descarteHabilitado = false;
 constexpr BYTE UNIDADE_UNICA = 0;
+constexpr uint32_t TAMANHO_BLOCO_MAXIMO_FATFS = 32768u;
 }
 
 namespace cartao_sd {
 
-void registrarDriverFatFs(DriverCartaoSd *driver) {
-    driverRegistrado = driver;
+void registrarDispositivoFatFs(DispositivoBloco *dispositivo) {
+    dispositivoRegistrado = dispositivo;
+}
+
+void definirDescarteFatFs(bool habilitar) {
+    descarteHabilitado = habilitar;
+}
+
+bool descarteFatFsHabilitado() {
+    return descarteHabilitado;
+}
+
+void travarDispositivoFatFs() {
+    mutex_enter_blocking(&mutexDispositivo);
+}
+
+void liberarDispositivoFatFs() {
+    mutex_exit(&mutexDispositivo);
 }
 
 } // namespace cartao_sd
@@ -25,11 +46,11 @@ DSTATUS disk_status(BYTE unidade) {
         return STA_NOINIT;
     }
 
-    if (driverRegistrado == nullptr) {
+    if (dispositivoRegistrado == nullptr) {
         return STA_NOINIT;
     }
 
-    return driverRegistrado->estaInicializado() ? 0 : STA_NOINIT;
+    return dispositivoRegistrado->estaInicializado() ? 0 : STA_NOINIT;
 }
 
 DSTATUS disk_initialize(BYTE unidade) {
@@ -37,16 +58,18 @@ DSTATUS disk_initialize(BYTE unidade) {
         return STA_NOINIT;
     }
 
-    if (driverRegistrado == nullptr) {
+    if (dispositivoRegistrado == nullptr) {
         return STA_NOINIT;
     }
 
-    bool iniciou = driverRegistrado->iniciar();
+    cartao_sd::travarDispositivoFatFs();
+    bool iniciou = dispositivoRegistrado->iniciar();
+    cartao_sd::liberarDispositivoFatFs();
     return iniciou ? 0 : STA_NOINIT;
 }
 
 DRESULT disk_read(BYTE unidade, BYTE *buffer, LBA_t setor, UINT quantidade) {
-    if (unidade != UNIDADE_UNICA || driverRegistrado == nullptr) {
+    if (unidade != UNIDADE_UNICA || dispositivoRegistrado == nullptr) {
         return RES_PARERR;
     }
 
@@ -54,13 +77,15 @@ DRESULT disk_read(BYTE unidade, BYTE *buffer, LBA_t setor, UINT quantidade) {
         return RES_PARERR;
     }
 
-    bool leu = driverRegistrado->lerSetores(buffer, static_cast<uint32_t>(setor), quantidade);
+    cartao_sd::travarDispositivoFatFs();
+    bool leu = dispositivoRegistrado->lerSetores(buffer, static_cast<uint32_t>(setor), quantidade);
+    cartao_sd::liberarDispositivoFatFs();
     return leu ? RES_OK : RES_ERROR;
 }
 
 #if FF_FS_READONLY == 0
 DRESULT disk_write(BYTE unidade, const BYTE *buffer, LBA_t setor, UINT quantidade) {
-    if (unidade != UNIDADE_UNICA || driverRegistrado == nullptr) {
+    if (unidade != UNIDADE_UNICA || dispositivoRegistrado == nullptr) {
         return RES_PARERR;
     }
 
@@ -68,38 +93,70 @@ DRESULT disk_write(BYTE unidade, const BYTE *buffer, LBA_t setor, UINT quantidad
         return RES_PARERR;
     }
 
-    bool escreveu = driverRegistrado->escreverSetores(buffer, static_cast<uint32_t>(setor), quantidade);
+    cartao_sd::travarDispositivoFatFs();
+    bool escreveu = dispositivoRegistrado->escreverSetores(buffer, static_cast<uint32_t>(setor), quantidade);
+    cartao_sd::liberarDispositivoFatFs();
     return escreveu ? RES_OK : RES_ERROR;
 }
 #endif
 
 DRESULT disk_ioctl(BYTE unidade, BYTE comando, void *buffer) {
-    if (unidade != UNIDADE_UNICA || driverRegistrado == nullptr) {
+    if (unidade != UNIDADE_UNICA || dispositivoRegistrado == nullptr) {
         return RES_PARERR;
     }
 
     switch (comando) {
-        case CTRL_SYNC:
-            return RES_OK;
+        case CTRL_SYNC: {
+            cartao_sd::travarDispositivoFatFs();
+            bool sincronizou = dispositivoRegistrado->sincronizar();
+            cartao_sd::liberarDispositivoFatFs();
+            return sincronizou ? RES_OK : RES_ERROR;
+        }
         case GET_BLOCK_SIZE: {
             if (buffer == nullptr) {
                 return RES_PARERR;
             }
+            // O f_mkfs só aceita potências de dois até 32768 setores; AUs
+            // irregulares (12/24 MB) usam a maior potência de dois que as divide.
+            uint32_t setores_au = dispositivoRegistrado->obterSetoresUnidadeAlocacao();
+            uint32_t bloco = setores_au & (~setores_au + 1u);
+            if (bloco == 0u) {
+                bloco = 1u;
+            }
+            if (bloco > TAMANHO_BLOCO_MAXIMO_FATFS) {
+                bloco = TAMANHO_BLOCO_MAXIMO_FATFS;
+            }
             DWORD *destino = reinterpret_cast<DWORD *>(buffer);
-            *destino = 1u;
+            *destino = bloco;
             return RES_OK;
         }
         case GET_SECTOR_COUNT: {
             if (buffer == nullptr) {
                 return RES_PARERR;
             }
-            uint64_t setores = driverRegistrado->obterQuantidadeSetores();
+            uint64_t setores = dispositivoRegistrado->obterQuantidadeSetores();
             if (setores == 0u) {
                 return RES_ERROR;
             }
             *reinterpret_cast<LBA_t *>(buffer) = static_cast<LBA_t>(setores);
             return RES_OK;
         }
+#if FF_USE_TRIM
+        case CTRL_TRIM: {
+            if (buffer == nullptr) {
+                return RES_PARERR;
+            }
+            // O descarte é só uma dica ao cartão; desligado, o pedido é ignorado.
+            if (!descarteHabilitado) {
+                return RES_OK;
+            }
+            const LBA_t *intervalo = reinterpret_cast<const LBA_t *>(buffer);
+            cartao_sd::travarDispositivoFatFs();
+            bool apagou = dispositivoRegistrado->apagarSetores(static_cast<uint32_t>(intervalo[0]), static_cast<uint32_t>(intervalo[1]));
+            cartao_sd::liberarDispositivoFatFs();
+            return apagou ? RES_OK : RES_ERROR;
+        }
+#endif
         default:
             return RES_PARERR;
     }
@@ -1,11 +1,19 @@
 #ifndef FATFSPORT_H
 #define FATFSPORT_H
 
-#include "DriverCartaoSd.h"
+#include "DispositivoBloco.h"
 
 namespace cartao_sd {
 
-void registrarDriverFatFs(DriverCartaoSd *driver);
+void registrarDispositivoFatFs(DispositivoBloco *dispositivo);
+void definirDescarteFatFs(bool habilitar);
+bool descarteFatFsHabilitado();
+
+// Trava da pilha de blocos registrada. Cada disk_* a toma; quem chama o
+// dispositivo por fora do FatFs (descargas por prazo, troca de política)
+// deve tomá-la também, para não cruzar com o outro núcleo.
+void travarDispositivoFatFs();
+void liberarDispositivoFatFs();
 
 } // namespace cartao_sd
 
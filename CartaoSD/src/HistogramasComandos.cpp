@@ -0,0 +1,106 @@
+#include "HistogramasComandos.h"
+
+#include <string.h>
+
+namespace cartao_sd {
+
+namespace {
+
+size_t calcularFaixa(uint32_t duracao_us) {
+    size_t faixa = 0u;
+    while (duracao_us > 1u && faixa + 1u < QUANTIDADE_FAIXAS_HISTOGRAMA) {
+        duracao_us = duracao_us >> 1u;
+        faixa = faixa + 1u;
+    }
+    return faixa;
+}
+
+} // namespace
+
+HistogramasComandos::HistogramasComandos() {
+    zerar();
+}
+
+void HistogramasComandos::registrar(TipoComando tipo, FaseComando fase, uint32_t duracao_us) {
+    HistogramaLatencia &histograma = histogramas[static_cast<size_t>(tipo)][static_cast<size_t>(fase)];
+    size_t faixa = calcularFaixa(duracao_us);
+
+    histograma.faixas[faixa] = histograma.faixas[faixa] + 1u;
+    histograma.amostras = histograma.amostras + 1u;
+    if (duracao_us > histograma.maximo_us) {
+        histograma.maximo_us = duracao_us;
+    }
+}
+
+const HistogramaLatencia &HistogramasComandos::obter(TipoComando tipo, FaseComando fase) const {
+    return histogramas[static_cast<size_t>(tipo)][static_cast<size_t>(fase)];
+}
+
+void HistogramasComandos::zerar() {
+    memset(histogramas, 0, sizeof(histogramas));
+}
+
+uint32_t HistogramasComandos::limiteSuperiorFaixaUs(size_t faixa) {
+    return 1u << (faixa + 1u);
+}
+
+TipoComando classificarComando(uint8_t comando, bool aplicativo) {
+    if (aplicativo || comando == 55u) {
+        return TipoComando::Aplicativo;
+    }
+
+    switch (comando) {
+        case 17u:
+            return TipoComando::Leitura;
+        case 18u:
+            return TipoComando::LeituraMultipla;
+        case 24u:
+            return TipoComando::Escrita;
+        case 25u:
+            return TipoComando::EscritaMultipla;
+        case 12u:
+            return TipoComando::Parada;
+        case 32u:
+        case 33u:
+        case 38u:
+            return TipoComando::Apagamento;
+        default:
+            return TipoComando::Outros;
+    }
+}
+
+const char *descreverTipoComando(TipoComando tipo) {
+    switch (tipo) {
+        case TipoComando::Leitura:
+            return "CMD17";
+        case TipoComando::LeituraMultipla:
+            return "CMD18";
+        case TipoComando::Escrita:
+            return "CMD24";
+        case TipoComando::EscritaMultipla:
+            return "CMD25";
+        case TipoComando::Parada:
+            return "CMD12";
+        case TipoComando::Apagamento:
+            return "CMD32/33/38";
+        case TipoComando::Aplicativo:
+            return "CMD55/ACMD";
+        case TipoComando::Outros:
+            break;
+    }
+    return "outros";
+}
+
+const char *descreverFaseComando(FaseComando fase) {
+    switch (fase) {
+        case FaseComando::Resposta:
+            return "resposta";
+        case FaseComando::Token:
+            return "token";
+        case FaseComando::Ocupado:
+            return "ocupado";
+    }
+    return "?";
+}
+
+} // namespace cartao_sd
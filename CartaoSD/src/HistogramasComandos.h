@@ -0,0 +1,61 @@
+#ifndef HISTOGRAMASCOMANDOS_H
+#define HISTOGRAMASCOMANDOS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace cartao_sd {
+
+// Fase de um comando em que o driver espera pelo cartão.
+enum class FaseComando : uint8_t {
+    Resposta,   // bytes até a R1
+    Token,      // token de dados de uma leitura
+    Ocupado     // MISO em nível baixo após escrita, apagamento ou CMD12
+};
+
+enum class TipoComando : uint8_t {
+    Leitura,
+    LeituraMultipla,
+    Escrita,
+    EscritaMultipla,
+    Parada,
+    Apagamento,
+    Aplicativo,
+    Outros
+};
+
+constexpr size_t QUANTIDADE_FASES_COMANDO = 3u;
+constexpr size_t QUANTIDADE_TIPOS_COMANDO = 8u;
+constexpr size_t QUANTIDADE_FAIXAS_HISTOGRAMA = 20u;
+
+// Faixa i conta durações em [2^i, 2^(i+1)) us (a faixa 0 inclui 0 us); a
+// última acumula tudo a partir de 2^19 us (~524 ms).
+struct HistogramaLatencia {
+    uint32_t faixas[QUANTIDADE_FAIXAS_HISTOGRAMA];
+    uint32_t amostras;
+    uint32_t maximo_us;
+};
+
+// Histogramas em escala logarítmica por tipo de comando e fase, com memória
+// fixa; o DriverCartaoSd só os alimenta com HABILITAR_HISTOGRAMAS_CARTAO_SD.
+class HistogramasComandos {
+public:
+    HistogramasComandos();
+
+    void registrar(TipoComando tipo, FaseComando fase, uint32_t duracao_us);
+    const HistogramaLatencia &obter(TipoComando tipo, FaseComando fase) const;
+    void zerar();
+
+    static uint32_t limiteSuperiorFaixaUs(size_t faixa);
+
+private:
+    HistogramaLatencia histogramas[QUANTIDADE_TIPOS_COMANDO][QUANTIDADE_FASES_COMANDO];
+};
+
+TipoComando classificarComando(uint8_t comando, bool aplicativo);
+const char *descreverTipoComando(TipoComando tipo);
+const char *descreverFaseComando(FaseComando fase);
+
+} // namespace cartao_sd
+
+#endif
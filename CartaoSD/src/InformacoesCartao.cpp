@@ -0,0 +1,132 @@
+#include "InformacoesCartao.h"
+
+namespace cartao_sd {
+
+namespace {
+
+// Os registros vêm do cartão com o bit mais significativo primeiro; as
+// posições seguem a numeração da especificação (bit 0 é o último do registro).
+uint32_t extrairBits(const uint8_t *registro, size_t tamanho_bytes, uint32_t bit_alto, uint32_t bit_baixo) {
+    uint32_t valor = 0u;
+    for (uint32_t bit = bit_alto + 1u; bit > bit_baixo; bit = bit - 1u) {
+        uint32_t posicao = bit - 1u;
+        size_t indice_byte = tamanho_bytes - 1u - (posicao / 8u);
+        uint32_t deslocamento = posicao % 8u;
+        valor = (valor << 1u) | ((registro[indice_byte] >> deslocamento) & 0x01u);
+    }
+    return valor;
+}
+
+uint32_t bitsCid(const uint8_t *registro, uint32_t bit_alto, uint32_t bit_baixo) {
+    return extrairBits(registro, TAMANHO_REGISTRO_CID, bit_alto, bit_baixo);
+}
+
+uint32_t bitsCsd(const uint8_t *registro, uint32_t bit_alto, uint32_t bit_baixo) {
+    return extrairBits(registro, TAMANHO_REGISTRO_CSD, bit_alto, bit_baixo);
+}
+
+uint32_t bitsStatus(const uint8_t *registro, uint32_t bit_alto, uint32_t bit_baixo) {
+    return extrairBits(registro, TAMANHO_STATUS_SD, bit_alto, bit_baixo);
+}
+
+uint32_t converterTamanhoAu(uint32_t codigo) {
+    // 16 KB a 4 MB dobram a cada passo; de 0xA em diante a tabela é irregular.
+    static constexpr uint32_t SETORES_POR_AU[16] = {
+        0u, 32u, 64u, 128u, 256u, 512u, 1024u, 2048u,
+        4096u, 8192u, 16384u, 24576u, 32768u, 49152u, 65536u, 131072u
+    };
+    return SETORES_POR_AU[codigo & 0x0Fu];
+}
+
+uint8_t converterClasseVelocidade(uint32_t codigo) {
+    static constexpr uint8_t CLASSES[5] = {0u, 2u, 4u, 6u, 10u};
+    return codigo < 5u ? CLASSES[codigo] : 0u;
+}
+
+} // namespace
+
+void interpretarCid(const uint8_t *registro, IdentificacaoCartao &destino) {
+    destino = IdentificacaoCartao{};
+    destino.fabricante = static_cast<uint8_t>(bitsCid(registro, 127u, 120u));
+    destino.aplicacao[0] = static_cast<char>(registro[1]);
+    destino.aplicacao[1] = static_cast<char>(registro[2]);
+    for (size_t indice = 0; indice < 5u; indice = indice + 1) {
+        destino.produto[indice] = static_cast<char>(registro[3u + indice]);
+    }
+    destino.revisao_maior = static_cast<uint8_t>(bitsCid(registro, 63u, 60u));
+    destino.revisao_menor = static_cast<uint8_t>(bitsCid(registro, 59u, 56u));
+    destino.numero_serie = bitsCid(registro, 55u, 24u);
+    destino.ano_fabricacao = static_cast<uint16_t>(2000u + bitsCid(registro, 19u, 12u));
+    destino.mes_fabricacao = static_cast<uint8_t>(bitsCid(registro, 11u, 8u));
+}
+
+void interpretarCsd(const uint8_t *registro, RegistroCsd &destino) {
+    destino = RegistroCsd{};
+    destino.versao = static_cast<uint8_t>(bitsCsd(registro, 127u, 126u));
+    destino.taac = static_cast<uint8_t>(bitsCsd(registro, 119u, 112u));
+    destino.nsac = static_cast<uint8_t>(bitsCsd(registro, 111u, 104u));
+    destino.velocidade_transferencia = static_cast<uint8_t>(bitsCsd(registro, 103u, 96u));
+    destino.classes_comando = static_cast<uint16_t>(bitsCsd(registro, 95u, 84u));
+    destino.log2_bloco_leitura = static_cast<uint8_t>(bitsCsd(registro, 83u, 80u));
+    destino.leitura_parcial = bitsCsd(registro, 79u, 79u) != 0u;
+    destino.escrita_desalinhada = bitsCsd(registro, 78u, 78u) != 0u;
+    destino.leitura_desalinhada = bitsCsd(registro, 77u, 77u) != 0u;
+    destino.dsr_implementado = bitsCsd(registro, 76u, 76u) != 0u;
+    destino.apagamento_por_bloco = bitsCsd(registro, 46u, 46u) != 0u;
+    destino.setores_apagamento = static_cast<uint8_t>(bitsCsd(registro, 45u, 39u) + 1u);
+    destino.grupo_protecao = static_cast<uint8_t>(bitsCsd(registro, 38u, 32u) + 1u);
+    destino.protecao_por_grupo = bitsCsd(registro, 31u, 31u) != 0u;
+    destino.fator_escrita = static_cast<uint8_t>(bitsCsd(registro, 28u, 26u));
+    destino.log2_bloco_escrita = static_cast<uint8_t>(bitsCsd(registro, 25u, 22u));
+    destino.escrita_parcial = bitsCsd(registro, 21u, 21u) != 0u;
+    destino.copia = bitsCsd(registro, 14u, 14u) != 0u;
+    destino.protecao_permanente = bitsCsd(registro, 13u, 13u) != 0u;
+    destino.protecao_temporaria = bitsCsd(registro, 12u, 12u) != 0u;
+    destino.formato_arquivo = static_cast<uint8_t>(bitsCsd(registro, 11u, 10u));
+
+    if (destino.versao == 0u) {
+        destino.c_size = bitsCsd(registro, 73u, 62u);
+        destino.c_size_mult = static_cast<uint8_t>(bitsCsd(registro, 49u, 47u));
+        uint64_t capacidade = (static_cast<uint64_t>(destino.c_size) + 1u) *
+                              (1u << (destino.c_size_mult + 2u)) *
+                              (1u << destino.log2_bloco_leitura);
+        destino.quantidade_setores = capacidade / 512u;
+        return;
+    }
+
+    // CSD 2.0 (SDHC/SDXC) usa 22 bits de C_SIZE; o 3.0 (SDUC) estende para 28.
+    destino.c_size = destino.versao == 1u ? bitsCsd(registro, 69u, 48u) : bitsCsd(registro, 75u, 48u);
+    destino.quantidade_setores = (static_cast<uint64_t>(destino.c_size) + 1u) * 1024u;
+}
+
+void interpretarStatusSd(const uint8_t *registro, StatusSd &destino) {
+    destino = StatusSd{};
+    destino.largura_barramento = static_cast<uint8_t>(bitsStatus(registro, 511u, 510u));
+    destino.modo_seguro = bitsStatus(registro, 509u, 509u) != 0u;
+    destino.tipo_cartao = static_cast<uint16_t>(bitsStatus(registro, 495u, 480u));
+    destino.area_protegida_bytes = bitsStatus(registro, 479u, 448u);
+    destino.classe_velocidade = converterClasseVelocidade(bitsStatus(registro, 447u, 440u));
+    destino.desempenho_movimento_mbs = static_cast<uint8_t>(bitsStatus(registro, 439u, 432u));
+    destino.setores_unidade_alocacao = converterTamanhoAu(bitsStatus(registro, 431u, 428u));
+    destino.unidades_apagamento = static_cast<uint16_t>(bitsStatus(registro, 423u, 408u));
+    destino.tempo_apagamento_s = static_cast<uint8_t>(bitsStatus(registro, 407u, 402u));
+    destino.deslocamento_apagamento_s = static_cast<uint8_t>(bitsStatus(registro, 401u, 400u));
+    destino.classe_uhs = static_cast<uint8_t>(bitsStatus(registro, 399u, 396u));
+    destino.setores_unidade_alocacao_uhs = converterTamanhoAu(bitsStatus(registro, 395u, 392u));
+    destino.classe_video = static_cast<uint8_t>(bitsStatus(registro, 391u, 384u));
+    destino.classe_aplicacao = static_cast<uint8_t>(bitsStatus(registro, 339u, 336u));
+}
+
+uint32_t estimarTempoApagamentoMs(const StatusSd &status, uint32_t setores) {
+    // Sem ERASE_SIZE/ERASE_TIMEOUT o cartão não informa estimativa.
+    if (status.unidades_apagamento == 0u || status.tempo_apagamento_s == 0u || status.setores_unidade_alocacao == 0u) {
+        return 0u;
+    }
+
+    uint64_t unidades = (static_cast<uint64_t>(setores) + status.setores_unidade_alocacao - 1u) / status.setores_unidade_alocacao;
+    uint64_t tempo_ms = (unidades * status.tempo_apagamento_s * 1000u) / status.unidades_apagamento;
+    tempo_ms = tempo_ms + (static_cast<uint64_t>(status.deslocamento_apagamento_s) * 1000u);
+    return tempo_ms > 0xFFFFFFFFu ? 0xFFFFFFFFu : static_cast<uint32_t>(tempo_ms);
+}
+
+} // namespace cartao_sd
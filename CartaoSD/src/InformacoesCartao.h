@@ -0,0 +1,87 @@
+#ifndef INFORMACOESCARTAO_H
+#define INFORMACOESCARTAO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace cartao_sd {
+
+constexpr size_t TAMANHO_REGISTRO_CID = 16u;
+constexpr size_t TAMANHO_REGISTRO_CSD = 16u;
+constexpr size_t TAMANHO_STATUS_SD = 64u;
+
+// CID: identificação do fabricante e do produto.
+struct IdentificacaoCartao {
+    uint8_t fabricante;
+    char aplicacao[3];
+    char produto[6];
+    uint8_t revisao_maior;
+    uint8_t revisao_menor;
+    uint32_t numero_serie;
+    uint16_t ano_fabricacao;
+    uint8_t mes_fabricacao;
+};
+
+// CSD completo; campos que só existem na versão 1.0 ficam zerados nas demais.
+struct RegistroCsd {
+    uint8_t versao;
+    uint8_t taac;
+    uint8_t nsac;
+    uint8_t velocidade_transferencia;
+    uint16_t classes_comando;
+    uint8_t log2_bloco_leitura;
+    bool leitura_parcial;
+    bool escrita_desalinhada;
+    bool leitura_desalinhada;
+    bool dsr_implementado;
+    uint32_t c_size;
+    uint8_t c_size_mult;
+    bool apagamento_por_bloco;
+    uint8_t setores_apagamento;
+    uint8_t grupo_protecao;
+    bool protecao_por_grupo;
+    uint8_t fator_escrita;
+    uint8_t log2_bloco_escrita;
+    bool escrita_parcial;
+    bool copia;
+    bool protecao_permanente;
+    bool protecao_temporaria;
+    uint8_t formato_arquivo;
+    uint64_t quantidade_setores;
+};
+
+// SD Status (ACMD13): unidade de alocação, classes de velocidade e tempos de apagamento.
+struct StatusSd {
+    uint8_t largura_barramento;
+    bool modo_seguro;
+    uint16_t tipo_cartao;
+    uint32_t area_protegida_bytes;
+    uint8_t classe_velocidade;
+    uint8_t desempenho_movimento_mbs;
+    uint32_t setores_unidade_alocacao;
+    uint16_t unidades_apagamento;
+    uint8_t tempo_apagamento_s;
+    uint8_t deslocamento_apagamento_s;
+    uint8_t classe_uhs;
+    uint32_t setores_unidade_alocacao_uhs;
+    uint8_t classe_video;
+    uint8_t classe_aplicacao;
+};
+
+struct InformacoesCartao {
+    bool cid_valido;
+    bool csd_valido;
+    bool status_valido;
+    IdentificacaoCartao cid;
+    RegistroCsd csd;
+    StatusSd status;
+};
+
+void interpretarCid(const uint8_t *registro, IdentificacaoCartao &destino);
+void interpretarCsd(const uint8_t *registro, RegistroCsd &destino);
+void interpretarStatusSd(const uint8_t *registro, StatusSd &destino);
+uint32_t estimarTempoApagamentoMs(const StatusSd &status, uint32_t setores);
+
+} // namespace cartao_sd
+
+#endif
@@ -0,0 +1,127 @@
+#include "LeitorLinhasSd.h"
+
+#include <string.h>
+
+LeitorLinhasSd::LeitorLinhasSd(ArquivoSd &arquivo_origem, char* buffer_leitura, size_t capacidade_buffer)
+    : arquivo(arquivo_origem),
+      buffer(buffer_leitura),
+      capacidade(buffer_leitura != nullptr ? capacidade_buffer : 0u),
+      inicio(0u),
+      fim(0u),
+      fimArquivo(false),
+      erroLeitura(false),
+      linhaPartida(false),
+      estatisticas{} {
+}
+
+bool LeitorLinhasSd::proximaLinha(std::string_view &linha) {
+    for (;;) {
+        // Terminador logo depois de um pedaço partido: fecha a linha dele.
+        if (linhaPartida && fim > inicio) {
+            linhaPartida = false;
+            size_t terminador = 0u;
+            if (buffer[inicio] == '\n') {
+                terminador = 1u;
+            } else if (buffer[inicio] == '\r' && fim - inicio > 1u && buffer[inicio + 1u] == '\n') {
+                terminador = 2u;
+            }
+            if (terminador > 0u) {
+                inicio = inicio + terminador;
+                estatisticas.linhas = estatisticas.linhas + 1u;
+            }
+        }
+
+        const char* quebra = nullptr;
+        if (fim > inicio) {
+            quebra = static_cast<const char*>(memchr(buffer + inicio, '\n', fim - inicio));
+        }
+
+        if (quebra != nullptr) {
+            size_t tamanho_linha = static_cast<size_t>(quebra - (buffer + inicio));
+            size_t proximo_inicio = inicio + tamanho_linha + 1u;
+            if (tamanho_linha > 0u && buffer[inicio + tamanho_linha - 1u] == '\r') {
+                tamanho_linha = tamanho_linha - 1u;
+            }
+            linha = std::string_view(buffer + inicio, tamanho_linha);
+            inicio = proximo_inicio;
+            estatisticas.linhas = estatisticas.linhas + 1u;
+            return true;
+        }
+
+        if (fimArquivo) {
+            if (inicio == fim) {
+                linha = std::string_view();
+                return false;
+            }
+            // Última linha sem terminador.
+            linha = std::string_view(buffer + inicio, fim - inicio);
+            inicio = fim;
+            estatisticas.linhas = estatisticas.linhas + 1u;
+            return true;
+        }
+
+        if (inicio == 0u && fim == capacidade) {
+            if (capacidade == 0u) {
+                return false;
+            }
+            // Um '\r' no fim do pedaço é a primeira metade de um "\r\n".
+            size_t tamanho_pedaco = fim;
+            if (buffer[tamanho_pedaco - 1u] == '\r') {
+                tamanho_pedaco = tamanho_pedaco - 1u;
+            }
+            linha = std::string_view(buffer, tamanho_pedaco);
+            inicio = fim;
+            linhaPartida = true;
+            estatisticas.linhas_partidas = estatisticas.linhas_partidas + 1u;
+            return true;
+        }
+
+        if (!carregarBloco()) {
+            linha = std::string_view();
+            return false;
+        }
+    }
+}
+
+// Traz o resto da linha atual para o início do buffer e completa o bloco com
+// um único f_read.
+bool LeitorLinhasSd::carregarBloco() {
+    size_t pendente = fim - inicio;
+    if (pendente > 0u && inicio > 0u) {
+        memmove(buffer, buffer + inicio, pendente);
+    }
+    inicio = 0u;
+    fim = pendente;
+
+    size_t lidos = arquivo.lerBytes(reinterpret_cast<uint8_t*>(buffer + fim), capacidade - fim);
+    if (lidos == 0u) {
+        if (arquivo.resultadoOperacao() != FR_OK) {
+            erroLeitura = true;
+            return false;
+        }
+        fimArquivo = true;
+        return true;
+    }
+    fim = fim + lidos;
+    estatisticas.leituras = estatisticas.leituras + 1u;
+    estatisticas.bytes = estatisticas.bytes + lidos;
+    return true;
+}
+
+bool LeitorLinhasSd::reiniciar() {
+    inicio = 0u;
+    fim = 0u;
+    fimArquivo = false;
+    erroLeitura = false;
+    linhaPartida = false;
+    estatisticas = EstatisticasLeitorLinhas{};
+    return arquivo.reiniciarPosicao();
+}
+
+bool LeitorLinhasSd::falhou() const {
+    return erroLeitura;
+}
+
+EstatisticasLeitorLinhas LeitorLinhasSd::obterEstatisticas() const {
+    return estatisticas;
+}
@@ -0,0 +1,48 @@
+#ifndef LEITORLINHASSD_H
+#define LEITORLINHASSD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string_view>
+
+#include "CartaoSD.h"
+
+struct EstatisticasLeitorLinhas {
+    uint32_t linhas;
+    uint64_t bytes;
+    uint32_t leituras;
+    uint32_t linhas_partidas;
+};
+
+// Lê o arquivo em blocos do tamanho do buffer informado e devolve cada linha
+// como std::string_view sobre esse buffer, sem o terminador ("\n" ou "\r\n")
+// e sem copiar. A vista vale até a próxima chamada. Uma linha que atravessa o
+// fim do bloco é movida para o início do buffer antes da leitura seguinte; uma
+// linha maior que o buffer inteiro sai em pedaços (linhas_partidas). Um
+// terminador logo depois de um pedaço, mesmo um "\r\n" dividido entre dois,
+// só fecha a linha e não vira uma linha vazia.
+class LeitorLinhasSd {
+public:
+    LeitorLinhasSd(ArquivoSd &arquivo_origem, char* buffer_leitura, size_t capacidade_buffer);
+
+    bool proximaLinha(std::string_view &linha);
+    bool reiniciar();
+    bool falhou() const;
+    EstatisticasLeitorLinhas obterEstatisticas() const;
+
+private:
+    ArquivoSd &arquivo;
+    char* buffer;
+    size_t capacidade;
+    size_t inicio;
+    size_t fim;
+    bool fimArquivo;
+    bool erroLeitura;
+    bool linhaPartida;
+    EstatisticasLeitorLinhas estatisticas;
+
+    bool carregarBloco();
+};
+
+#endif
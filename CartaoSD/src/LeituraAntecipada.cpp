@@ -0,0 +1,171 @@
+#include "LeituraAntecipada.h"
+
+#include <string.h>
+
+namespace cartao_sd {
+
+LeituraAntecipada::LeituraAntecipada(DispositivoBloco &dispositivo_inferior)
+    : dispositivoInferior(dispositivo_inferior),
+      habilitada(true),
+      estatisticas{},
+      proximoSetorEsperado(0u),
+      leiturasSequenciais(0u),
+      setorInicialBuffer(0u),
+      setoresNoBuffer(0u),
+      indiceBuffer(0u),
+      bufferIntermediario{} {
+}
+
+bool LeituraAntecipada::iniciar() {
+    descartarBuffer();
+    leiturasSequenciais = 0u;
+    return dispositivoInferior.iniciar();
+}
+
+bool LeituraAntecipada::estaInicializado() const {
+    return dispositivoInferior.estaInicializado();
+}
+
+bool LeituraAntecipada::lerSetores(uint8_t *destino, uint32_t setor_inicial, uint32_t quantidade) {
+    if (destino == nullptr) {
+        return false;
+    }
+
+    if (quantidade == 0u) {
+        return true;
+    }
+
+    if (!habilitada) {
+        return dispositivoInferior.lerSetores(destino, setor_inicial, quantidade);
+    }
+
+    if (setor_inicial == proximoSetorEsperado) {
+        leiturasSequenciais = leiturasSequenciais + 1u;
+    } else {
+        if (indiceBuffer < setoresNoBuffer) {
+            estatisticas.recuos = estatisticas.recuos + 1u;
+        }
+        leiturasSequenciais = 0u;
+        descartarBuffer();
+    }
+    proximoSetorEsperado = setor_inicial + quantidade;
+
+    uint32_t aproveitados = consumirBuffer(destino, setor_inicial, quantidade);
+    destino = destino + (aproveitados * TAMANHO_SETOR_DISPOSITIVO);
+    setor_inicial = setor_inicial + aproveitados;
+    quantidade = quantidade - aproveitados;
+
+    if (quantidade == 0u) {
+        return true;
+    }
+
+    // Pedidos longos já saem como um CMD18 completo; antecipar não ajuda.
+    if (leiturasSequenciais < LEITURAS_PARA_ANTECIPAR || quantidade >= SETORES_ANTECIPADOS) {
+        return dispositivoInferior.lerSetores(destino, setor_inicial, quantidade);
+    }
+
+    uint32_t setores_lidos = SETORES_ANTECIPADOS;
+    uint64_t total_setores = dispositivoInferior.obterQuantidadeSetores();
+    if (total_setores > 0u && static_cast<uint64_t>(setor_inicial) + setores_lidos > total_setores) {
+        setores_lidos = static_cast<uint32_t>(total_setores - setor_inicial);
+    }
+
+    if (setores_lidos <= quantidade) {
+        return dispositivoInferior.lerSetores(destino, setor_inicial, quantidade);
+    }
+
+    if (!dispositivoInferior.lerSetores(bufferIntermediario, setor_inicial, setores_lidos)) {
+        descartarBuffer();
+        return false;
+    }
+
+    estatisticas.antecipacoes = estatisticas.antecipacoes + 1u;
+    estatisticas.setores_antecipados = estatisticas.setores_antecipados + (setores_lidos - quantidade);
+
+    memcpy(destino, bufferIntermediario, quantidade * TAMANHO_SETOR_DISPOSITIVO);
+    setorInicialBuffer = setor_inicial;
+    setoresNoBuffer = setores_lidos;
+    indiceBuffer = quantidade;
+    return true;
+}
+
+bool LeituraAntecipada::escreverSetores(const uint8_t *origem, uint32_t setor_inicial, uint32_t quantidade) {
+    if (quantidade > 0u) {
+        invalidarIntervalo(setor_inicial, setor_inicial + quantidade - 1u);
+    }
+    return dispositivoInferior.escreverSetores(origem, setor_inicial, quantidade);
+}
+
+bool LeituraAntecipada::apagarSetores(uint32_t setor_inicial, uint32_t setor_final) {
+    invalidarIntervalo(setor_inicial, setor_final);
+    return dispositivoInferior.apagarSetores(setor_inicial, setor_final);
+}
+
+bool LeituraAntecipada::sincronizar() {
+    return dispositivoInferior.sincronizar();
+}
+
+uint64_t LeituraAntecipada::obterQuantidadeSetores() const {
+    return dispositivoInferior.obterQuantidadeSetores();
+}
+
+uint32_t LeituraAntecipada::obterSetoresUnidadeAlocacao() const {
+    return dispositivoInferior.obterSetoresUnidadeAlocacao();
+}
+
+void LeituraAntecipada::definirHabilitada(bool habilitar) {
+    habilitada = habilitar;
+    if (!habilitar) {
+        descartarBuffer();
+        leiturasSequenciais = 0u;
+    }
+}
+
+bool LeituraAntecipada::estaHabilitada() const {
+    return habilitada;
+}
+
+EstatisticasLeituraAntecipada LeituraAntecipada::obterEstatisticas() const {
+    return estatisticas;
+}
+
+void LeituraAntecipada::zerarEstatisticas() {
+    estatisticas = EstatisticasLeituraAntecipada{};
+}
+
+uint32_t LeituraAntecipada::consumirBuffer(uint8_t *destino, uint32_t setor_inicial, uint32_t quantidade) {
+    // Só aproveita o buffer quando o pedido começa no próximo setor ainda não entregue.
+    uint32_t disponiveis = setoresNoBuffer - indiceBuffer;
+    if (disponiveis == 0u || setor_inicial != setorInicialBuffer + indiceBuffer) {
+        return 0u;
+    }
+
+    uint32_t aproveitados = quantidade < disponiveis ? quantidade : disponiveis;
+    memcpy(destino,
+           bufferIntermediario + (indiceBuffer * TAMANHO_SETOR_DISPOSITIVO),
+           aproveitados * TAMANHO_SETOR_DISPOSITIVO);
+    indiceBuffer = indiceBuffer + aproveitados;
+
+    estatisticas.setores_aproveitados = estatisticas.setores_aproveitados + aproveitados;
+    return aproveitados;
+}
+
+void LeituraAntecipada::descartarBuffer() {
+    setoresNoBuffer = 0u;
+    indiceBuffer = 0u;
+}
+
+void LeituraAntecipada::invalidarIntervalo(uint32_t setor_inicial, uint32_t setor_final) {
+    if (setoresNoBuffer == 0u) {
+        return;
+    }
+
+    uint32_t ultimo_no_buffer = setorInicialBuffer + setoresNoBuffer - 1u;
+    if (setor_final < setorInicialBuffer || setor_inicial > ultimo_no_buffer) {
+        return;
+    }
+
+    descartarBuffer();
+}
+
+} // namespace cartao_sd
@@ -0,0 +1,65 @@
+#ifndef LEITURAANTECIPADA_H
+#define LEITURAANTECIPADA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "DispositivoBloco.h"
+
+#ifndef CARTAO_SD_SETORES_ANTECIPADOS
+#define CARTAO_SD_SETORES_ANTECIPADOS 8
+#endif
+
+namespace cartao_sd {
+
+struct EstatisticasLeituraAntecipada {
+    uint32_t antecipacoes;
+    uint32_t setores_antecipados;
+    uint32_t setores_aproveitados;
+    uint32_t recuos;
+};
+
+// Detecta leituras sequenciais e, a partir da segunda seguida, troca pedidos
+// curtos por um único CMD18 de CARTAO_SD_SETORES_ANTECIPADOS setores. O que
+// sobra fica no buffer intermediário para as próximas chamadas; um acesso
+// fora de sequência descarta o buffer e volta à leitura sob demanda.
+class LeituraAntecipada : public DispositivoBloco {
+public:
+    explicit LeituraAntecipada(DispositivoBloco &dispositivo_inferior);
+
+    bool iniciar() override;
+    bool estaInicializado() const override;
+    bool lerSetores(uint8_t *destino, uint32_t setor_inicial, uint32_t quantidade) override;
+    bool escreverSetores(const uint8_t *origem, uint32_t setor_inicial, uint32_t quantidade) override;
+    bool apagarSetores(uint32_t setor_inicial, uint32_t setor_final) override;
+    bool sincronizar() override;
+    uint64_t obterQuantidadeSetores() const override;
+    uint32_t obterSetoresUnidadeAlocacao() const override;
+
+    void definirHabilitada(bool habilitar);
+    bool estaHabilitada() const;
+    EstatisticasLeituraAntecipada obterEstatisticas() const;
+    void zerarEstatisticas();
+
+private:
+    static constexpr uint32_t SETORES_ANTECIPADOS = CARTAO_SD_SETORES_ANTECIPADOS;
+    static constexpr uint32_t LEITURAS_PARA_ANTECIPAR = 2u;
+
+    DispositivoBloco &dispositivoInferior;
+    bool habilitada;
+    EstatisticasLeituraAntecipada estatisticas;
+    uint32_t proximoSetorEsperado;
+    uint32_t leiturasSequenciais;
+    uint32_t setorInicialBuffer;
+    uint32_t setoresNoBuffer;
+    uint32_t indiceBuffer;
+    uint8_t bufferIntermediario[SETORES_ANTECIPADOS * TAMANHO_SETOR_DISPOSITIVO];
+
+    uint32_t consumirBuffer(uint8_t *destino, uint32_t setor_inicial, uint32_t quantidade);
+    void descartarBuffer();
+    void invalidarIntervalo(uint32_t setor_inicial, uint32_t setor_final);
+};
+
+} // namespace cartao_sd
+
+#endif
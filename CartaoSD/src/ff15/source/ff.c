@@ -60,6 +60,11 @@
 #define FA_MODIFIED	0x40	/* File has been modified */
 #define FA_DIRTY	0x80	/* FIL.buf[] needs to be written-back */
 
+/* CartaoSD: ArquivoSd usa os dois bits acima na escrita direta em setores */
+#include "FatFsFlagsArquivo.h"
+_Static_assert(FA_MODIFIED == CARTAO_SD_FA_MODIFIED && FA_DIRTY == CARTAO_SD_FA_DIRTY,
+			   "FA_MODIFIED/FA_DIRTY mudaram: revise ArquivoSd::escreverSetoresDiretos");
+
 
 /* Additional file attribute bits for internal use */
 #define AM_VOL		0x08	/* Volume label */
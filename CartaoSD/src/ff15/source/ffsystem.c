@@ -39,7 +39,7 @@ void ff_memfree (
 /* Definitions of Mutex                                                   */
 /*------------------------------------------------------------------------*/
 
-#define OS_TYPE	0	/* 0:Win32, 1:uITRON4.0, 2:uC/OS-II, 3:FreeRTOS, 4:CMSIS-RTOS */
+#define OS_TYPE	5	/* 0:Win32, 1:uITRON4.0, 2:uC/OS-II, 3:FreeRTOS, 4:CMSIS-RTOS, 5:Pico SDK */
 
 
 #if   OS_TYPE == 0	/* Win32 */
@@ -64,6 +64,10 @@ static SemaphoreHandle_t Mutex[FF_VOLUMES + 1];	/* Table of mutex handle */
 #include "cmsis_os.h"
 static osMutexId Mutex[FF_VOLUMES + 1];	/* Table of mutex ID */
 
+#elif OS_TYPE == 5	/* Pico SDK (RP2040, both cores) */
+#include "pico/mutex.h"
+static mutex_t Mutex[FF_VOLUMES + 1];	/* Table of mutex object */
+
 #endif
 
 
@@ -106,6 +110,10 @@ int ff_mutex_create (	/* Returns 1:Function succeeded or 0:Could not create the
 	Mutex[vol] = osMutexCreate(osMutex(cmsis_os_mutex));
 	return (int)(Mutex[vol] != NULL);
 
+#elif OS_TYPE == 5	/* Pico SDK */
+	mutex_init(&Mutex[vol]);
+	return 1;
+
 #endif
 }
 
@@ -138,6 +146,9 @@ void ff_mutex_delete (	/* Returns 1:Function succeeded or 0:Could not delete due
 #elif OS_TYPE == 4	/* CMSIS-RTOS */
 	osMutexDelete(Mutex[vol]);
 
+#elif OS_TYPE == 5	/* Pico SDK: static object, nothing to release */
+	(void)vol;
+
 #endif
 }
 
@@ -171,6 +182,9 @@ int ff_mutex_take (	/* Returns 1:Succeeded or 0:Timeout */
 #elif OS_TYPE == 4	/* CMSIS-RTOS */
 	return (int)(osMutexWait(Mutex[vol], FF_FS_TIMEOUT) == osOK);
 
+#elif OS_TYPE == 5	/* Pico SDK (FF_FS_TIMEOUT in ms) */
+	return (int)mutex_enter_timeout_ms(&Mutex[vol], FF_FS_TIMEOUT);
+
 #endif
 }
 
@@ -201,6 +215,9 @@ void ff_mutex_give (
 #elif OS_TYPE == 4	/* CMSIS-RTOS */
 	osMutexRelease(Mutex[vol]);
 
+#elif OS_TYPE == 5	/* Pico SDK */
+	mutex_exit(&Mutex[vol]);
+
 #endif
 }
 
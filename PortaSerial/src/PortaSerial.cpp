@@ -8,6 +8,8 @@ static constexpr uint32_t ESPERA_CURTA_US = 10;
 static constexpr uint32_t AGUARDO_CARACTERE_TEXTO_US = 1000U;
 static constexpr uint32_t TEMPO_MAXIMO_SEM_DADOS_US = 20000U;
 
+PortaSerial* PortaSerial::destinoEncaminhamento = nullptr;
+
 PortaSerial::PortaSerial(uart_inst_t* uart_escolhida,
                          uint32_t taxa_baud,
                          uint pino_tx,
@@ -74,6 +76,33 @@ bool PortaSerial::enviarTextoComNovaLinha(const char* texto) {
     return enviarTexto(FIM_LINHA);
 }
 
+size_t PortaSerial::enviarBytes(const uint8_t* dados, size_t quantidade) {
+    if (uartEscolhida == nullptr || dados == nullptr) {
+        return 0U;
+    }
+
+    uart_write_blocking(uartEscolhida, dados, quantidade);
+
+    return quantidade;
+}
+
+void PortaSerial::definirDestinoEncaminhamento(PortaSerial* porta) {
+    destinoEncaminhamento = porta;
+}
+
+unsigned int PortaSerial::encaminharBytes(const uint8_t* dados, unsigned int quantidade) {
+    if (destinoEncaminhamento == nullptr) {
+        return 0U;
+    }
+
+    // Consulta do FatFs (quantidade zero): a porta está sempre pronta.
+    if (quantidade == 0U) {
+        return 1U;
+    }
+
+    return static_cast<unsigned int>(destinoEncaminhamento->enviarBytes(dados, quantidade));
+}
+
 bool PortaSerial::lerCaractere(char& caractere) {
     if (!haDadosDisponiveis()) {
         return false;
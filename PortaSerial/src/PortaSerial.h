@@ -23,6 +23,8 @@ public:
 
     bool enviarTextoComNovaLinha(const char* texto);
 
+    size_t enviarBytes(const uint8_t* dados, size_t quantidade);
+
     template <typename TipoValor>
     bool enviarValor(const TipoValor& valor) {
         char buffer[TAMANHO_BUFFER_VALOR] = {0};
@@ -50,7 +52,16 @@ public:
 
     bool reiniciar();
 
+    // Destino para o f_forward do FatFs. A função de encaminhamento não recebe
+    // contexto, então os bytes vão para a porta marcada aqui, direto do buffer
+    // de setor do arquivo para o FIFO da UART.
+    static void definirDestinoEncaminhamento(PortaSerial* porta);
+
+    static unsigned int encaminharBytes(const uint8_t* dados, unsigned int quantidade);
+
 private:
+    static PortaSerial* destinoEncaminhamento;
+
     uart_inst_t* uartEscolhida;
     uint32_t taxaBaud;
     uint pinoTx;
@@ -0,0 +1,24 @@
+#ifndef BARRAMENTOSPIHOST_H
+#define BARRAMENTOSPIHOST_H
+
+#include <stdint.h>
+
+#include "hardware/spi.h"
+
+// Liga o SPI emulado a um dispositivo byte a byte: spi_*_blocking e as
+// transferências por DMA passam cada byte do MOSI pela função, que devolve
+// o MISO. Sem dispositivo o barramento segue devolvendo 0xFF.
+using FuncaoTrocaByteHost = uint8_t (*)(void *contexto, uint8_t enviado);
+
+void conectarDispositivoSpiHost(spi_inst_t *spi, FuncaoTrocaByteHost funcao, void *contexto);
+
+// Quantos canais dma_claim_unused_channel ainda pode entregar (0 por padrão,
+// o que leva o controlador ao caminho bloqueante). Libera os já reservados.
+void definirCanaisDmaHost(uint quantidade);
+
+// Transferências que o DMA emulado executou e configurações recusadas por não
+// baterem com o par TX/RX de 8 bits sobre o registrador de dados do SPI.
+uint32_t obterTransferenciasDmaHost();
+uint32_t obterErrosConfiguracaoDmaHost();
+
+#endif
@@ -0,0 +1,187 @@
+#include "DispositivoBlocoArquivo.h"
+
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "RelogioHost.h"
+#include "pico/time.h"
+
+using cartao_sd::TAMANHO_SETOR_DISPOSITIVO;
+
+DispositivoBlocoArquivo::DispositivoBlocoArquivo(const char *caminho_imagem, uint64_t setores_criacao)
+    : caminhoImagem(caminho_imagem),
+      setoresCriacao(setores_criacao),
+      arquivo(nullptr),
+      quantidadeSetores(0u),
+      setoresUnidadeAlocacao(0u),
+      ocupadoAteUs(0u),
+      latencia{},
+      estatisticas{} {
+}
+
+DispositivoBlocoArquivo::~DispositivoBlocoArquivo() {
+    if (arquivo != nullptr) {
+        fclose(arquivo);
+    }
+}
+
+bool DispositivoBlocoArquivo::iniciar() {
+    if (arquivo != nullptr) {
+        return true;
+    }
+
+    return abrirImagem();
+}
+
+bool DispositivoBlocoArquivo::estaInicializado() const {
+    return arquivo != nullptr;
+}
+
+bool DispositivoBlocoArquivo::lerSetores(uint8_t *destino, uint32_t setor_inicial, uint32_t quantidade) {
+    if (destino == nullptr || !intervaloValido(setor_inicial, quantidade)) {
+        return false;
+    }
+
+    aguardarLivre();
+    cobrarTempo(latencia.comando_us + (static_cast<uint64_t>(latencia.transferencia_setor_us) * quantidade));
+
+    size_t tamanho = static_cast<size_t>(quantidade) * TAMANHO_SETOR_DISPOSITIVO;
+    if (fseeko(arquivo, static_cast<off_t>(setor_inicial) * TAMANHO_SETOR_DISPOSITIVO, SEEK_SET) != 0) {
+        return false;
+    }
+
+    if (fread(destino, 1u, tamanho, arquivo) != tamanho) {
+        return false;
+    }
+
+    estatisticas.comandos_leitura = estatisticas.comandos_leitura + 1u;
+    estatisticas.setores_lidos = estatisticas.setores_lidos + quantidade;
+    return true;
+}
+
+bool DispositivoBlocoArquivo::escreverSetores(const uint8_t *origem, uint32_t setor_inicial, uint32_t quantidade) {
+    if (origem == nullptr || !intervaloValido(setor_inicial, quantidade)) {
+        return false;
+    }
+
+    aguardarLivre();
+    cobrarTempo(latencia.comando_us + (static_cast<uint64_t>(latencia.transferencia_setor_us) * quantidade));
+
+    size_t tamanho = static_cast<size_t>(quantidade) * TAMANHO_SETOR_DISPOSITIVO;
+    if (fseeko(arquivo, static_cast<off_t>(setor_inicial) * TAMANHO_SETOR_DISPOSITIVO, SEEK_SET) != 0) {
+        return false;
+    }
+
+    if (fwrite(origem, 1u, tamanho, arquivo) != tamanho) {
+        return false;
+    }
+
+    ocupadoAteUs = time_us_64() + latencia.ocupado_escrita_us;
+    estatisticas.comandos_escrita = estatisticas.comandos_escrita + 1u;
+    estatisticas.setores_escritos = estatisticas.setores_escritos + quantidade;
+    return true;
+}
+
+bool DispositivoBlocoArquivo::apagarSetores(uint32_t setor_inicial, uint32_t setor_final) {
+    if (setor_final < setor_inicial || !intervaloValido(setor_inicial, setor_final - setor_inicial + 1u)) {
+        return false;
+    }
+
+    aguardarLivre();
+    cobrarTempo(latencia.comando_us);
+
+    // Cartões com DATA_STAT_AFTER_ERASE = 0 leem zeros após o apagamento.
+    static const uint8_t ZEROS[TAMANHO_SETOR_DISPOSITIVO] = {0};
+    if (fseeko(arquivo, static_cast<off_t>(setor_inicial) * TAMANHO_SETOR_DISPOSITIVO, SEEK_SET) != 0) {
+        return false;
+    }
+
+    for (uint64_t setor = setor_inicial; setor <= setor_final; setor = setor + 1u) {
+        if (fwrite(ZEROS, 1u, sizeof(ZEROS), arquivo) != sizeof(ZEROS)) {
+            return false;
+        }
+    }
+
+    ocupadoAteUs = time_us_64() + latencia.ocupado_apagamento_us;
+    estatisticas.comandos_apagamento = estatisticas.comandos_apagamento + 1u;
+    return true;
+}
+
+bool DispositivoBlocoArquivo::sincronizar() {
+    if (arquivo == nullptr) {
+        return false;
+    }
+
+    aguardarLivre();
+    return fflush(arquivo) == 0;
+}
+
+uint64_t DispositivoBlocoArquivo::obterQuantidadeSetores() const {
+    return quantidadeSetores;
+}
+
+uint32_t DispositivoBlocoArquivo::obterSetoresUnidadeAlocacao() const {
+    return setoresUnidadeAlocacao;
+}
+
+void DispositivoBlocoArquivo::definirLatencia(const LatenciaSimulada &nova_latencia) {
+    latencia = nova_latencia;
+}
+
+void DispositivoBlocoArquivo::definirSetoresUnidadeAlocacao(uint32_t setores) {
+    setoresUnidadeAlocacao = setores;
+}
+
+EstatisticasDispositivoArquivo DispositivoBlocoArquivo::obterEstatisticas() const {
+    return estatisticas;
+}
+
+void DispositivoBlocoArquivo::zerarEstatisticas() {
+    estatisticas = EstatisticasDispositivoArquivo{};
+}
+
+bool DispositivoBlocoArquivo::abrirImagem() {
+    arquivo = fopen(caminhoImagem, "r+b");
+    if (arquivo == nullptr && setoresCriacao > 0u) {
+        arquivo = fopen(caminhoImagem, "w+b");
+        if (arquivo != nullptr &&
+            ftruncate(fileno(arquivo), static_cast<off_t>(setoresCriacao * TAMANHO_SETOR_DISPOSITIVO)) != 0) {
+            fclose(arquivo);
+            arquivo = nullptr;
+        }
+    }
+
+    if (arquivo == nullptr) {
+        return false;
+    }
+
+    if (fseeko(arquivo, 0, SEEK_END) != 0) {
+        fclose(arquivo);
+        arquivo = nullptr;
+        return false;
+    }
+
+    quantidadeSetores = static_cast<uint64_t>(ftello(arquivo)) / TAMANHO_SETOR_DISPOSITIVO;
+    return quantidadeSetores > 0u;
+}
+
+bool DispositivoBlocoArquivo::intervaloValido(uint32_t setor_inicial, uint32_t quantidade) const {
+    if (arquivo == nullptr || quantidade == 0u) {
+        return false;
+    }
+
+    return static_cast<uint64_t>(setor_inicial) + quantidade <= quantidadeSetores;
+}
+
+void DispositivoBlocoArquivo::aguardarLivre() {
+    uint64_t agora = time_us_64();
+    if (agora < ocupadoAteUs) {
+        cobrarTempo(ocupadoAteUs - agora);
+    }
+}
+
+void DispositivoBlocoArquivo::cobrarTempo(uint64_t tempo_us) {
+    avancarRelogioHost(tempo_us);
+    estatisticas.tempo_simulado_us = estatisticas.tempo_simulado_us + tempo_us;
+}
@@ -0,0 +1,64 @@
+#ifndef DISPOSITIVOBLOCOARQUIVO_H
+#define DISPOSITIVOBLOCOARQUIVO_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "DispositivoBloco.h"
+
+struct LatenciaSimulada {
+    uint32_t comando_us;
+    uint32_t transferencia_setor_us;
+    uint32_t ocupado_escrita_us;
+    uint32_t ocupado_apagamento_us;
+};
+
+struct EstatisticasDispositivoArquivo {
+    uint32_t comandos_leitura;
+    uint32_t comandos_escrita;
+    uint32_t comandos_apagamento;
+    uint64_t setores_lidos;
+    uint64_t setores_escritos;
+    uint64_t tempo_simulado_us;
+};
+
+// Dispositivo de blocos sobre uma imagem de disco para a compilação no host.
+// Cada comando cobra a latência configurada no relógio simulado; o tempo de
+// programação após escritas e apagamentos só é cobrado quando o próximo
+// comando precisa do cartão livre, como no estado ocupado real.
+class DispositivoBlocoArquivo : public cartao_sd::DispositivoBloco {
+public:
+    DispositivoBlocoArquivo(const char *caminho_imagem, uint64_t setores_criacao);
+    ~DispositivoBlocoArquivo() override;
+
+    bool iniciar() override;
+    bool estaInicializado() const override;
+    bool lerSetores(uint8_t *destino, uint32_t setor_inicial, uint32_t quantidade) override;
+    bool escreverSetores(const uint8_t *origem, uint32_t setor_inicial, uint32_t quantidade) override;
+    bool apagarSetores(uint32_t setor_inicial, uint32_t setor_final) override;
+    bool sincronizar() override;
+    uint64_t obterQuantidadeSetores() const override;
+    uint32_t obterSetoresUnidadeAlocacao() const override;
+
+    void definirLatencia(const LatenciaSimulada &nova_latencia);
+    void definirSetoresUnidadeAlocacao(uint32_t setores);
+    EstatisticasDispositivoArquivo obterEstatisticas() const;
+    void zerarEstatisticas();
+
+private:
+    const char *caminhoImagem;
+    uint64_t setoresCriacao;
+    FILE *arquivo;
+    uint64_t quantidadeSetores;
+    uint32_t setoresUnidadeAlocacao;
+    uint64_t ocupadoAteUs;
+    LatenciaSimulada latencia;
+    EstatisticasDispositivoArquivo estatisticas;
+
+    bool abrirImagem();
+    bool intervaloValido(uint32_t setor_inicial, uint32_t quantidade) const;
+    void aguardarLivre();
+    void cobrarTempo(uint64_t tempo_us);
+};
+
+#endif
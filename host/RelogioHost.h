@@ -0,0 +1,10 @@
+#ifndef RELOGIOHOST_H
+#define RELOGIOHOST_H
+
+#include <stdint.h>
+
+// Avança o relógio do host sem bloquear, para simular latências do cartão.
+void avancarRelogioHost(uint64_t atraso_us);
+uint64_t obterTempoSimuladoHost();
+
+#endif
@@ -0,0 +1,701 @@
+#include "SimuladorCartaoSpi.h"
+
+#include <string.h>
+
+#include "CrcCartaoSd.h"
+#include "RelogioHost.h"
+#include "pico/time.h"
+
+using cartao_sd::calcularByteCrc7;
+using cartao_sd::calcularCrc16;
+
+namespace {
+
+constexpr uint32_t FREQUENCIA_PERIFERICA_HZ = 125000000u;
+constexpr uint32_t FREQUENCIA_BAIXA_HZ = 400000u;
+constexpr uint32_t FREQUENCIA_ALTA_HZ = 12500000u;
+constexpr uint64_t NANOSSEGUNDOS_POR_BYTE_HZ = 8000000000ull;
+
+constexpr uint8_t COMANDO_GO_IDLE = 0u;
+constexpr uint8_t COMANDO_SWITCH_FUNC = 6u;
+constexpr uint8_t COMANDO_SEND_IF_COND = 8u;
+constexpr uint8_t COMANDO_SEND_CSD = 9u;
+constexpr uint8_t COMANDO_SEND_CID = 10u;
+constexpr uint8_t COMANDO_STOP_TRANSMISSION = 12u;
+constexpr uint8_t COMANDO_SEND_STATUS = 13u;
+constexpr uint8_t COMANDO_SET_BLOCKLEN = 16u;
+constexpr uint8_t COMANDO_READ_SINGLE = 17u;
+constexpr uint8_t COMANDO_READ_MULTIPLE = 18u;
+constexpr uint8_t COMANDO_WRITE_SINGLE = 24u;
+constexpr uint8_t COMANDO_WRITE_MULTIPLE = 25u;
+constexpr uint8_t COMANDO_ERASE_WR_BLK_START = 32u;
+constexpr uint8_t COMANDO_ERASE_WR_BLK_END = 33u;
+constexpr uint8_t COMANDO_ERASE = 38u;
+constexpr uint8_t COMANDO_APP_CMD = 55u;
+constexpr uint8_t COMANDO_READ_OCR = 58u;
+constexpr uint8_t COMANDO_CRC_ON_OFF = 59u;
+constexpr uint8_t COMANDO_APP_SD_STATUS = 13u;
+constexpr uint8_t COMANDO_APP_SEND_NUM_WR_BLOCKS = 22u;
+constexpr uint8_t COMANDO_APP_SET_WR_BLK = 23u;
+constexpr uint8_t COMANDO_APP_SEND_OP_COND = 41u;
+
+constexpr uint8_t TOKEN_INICIO_DADOS = 0xFEu;
+constexpr uint8_t TOKEN_ESCRITA_MULTIPLA = 0xFCu;
+constexpr uint8_t TOKEN_PARADA_ESCRITA = 0xFDu;
+
+constexpr uint8_t R1_IDLE = 0x01u;
+constexpr uint8_t R1_COMANDO_ILEGAL = 0x04u;
+constexpr uint8_t R1_ERRO_CRC = 0x08u;
+constexpr uint8_t R1_ERRO_ENDERECO = 0x20u;
+constexpr uint8_t RESPOSTA_DADOS_ACEITOS = 0x05u;
+constexpr uint8_t RESPOSTA_DADOS_ERRO_CRC = 0x0Bu;
+constexpr uint8_t RESPOSTA_DADOS_ERRO_ESCRITA = 0x0Du;
+
+constexpr size_t TAMANHO_REGISTRO = 16u;
+constexpr size_t TAMANHO_STATUS = 64u;
+
+// CID de um cartão fictício "SIMUL"; o CRC7 do último byte é calculado no envio.
+constexpr uint8_t CID_SIMULADO[TAMANHO_REGISTRO] = {
+    0x03u, 'S', 'D', 'S', 'I', 'M', 'U', 'L', 0x10u, 0x12u, 0x34u, 0x56u, 0x78u, 0x01u, 0x9Au, 0x00u
+};
+
+} // namespace
+
+SimuladorCartaoSpi::SimuladorCartaoSpi(cartao_sd::DispositivoBloco &armazenamento_cartao, const ParametrosSimuladorSpi &parametros_cartao)
+    : ControladorSpiCartao(nullptr, 0u, 0u, 0u, 0u, FREQUENCIA_BAIXA_HZ, FREQUENCIA_ALTA_HZ),
+      armazenamento(armazenamento_cartao),
+      parametros(parametros_cartao),
+      estatisticas{},
+      frequenciaHz(0u),
+      restoBarramentoNs(0u),
+      selecionado(false),
+      estado(EstadoCartao::Ocioso),
+      emIdle(true),
+      comandoAplicativo(false),
+      verificacaoCrc(false),
+      altaVelocidade(false),
+      inicializacoesPendentes(0u),
+      ocupadoAteUs(0u),
+      comando{},
+      bytesComando(0u),
+      filaResposta{},
+      inicioFila(0u),
+      tamanhoFila(0u),
+      bloco{},
+      tamanhoBloco(0u),
+      indiceBloco(0u),
+      crcBloco(0u),
+      faseBloco(FaseBloco::Inativa),
+      tokenProntoUs(0u),
+      leituraMultipla(false),
+      setorLeitura(0u),
+      blocosLidos(0u),
+      escritaMultipla(false),
+      setorEscrita(0u),
+      blocosGravados(0u),
+      inicioApagamento(0u),
+      fimApagamento(0u) {
+    reiniciarCartao();
+}
+
+bool SimuladorCartaoSpi::configurarHardware() {
+    bytesComando = 0u;
+    limparFila();
+    reiniciarCartao();
+    return armazenamento.iniciar();
+}
+
+void SimuladorCartaoSpi::ajustarFrequenciaBaixa() {
+    ajustarFrequencia(FREQUENCIA_BAIXA_HZ);
+}
+
+void SimuladorCartaoSpi::ajustarFrequenciaAlta() {
+    ajustarFrequencia(obterFrequenciaAlta());
+}
+
+uint32_t SimuladorCartaoSpi::ajustarFrequencia(uint32_t frequencia_hz) {
+    if (frequencia_hz == 0u) {
+        return frequenciaHz;
+    }
+
+    // Mesmo arredondamento do SPI do RP2040: divisor par, nunca acima do pedido.
+    uint32_t divisor = (FREQUENCIA_PERIFERICA_HZ + frequencia_hz - 1u) / frequencia_hz;
+    if (divisor < 2u) {
+        divisor = 2u;
+    }
+    if ((divisor % 2u) != 0u) {
+        divisor = divisor + 1u;
+    }
+
+    frequenciaHz = FREQUENCIA_PERIFERICA_HZ / divisor;
+    return frequenciaHz;
+}
+
+uint32_t SimuladorCartaoSpi::obterFrequenciaAtual() const {
+    return frequenciaHz;
+}
+
+uint32_t SimuladorCartaoSpi::obterFrequenciaPeriferica() const {
+    return FREQUENCIA_PERIFERICA_HZ;
+}
+
+void SimuladorCartaoSpi::enviarClocksInicializacao() {
+    // 80 ciclos com CS alto: o cartão só conta o clock.
+    selecionado = false;
+    size_t indice = 0;
+    while (indice < 10u) {
+        cobrarByte();
+        indice = indice + 1;
+    }
+}
+
+void SimuladorCartaoSpi::adquirirBarramento() {
+    selecionado = true;
+}
+
+void SimuladorCartaoSpi::liberarBarramento() {
+    selecionado = false;
+}
+
+uint8_t SimuladorCartaoSpi::transferirByte(uint8_t dado) {
+    cobrarByte();
+    if (!selecionado) {
+        return 0xFFu;
+    }
+
+    // Full duplex: o byte devolvido já estava decidido antes de o cartão ver o MOSI.
+    uint8_t saida = produzirByte();
+    consumirByte(dado);
+    return saida;
+}
+
+bool SimuladorCartaoSpi::transferirBuffer(const uint8_t *origem, uint8_t *destino, size_t quantidade) {
+    if (origem == nullptr && destino == nullptr) {
+        return false;
+    }
+
+    size_t indice = 0;
+    while (indice < quantidade) {
+        uint8_t valor = transferirByte(origem != nullptr ? origem[indice] : 0xFFu);
+        if (destino != nullptr) {
+            destino[indice] = valor;
+        }
+        indice = indice + 1;
+    }
+
+    return true;
+}
+
+bool SimuladorCartaoSpi::transferirBufferComCrc(const uint8_t *origem, uint8_t *destino, size_t quantidade, uint16_t &crc) {
+    bool transferiu = transferirBuffer(origem, destino, quantidade);
+    const uint8_t *carga = (destino != nullptr) ? destino : origem;
+    crc = calcularCrc16(carga, quantidade);
+    return transferiu;
+}
+
+bool SimuladorCartaoSpi::aguardarMisoLiberado(absolute_time_t tempo_limite) {
+    if (!estaOcupado()) {
+        return true;
+    }
+
+    // A borda de subida chega quando o cartão termina de programar; o núcleo
+    // dorme sem clock, então só o relógio avança.
+    uint64_t espera_us = ocupadoAteUs - obterTempoSimuladoHost();
+    int64_t restante_us = absolute_time_diff_us(get_absolute_time(), tempo_limite);
+    if (restante_us <= 0) {
+        espera_us = 0u;
+    } else if (static_cast<uint64_t>(restante_us) < espera_us) {
+        espera_us = static_cast<uint64_t>(restante_us);
+    }
+
+    avancarRelogioHost(espera_us);
+    estatisticas.esperas_evento = estatisticas.esperas_evento + 1u;
+    estatisticas.tempo_evento_us = estatisticas.tempo_evento_us + espera_us;
+    return !estaOcupado();
+}
+
+EstatisticasSimuladorSpi SimuladorCartaoSpi::obterEstatisticas() const {
+    return estatisticas;
+}
+
+void SimuladorCartaoSpi::zerarEstatisticas() {
+    estatisticas = EstatisticasSimuladorSpi{};
+}
+
+void SimuladorCartaoSpi::reiniciarCartao() {
+    estado = EstadoCartao::Ocioso;
+    emIdle = true;
+    comandoAplicativo = false;
+    verificacaoCrc = false;
+    altaVelocidade = false;
+    inicializacoesPendentes = parametros.respostas_inicializacao;
+    ocupadoAteUs = 0u;
+    faseBloco = FaseBloco::Inativa;
+    leituraMultipla = false;
+    escritaMultipla = false;
+    blocosGravados = 0u;
+}
+
+void SimuladorCartaoSpi::cobrarByte() {
+    uint32_t frequencia = (frequenciaHz != 0u) ? frequenciaHz : FREQUENCIA_BAIXA_HZ;
+    restoBarramentoNs = restoBarramentoNs + (NANOSSEGUNDOS_POR_BYTE_HZ / frequencia);
+
+    uint64_t tempo_us = restoBarramentoNs / 1000u;
+    restoBarramentoNs = restoBarramentoNs % 1000u;
+
+    estatisticas.bytes_clocados = estatisticas.bytes_clocados + 1u;
+    estatisticas.tempo_barramento_us = estatisticas.tempo_barramento_us + tempo_us;
+    if (tempo_us > 0u) {
+        avancarRelogioHost(tempo_us);
+    }
+}
+
+bool SimuladorCartaoSpi::estaOcupado() const {
+    return obterTempoSimuladoHost() < ocupadoAteUs;
+}
+
+uint8_t SimuladorCartaoSpi::produzirByte() {
+    if (tamanhoFila > 0u) {
+        uint8_t valor = filaResposta[inicioFila];
+        inicioFila = (inicioFila + 1u) % TAMANHO_FILA_RESPOSTA;
+        tamanhoFila = tamanhoFila - 1u;
+        return valor;
+    }
+
+    if (faseBloco != FaseBloco::Inativa) {
+        return produzirByteBloco();
+    }
+
+    // Ocupado: o cartão segura o MISO em nível baixo.
+    if (estaOcupado()) {
+        estatisticas.bytes_ocupado = estatisticas.bytes_ocupado + 1u;
+        return 0x00u;
+    }
+
+    return 0xFFu;
+}
+
+uint8_t SimuladorCartaoSpi::produzirByteBloco() {
+    switch (faseBloco) {
+        case FaseBloco::AguardandoToken:
+            if (obterTempoSimuladoHost() < tokenProntoUs) {
+                estatisticas.bytes_espera_token = estatisticas.bytes_espera_token + 1u;
+                return 0xFFu;
+            }
+            faseBloco = FaseBloco::Dados;
+            indiceBloco = 0u;
+            return TOKEN_INICIO_DADOS;
+
+        case FaseBloco::Dados: {
+            uint8_t valor = bloco[indiceBloco];
+            if (frequenciaAcimaDoLimite()) {
+                valor = static_cast<uint8_t>(valor ^ 0x01u);
+            }
+            indiceBloco = indiceBloco + 1u;
+            if (indiceBloco == tamanhoBloco) {
+                faseBloco = FaseBloco::CrcAlto;
+            }
+            return valor;
+        }
+
+        case FaseBloco::CrcAlto:
+            faseBloco = FaseBloco::CrcBaixo;
+            return static_cast<uint8_t>(crcBloco >> 8u);
+
+        case FaseBloco::CrcBaixo: {
+            uint8_t valor = static_cast<uint8_t>(crcBloco & 0xFFu);
+            faseBloco = FaseBloco::Inativa;
+            // No CMD18 o próximo setor segue até chegar o CMD12.
+            if (leituraMultipla) {
+                carregarSetorLeitura();
+            }
+            return valor;
+        }
+
+        case FaseBloco::Inativa:
+            break;
+    }
+
+    return 0xFFu;
+}
+
+void SimuladorCartaoSpi::consumirByte(uint8_t dado) {
+    if (estado == EstadoCartao::RecebendoDados) {
+        consumirByteDados(dado);
+        return;
+    }
+
+    if (bytesComando > 0u) {
+        comando[bytesComando] = dado;
+        bytesComando = bytesComando + 1u;
+        if (bytesComando == sizeof(comando)) {
+            bytesComando = 0u;
+            processarComando();
+        }
+        return;
+    }
+
+    if (estado == EstadoCartao::AguardandoTokenEscrita) {
+        if ((dado == TOKEN_INICIO_DADOS && !escritaMultipla) || (dado == TOKEN_ESCRITA_MULTIPLA && escritaMultipla)) {
+            estado = EstadoCartao::RecebendoDados;
+            indiceBloco = 0u;
+            return;
+        }
+
+        if (dado == TOKEN_PARADA_ESCRITA && escritaMultipla) {
+            estado = EstadoCartao::Ocioso;
+            escritaMultipla = false;
+            ocupadoAteUs = obterTempoSimuladoHost() + parametros.ocupado_escrita_us;
+            return;
+        }
+    }
+
+    // Todo comando começa com os bits 01; os tokens de dados começam com 11.
+    if ((dado & 0xC0u) == 0x40u) {
+        comando[0] = dado;
+        bytesComando = 1u;
+    }
+}
+
+void SimuladorCartaoSpi::consumirByteDados(uint8_t dado) {
+    if (indiceBloco < TAMANHO_BLOCO) {
+        bloco[indiceBloco] = dado;
+        indiceBloco = indiceBloco + 1u;
+        return;
+    }
+
+    if (indiceBloco == TAMANHO_BLOCO) {
+        crcBloco = static_cast<uint16_t>(dado << 8u);
+        indiceBloco = indiceBloco + 1u;
+        return;
+    }
+
+    crcBloco = static_cast<uint16_t>(crcBloco | dado);
+    estado = escritaMultipla ? EstadoCartao::AguardandoTokenEscrita : EstadoCartao::Ocioso;
+
+    if (verificacaoCrc && calcularCrc16(bloco, TAMANHO_BLOCO) != crcBloco) {
+        enfileirar(RESPOSTA_DADOS_ERRO_CRC);
+        return;
+    }
+
+    if (!armazenamento.escreverSetores(bloco, setorEscrita, 1u)) {
+        enfileirar(RESPOSTA_DADOS_ERRO_ESCRITA);
+        return;
+    }
+
+    enfileirar(RESPOSTA_DADOS_ACEITOS);
+    estatisticas.setores_escritos = estatisticas.setores_escritos + 1u;
+    blocosGravados = blocosGravados + 1u;
+    setorEscrita = setorEscrita + 1u;
+
+    uint32_t ocupado_us = escritaMultipla ? parametros.ocupado_bloco_us : parametros.ocupado_escrita_us;
+    ocupadoAteUs = obterTempoSimuladoHost() + ocupado_us;
+}
+
+void SimuladorCartaoSpi::processarComando() {
+    estatisticas.comandos = estatisticas.comandos + 1u;
+
+    uint8_t indice = static_cast<uint8_t>(comando[0] & 0x3Fu);
+    uint32_t argumento = (static_cast<uint32_t>(comando[1]) << 24u) |
+                         (static_cast<uint32_t>(comando[2]) << 16u) |
+                         (static_cast<uint32_t>(comando[3]) << 8u) |
+                         static_cast<uint32_t>(comando[4]);
+    bool aplicativo = comandoAplicativo;
+    comandoAplicativo = false;
+
+    uint8_t r1 = emIdle ? R1_IDLE : 0x00u;
+
+    if (indice == COMANDO_STOP_TRANSMISSION) {
+        // O byte seguinte ao CMD12 ainda sai do bloco interrompido.
+        limparFila();
+        faseBloco = FaseBloco::Inativa;
+        leituraMultipla = false;
+        escritaMultipla = false;
+        estado = EstadoCartao::Ocioso;
+        enfileirar(0xFFu);
+        enfileirar(r1);
+        return;
+    }
+
+    faseBloco = FaseBloco::Inativa;
+    leituraMultipla = false;
+    enfileirar(0xFFu);
+
+    // CMD0 e CMD8 sempre chegam com CRC válido; os demais só são conferidos após o CMD59.
+    bool conferir_crc = verificacaoCrc || indice == COMANDO_GO_IDLE || indice == COMANDO_SEND_IF_COND;
+    if (conferir_crc && calcularByteCrc7(comando, 5u) != comando[5]) {
+        enfileirar(static_cast<uint8_t>(r1 | R1_ERRO_CRC));
+        return;
+    }
+
+    if (aplicativo) {
+        processarComandoAplicativo(indice, argumento);
+        return;
+    }
+
+    uint64_t quantidade_setores = armazenamento.obterQuantidadeSetores();
+
+    switch (indice) {
+        case COMANDO_GO_IDLE:
+            reiniciarCartao();
+            enfileirar(R1_IDLE);
+            break;
+
+        case COMANDO_SEND_IF_COND:
+            enfileirar(r1);
+            enfileirar(0x00u);
+            enfileirar(0x00u);
+            enfileirar(static_cast<uint8_t>((argumento >> 8u) & 0x0Fu));
+            enfileirar(static_cast<uint8_t>(argumento & 0xFFu));
+            break;
+
+        case COMANDO_SEND_CSD: {
+            uint8_t csd[TAMANHO_REGISTRO];
+            montarCsd(csd);
+            enfileirar(r1);
+            agendarBloco(csd, sizeof(csd), 0u);
+            break;
+        }
+
+        case COMANDO_SEND_CID: {
+            uint8_t cid[TAMANHO_REGISTRO];
+            memcpy(cid, CID_SIMULADO, sizeof(cid));
+            cid[15] = calcularByteCrc7(cid, 15u);
+            enfileirar(r1);
+            agendarBloco(cid, sizeof(cid), 0u);
+            break;
+        }
+
+        case COMANDO_SEND_STATUS:
+            enfileirar(r1);
+            enfileirar(0x00u);
+            break;
+
+        case COMANDO_SET_BLOCKLEN:
+            enfileirar(argumento == TAMANHO_BLOCO ? r1 : static_cast<uint8_t>(r1 | R1_COMANDO_ILEGAL));
+            break;
+
+        case COMANDO_READ_SINGLE:
+        case COMANDO_READ_MULTIPLE:
+            if (argumento >= quantidade_setores) {
+                enfileirar(static_cast<uint8_t>(r1 | R1_ERRO_ENDERECO));
+                break;
+            }
+            enfileirar(r1);
+            setorLeitura = argumento;
+            leituraMultipla = (indice == COMANDO_READ_MULTIPLE);
+            carregarSetorLeitura();
+            break;
+
+        case COMANDO_WRITE_SINGLE:
+        case COMANDO_WRITE_MULTIPLE:
+            if (argumento >= quantidade_setores) {
+                enfileirar(static_cast<uint8_t>(r1 | R1_ERRO_ENDERECO));
+                break;
+            }
+            enfileirar(r1);
+            setorEscrita = argumento;
+            escritaMultipla = (indice == COMANDO_WRITE_MULTIPLE);
+            blocosGravados = 0u;
+            estado = EstadoCartao::AguardandoTokenEscrita;
+            break;
+
+        case COMANDO_ERASE_WR_BLK_START:
+            inicioApagamento = argumento;
+            enfileirar(r1);
+            break;
+
+        case COMANDO_ERASE_WR_BLK_END:
+            fimApagamento = argumento;
+            enfileirar(r1);
+            break;
+
+        case COMANDO_ERASE:
+            if (!armazenamento.apagarSetores(inicioApagamento, fimApagamento)) {
+                enfileirar(static_cast<uint8_t>(r1 | R1_ERRO_ENDERECO));
+                break;
+            }
+            enfileirar(r1);
+            ocupadoAteUs = obterTempoSimuladoHost() + parametros.ocupado_apagamento_us;
+            break;
+
+        case COMANDO_APP_CMD:
+            comandoAplicativo = true;
+            enfileirar(r1);
+            break;
+
+        case COMANDO_READ_OCR:
+            // OCR com o bit de pronto e o CCS (alta capacidade) após o ACMD41.
+            enfileirar(r1);
+            enfileirar(emIdle ? 0x00u : 0xC0u);
+            enfileirar(0xFFu);
+            enfileirar(0x80u);
+            enfileirar(0x00u);
+            break;
+
+        case COMANDO_CRC_ON_OFF:
+            verificacaoCrc = (argumento & 0x01u) != 0u;
+            enfileirar(r1);
+            break;
+
+        case COMANDO_SWITCH_FUNC: {
+            uint8_t status[TAMANHO_STATUS];
+            montarStatusSwitch(argumento, status);
+            enfileirar(r1);
+            agendarBloco(status, sizeof(status), 0u);
+            break;
+        }
+
+        default:
+            enfileirar(static_cast<uint8_t>(r1 | R1_COMANDO_ILEGAL));
+            break;
+    }
+}
+
+void SimuladorCartaoSpi::processarComandoAplicativo(uint8_t indice, uint32_t argumento) {
+    (void)argumento;
+    uint8_t r1 = emIdle ? R1_IDLE : 0x00u;
+
+    switch (indice) {
+        case COMANDO_APP_SEND_OP_COND:
+            if (inicializacoesPendentes > 0u) {
+                inicializacoesPendentes = inicializacoesPendentes - 1u;
+                enfileirar(R1_IDLE);
+                break;
+            }
+            emIdle = false;
+            enfileirar(0x00u);
+            break;
+
+        case COMANDO_APP_SD_STATUS: {
+            uint8_t status[TAMANHO_STATUS];
+            montarStatusSd(status);
+            enfileirar(r1);
+            enfileirar(0x00u);
+            agendarBloco(status, sizeof(status), 0u);
+            break;
+        }
+
+        case COMANDO_APP_SEND_NUM_WR_BLOCKS: {
+            uint8_t contagem[4] = {
+                static_cast<uint8_t>(blocosGravados >> 24u),
+                static_cast<uint8_t>(blocosGravados >> 16u),
+                static_cast<uint8_t>(blocosGravados >> 8u),
+                static_cast<uint8_t>(blocosGravados)
+            };
+            enfileirar(r1);
+            agendarBloco(contagem, sizeof(contagem), 0u);
+            break;
+        }
+
+        case COMANDO_APP_SET_WR_BLK:
+            enfileirar(r1);
+            break;
+
+        default:
+            enfileirar(static_cast<uint8_t>(r1 | R1_COMANDO_ILEGAL));
+            break;
+    }
+}
+
+void SimuladorCartaoSpi::enfileirar(uint8_t valor) {
+    if (tamanhoFila == TAMANHO_FILA_RESPOSTA) {
+        return;
+    }
+
+    filaResposta[(inicioFila + tamanhoFila) % TAMANHO_FILA_RESPOSTA] = valor;
+    tamanhoFila = tamanhoFila + 1u;
+}
+
+void SimuladorCartaoSpi::limparFila() {
+    inicioFila = 0u;
+    tamanhoFila = 0u;
+}
+
+void SimuladorCartaoSpi::agendarBloco(const uint8_t *dados, size_t tamanho, uint32_t atraso_us) {
+    memcpy(bloco, dados, tamanho);
+    tamanhoBloco = tamanho;
+    indiceBloco = 0u;
+    crcBloco = calcularCrc16(bloco, tamanho);
+    faseBloco = FaseBloco::AguardandoToken;
+    tokenProntoUs = obterTempoSimuladoHost() + atraso_us;
+}
+
+bool SimuladorCartaoSpi::carregarSetorLeitura() {
+    uint8_t setor[TAMANHO_BLOCO];
+    if (setorLeitura >= armazenamento.obterQuantidadeSetores() ||
+        !armazenamento.lerSetores(setor, setorLeitura, 1u)) {
+        leituraMultipla = false;
+        return false;
+    }
+
+    agendarBloco(setor, sizeof(setor), parametros.atraso_token_us);
+    setorLeitura = setorLeitura + 1u;
+    blocosLidos = blocosLidos + 1u;
+    estatisticas.setores_lidos = estatisticas.setores_lidos + 1u;
+
+    if (parametros.falha_crc_a_cada != 0u && (blocosLidos % parametros.falha_crc_a_cada) == 0u) {
+        crcBloco = static_cast<uint16_t>(crcBloco ^ 0x0001u);
+        estatisticas.erros_crc_injetados = estatisticas.erros_crc_injetados + 1u;
+    }
+
+    return true;
+}
+
+void SimuladorCartaoSpi::montarCsd(uint8_t *destino) const {
+    // CSD 2.0: classes 0x5B5 (inclui a 10, CMD6), blocos de 512 bytes e
+    // C_SIZE tirado do tamanho da imagem em unidades de 512 KiB.
+    uint64_t unidades = armazenamento.obterQuantidadeSetores() / 1024u;
+    if (unidades == 0u) {
+        unidades = 1u;
+    }
+    uint32_t c_size = static_cast<uint32_t>(unidades - 1u);
+
+    const uint8_t modelo[TAMANHO_REGISTRO] = {
+        0x40u, 0x0Eu, 0x00u, 0x32u, 0x5Bu, 0x59u, 0x00u, 0x00u,
+        0x00u, 0x00u, 0x7Fu, 0x80u, 0x0Au, 0x40u, 0x00u, 0x00u
+    };
+    memcpy(destino, modelo, TAMANHO_REGISTRO);
+    destino[7] = static_cast<uint8_t>((c_size >> 16u) & 0x3Fu);
+    destino[8] = static_cast<uint8_t>((c_size >> 8u) & 0xFFu);
+    destino[9] = static_cast<uint8_t>(c_size & 0xFFu);
+    destino[15] = calcularByteCrc7(destino, 15u);
+}
+
+void SimuladorCartaoSpi::montarStatusSd(uint8_t *destino) const {
+    memset(destino, 0, TAMANHO_STATUS);
+    destino[8] = 0x04u;                                              // SPEED_CLASS: classe 10
+    destino[9] = 0x0Au;                                              // PERFORMANCE_MOVE: 10 MB/s
+    destino[10] = static_cast<uint8_t>((parametros.codigo_au & 0x0Fu) << 4u);
+    destino[12] = 0x01u;                                             // ERASE_SIZE: 1 AU
+    destino[13] = static_cast<uint8_t>((1u << 2u) | 0x01u);          // ERASE_TIMEOUT 1 s, ERASE_OFFSET 1 s
+}
+
+void SimuladorCartaoSpi::montarStatusSwitch(uint32_t argumento, uint8_t *destino) {
+    memset(destino, 0, TAMANHO_STATUS);
+    destino[1] = 0x64u;
+    destino[13] = static_cast<uint8_t>(0x01u | (parametros.suporta_alta_velocidade ? 0x02u : 0x00u));
+
+    // Grupo 1 nos bits 3:0 do argumento; 0xF mantém a função atual.
+    uint8_t funcao = static_cast<uint8_t>(argumento & 0x0Fu);
+    uint8_t selecionada = 0x0Fu;
+    if (funcao == 0x0Fu) {
+        selecionada = altaVelocidade ? 0x01u : 0x00u;
+    } else if (funcao == 0x00u || (funcao == 0x01u && parametros.suporta_alta_velocidade)) {
+        selecionada = funcao;
+        if ((argumento & 0x80000000u) != 0u) {
+            altaVelocidade = (funcao == 0x01u);
+        }
+    }
+
+    destino[16] = selecionada;
+}
+
+bool SimuladorCartaoSpi::frequenciaAcimaDoLimite() const {
+    if (parametros.frequencia_maxima_hz == 0u) {
+        return false;
+    }
+
+    uint32_t limite_hz = altaVelocidade ? parametros.frequencia_maxima_hz * 2u : parametros.frequencia_maxima_hz;
+    return frequenciaHz > limite_hz;
+}
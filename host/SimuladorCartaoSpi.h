@@ -0,0 +1,137 @@
+#ifndef SIMULADORCARTAOSPI_H
+#define SIMULADORCARTAOSPI_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ControladorSpiCartao.h"
+#include "DispositivoBloco.h"
+
+struct ParametrosSimuladorSpi {
+    uint32_t atraso_token_us;          // do fim do comando de leitura ao token de dados
+    uint32_t ocupado_escrita_us;       // programação após CMD24 e após o token de parada do CMD25
+    uint32_t ocupado_bloco_us;         // intervalo entre blocos de um CMD25
+    uint32_t ocupado_apagamento_us;    // CMD38
+    uint32_t respostas_inicializacao;  // ACMD41 respondidos como ocupado antes de ficar pronto
+    uint8_t codigo_au;                 // AU_SIZE do SD Status (9 = 4 MiB)
+    bool suporta_alta_velocidade;      // CMD6 aceita a função 1 do grupo 1
+    uint32_t frequencia_maxima_hz;     // acima dele os dados saem corrompidos (dobra em alta velocidade); 0 = sem limite
+    uint32_t falha_crc_a_cada;         // corrompe o CRC de um a cada N blocos lidos; 0 = nunca
+};
+
+struct EstatisticasSimuladorSpi {
+    uint64_t bytes_clocados;
+    uint64_t bytes_espera_token;
+    uint64_t bytes_ocupado;
+    uint64_t tempo_barramento_us;
+    uint32_t esperas_evento;
+    uint64_t tempo_evento_us;
+    uint32_t comandos;
+    uint32_t setores_lidos;
+    uint32_t setores_escritos;
+    uint32_t erros_crc_injetados;
+};
+
+// Modelo do cartão SD em modo SPI, byte a byte, atrás da interface do
+// ControladorSpiCartao. Cada byte trocado custa 8 ciclos de SCK no relógio
+// simulado; o token de leitura e o estado ocupado dependem só desse relógio
+// (nunca do tempo real do host), de modo que varreduras, esperas por evento e
+// transferências aparecem nos contadores como no barramento real e os números
+// quase não variam entre execuções. Os setores ficam em um DispositivoBloco.
+class SimuladorCartaoSpi : public cartao_sd::ControladorSpiCartao {
+public:
+    SimuladorCartaoSpi(cartao_sd::DispositivoBloco &armazenamento_cartao, const ParametrosSimuladorSpi &parametros_cartao);
+
+    bool configurarHardware() override;
+    void ajustarFrequenciaBaixa() override;
+    void ajustarFrequenciaAlta() override;
+    uint32_t ajustarFrequencia(uint32_t frequencia_hz) override;
+    uint32_t obterFrequenciaAtual() const override;
+    uint32_t obterFrequenciaPeriferica() const override;
+    void enviarClocksInicializacao() override;
+    void adquirirBarramento() override;
+    void liberarBarramento() override;
+    uint8_t transferirByte(uint8_t dado) override;
+    bool transferirBuffer(const uint8_t *origem, uint8_t *destino, size_t quantidade) override;
+    bool transferirBufferComCrc(const uint8_t *origem, uint8_t *destino, size_t quantidade, uint16_t &crc) override;
+    bool aguardarMisoLiberado(absolute_time_t tempo_limite) override;
+
+    EstatisticasSimuladorSpi obterEstatisticas() const;
+    void zerarEstatisticas();
+
+private:
+    enum class EstadoCartao : uint8_t {
+        Ocioso,
+        AguardandoTokenEscrita,
+        RecebendoDados
+    };
+
+    enum class FaseBloco : uint8_t {
+        Inativa,
+        AguardandoToken,
+        Dados,
+        CrcAlto,
+        CrcBaixo
+    };
+
+    static constexpr size_t TAMANHO_FILA_RESPOSTA = 8u;
+    static constexpr size_t TAMANHO_BLOCO = cartao_sd::TAMANHO_SETOR_DISPOSITIVO;
+
+    cartao_sd::DispositivoBloco &armazenamento;
+    ParametrosSimuladorSpi parametros;
+    EstatisticasSimuladorSpi estatisticas;
+    uint32_t frequenciaHz;
+    uint64_t restoBarramentoNs;
+    bool selecionado;
+
+    EstadoCartao estado;
+    bool emIdle;
+    bool comandoAplicativo;
+    bool verificacaoCrc;
+    bool altaVelocidade;
+    uint32_t inicializacoesPendentes;
+    uint64_t ocupadoAteUs;
+
+    uint8_t comando[6];
+    size_t bytesComando;
+
+    uint8_t filaResposta[TAMANHO_FILA_RESPOSTA];
+    size_t inicioFila;
+    size_t tamanhoFila;
+
+    uint8_t bloco[TAMANHO_BLOCO];
+    size_t tamanhoBloco;
+    size_t indiceBloco;
+    uint16_t crcBloco;
+    FaseBloco faseBloco;
+    uint64_t tokenProntoUs;
+    bool leituraMultipla;
+    uint32_t setorLeitura;
+    uint32_t blocosLidos;
+
+    bool escritaMultipla;
+    uint32_t setorEscrita;
+    uint32_t blocosGravados;
+    uint32_t inicioApagamento;
+    uint32_t fimApagamento;
+
+    void reiniciarCartao();
+    void cobrarByte();
+    bool estaOcupado() const;
+    uint8_t produzirByte();
+    uint8_t produzirByteBloco();
+    void consumirByte(uint8_t dado);
+    void consumirByteDados(uint8_t dado);
+    void processarComando();
+    void processarComandoAplicativo(uint8_t indice, uint32_t argumento);
+    void enfileirar(uint8_t valor);
+    void limparFila();
+    void agendarBloco(const uint8_t *dados, size_t tamanho, uint32_t atraso_us);
+    bool carregarSetorLeitura();
+    void montarCsd(uint8_t *destino) const;
+    void montarStatusSd(uint8_t *destino) const;
+    void montarStatusSwitch(uint32_t argumento, uint8_t *destino);
+    bool frequenciaAcimaDoLimite() const;
+};
+
+#endif
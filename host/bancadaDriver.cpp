@@ -0,0 +1,214 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "DispositivoBlocoArquivo.h"
+#include "DriverCartaoSd.h"
+#include "RelogioHost.h"
+#include "SimuladorCartaoSpi.h"
+
+// Bancada do DriverCartaoSd sobre o SimuladorCartaoSpi: cada cenário liga um
+// recurso do driver (CRC, escrita adiada, espera por evento) e mede escritas e
+// leituras setor a setor e em rajada. Os números saem do relógio simulado e
+// dos contadores do barramento, portanto não dependem da máquina host.
+
+using cartao_sd::DriverCartaoSd;
+using cartao_sd::EstrategiaEspera;
+using cartao_sd::TAMANHO_SETOR_DISPOSITIVO;
+
+static constexpr uint64_t SETORES_IMAGEM_PADRAO = 65536u;
+static constexpr uint32_t SETOR_INICIAL_BANCADA = 4096u;
+static constexpr uint32_t SETORES_BANCADA_PADRAO = 64u;
+static constexpr uint32_t SETORES_MAXIMOS_BANCADA = 256u;
+
+struct CenarioBancada {
+    const char *nome;
+    bool verificacao_crc;
+    bool escrita_adiada;
+    EstrategiaEspera estrategia;
+};
+
+static const CenarioBancada CENARIOS[] = {
+    {"base", false, false, EstrategiaEspera::Varredura},
+    {"crc", true, false, EstrategiaEspera::Varredura},
+    {"adiada", false, true, EstrategiaEspera::Varredura},
+    {"evento", false, false, EstrategiaEspera::Evento},
+    {"adiada+evento", false, true, EstrategiaEspera::Evento},
+};
+
+static uint8_t dadosEscrita[SETORES_MAXIMOS_BANCADA * TAMANHO_SETOR_DISPOSITIVO];
+static uint8_t dadosLeitura[SETORES_MAXIMOS_BANCADA * TAMANHO_SETOR_DISPOSITIVO];
+
+static void imprimirUso(const char *programa) {
+    fprintf(stderr,
+            "Uso: %s <imagem> [--setores N] [--atraso-token-us N] [--ocupado-us N]\n"
+            "       [--ocupado-bloco-us N] [--falha-crc N] [--limite-hz N]\n",
+            programa);
+}
+
+static void preencherPadrao(uint32_t semente, uint32_t quantidade) {
+    size_t tamanho = static_cast<size_t>(quantidade) * TAMANHO_SETOR_DISPOSITIVO;
+    uint32_t valor = semente * 2654435761u;
+    size_t indice = 0;
+    while (indice < tamanho) {
+        valor = (valor * 1103515245u) + 12345u;
+        dadosEscrita[indice] = static_cast<uint8_t>(valor >> 16u);
+        indice = indice + 1;
+    }
+}
+
+static void imprimirLinha(const char *cenario,
+                          const char *operacao,
+                          uint32_t setores,
+                          uint64_t tempo_us,
+                          const EstatisticasSimuladorSpi &antes,
+                          const EstatisticasSimuladorSpi &depois,
+                          bool correto) {
+    uint64_t bytes = depois.bytes_clocados - antes.bytes_clocados;
+    uint64_t espera_token = depois.bytes_espera_token - antes.bytes_espera_token;
+    uint64_t ocupado = depois.bytes_ocupado - antes.bytes_ocupado;
+    uint64_t dormindo_us = depois.tempo_evento_us - antes.tempo_evento_us;
+    uint32_t comandos = depois.comandos - antes.comandos;
+
+    printf("%-14s %-16s %8.1f %8.1f %8.1f %8.1f %8.1f %6.2f %7.1f  %s\n",
+           cenario,
+           operacao,
+           static_cast<double>(tempo_us) / setores,
+           static_cast<double>(bytes) / setores,
+           static_cast<double>(espera_token) / setores,
+           static_cast<double>(ocupado) / setores,
+           static_cast<double>(dormindo_us) / setores,
+           static_cast<double>(comandos) / setores,
+           (static_cast<double>(setores) * TAMANHO_SETOR_DISPOSITIVO) / (tempo_us > 0u ? tempo_us : 1u),
+           correto ? "ok" : "FALHA");
+}
+
+static bool executarCenario(const CenarioBancada &cenario,
+                            cartao_sd::DispositivoBloco &imagem,
+                            const ParametrosSimuladorSpi &parametros,
+                            uint32_t setores) {
+    SimuladorCartaoSpi simulador(imagem, parametros);
+    DriverCartaoSd driver(simulador);
+    driver.definirVerificacaoCrc(cenario.verificacao_crc);
+    driver.definirEscritaAdiada(cenario.escrita_adiada);
+    driver.definirEstrategiaEspera(cenario.estrategia);
+
+    if (!driver.iniciar()) {
+        printf("%-14s falha na inicializacao\n", cenario.nome);
+        return false;
+    }
+
+    printf("%-14s SPI a %u Hz (%s)\n", cenario.nome, driver.obterFrequenciaOperacao(),
+           cartao_sd::descreverMotivoFrequencia(driver.obterMotivoFrequencia()));
+
+    bool tudo_certo = true;
+    uint32_t semente = 1u;
+
+    // Cada operação roda setor a setor (CMD17/CMD24) e em rajada (CMD18/CMD25).
+    for (uint32_t rajada = 0u; rajada < 2u; rajada = rajada + 1u) {
+        preencherPadrao(semente, setores);
+        semente = semente + 1u;
+
+        EstatisticasSimuladorSpi antes = simulador.obterEstatisticas();
+        uint64_t inicio_us = obterTempoSimuladoHost();
+        bool escreveu = true;
+        if (rajada == 1u) {
+            escreveu = driver.escreverSetores(dadosEscrita, SETOR_INICIAL_BANCADA, setores);
+        } else {
+            for (uint32_t indice = 0u; indice < setores && escreveu; indice = indice + 1u) {
+                escreveu = driver.escreverSetores(dadosEscrita + (indice * TAMANHO_SETOR_DISPOSITIVO), SETOR_INICIAL_BANCADA + indice, 1u);
+            }
+        }
+        escreveu = escreveu && driver.sincronizar();
+        uint64_t tempo_escrita_us = obterTempoSimuladoHost() - inicio_us;
+        imprimirLinha(cenario.nome, rajada == 1u ? "escrita rajada" : "escrita setor", setores,
+                      tempo_escrita_us, antes, simulador.obterEstatisticas(), escreveu);
+
+        memset(dadosLeitura, 0, sizeof(dadosLeitura));
+        antes = simulador.obterEstatisticas();
+        inicio_us = obterTempoSimuladoHost();
+        bool leu = true;
+        if (rajada == 1u) {
+            leu = driver.lerSetores(dadosLeitura, SETOR_INICIAL_BANCADA, setores);
+        } else {
+            for (uint32_t indice = 0u; indice < setores && leu; indice = indice + 1u) {
+                leu = driver.lerSetores(dadosLeitura + (indice * TAMANHO_SETOR_DISPOSITIVO), SETOR_INICIAL_BANCADA + indice, 1u);
+            }
+        }
+        uint64_t tempo_leitura_us = obterTempoSimuladoHost() - inicio_us;
+        bool confere = leu && memcmp(dadosEscrita, dadosLeitura, static_cast<size_t>(setores) * TAMANHO_SETOR_DISPOSITIVO) == 0;
+        imprimirLinha(cenario.nome, rajada == 1u ? "leitura rajada" : "leitura setor", setores,
+                      tempo_leitura_us, antes, simulador.obterEstatisticas(), confere);
+
+        tudo_certo = tudo_certo && escreveu && confere;
+    }
+
+    if (driver.obterErrosCrc() > 0u) {
+        printf("%-14s %u erros de CRC recuperados, %u injetados\n",
+               cenario.nome, driver.obterErrosCrc(), simulador.obterEstatisticas().erros_crc_injetados);
+    }
+
+    return tudo_certo;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        imprimirUso(argv[0]);
+        return 1;
+    }
+
+    uint32_t setores = SETORES_BANCADA_PADRAO;
+    ParametrosSimuladorSpi parametros{};
+    parametros.atraso_token_us = 300u;
+    parametros.ocupado_escrita_us = 700u;
+    parametros.ocupado_bloco_us = 250u;
+    parametros.ocupado_apagamento_us = 2000u;
+    parametros.respostas_inicializacao = 3u;
+    parametros.codigo_au = 9u;
+    parametros.suporta_alta_velocidade = true;
+
+    for (int indice = 2; indice + 1 < argc; indice = indice + 2) {
+        const char *opcao = argv[indice];
+        unsigned long valor = strtoul(argv[indice + 1], nullptr, 10);
+
+        if (strcmp(opcao, "--setores") == 0) {
+            setores = static_cast<uint32_t>(valor);
+        } else if (strcmp(opcao, "--atraso-token-us") == 0) {
+            parametros.atraso_token_us = static_cast<uint32_t>(valor);
+        } else if (strcmp(opcao, "--ocupado-us") == 0) {
+            parametros.ocupado_escrita_us = static_cast<uint32_t>(valor);
+        } else if (strcmp(opcao, "--ocupado-bloco-us") == 0) {
+            parametros.ocupado_bloco_us = static_cast<uint32_t>(valor);
+        } else if (strcmp(opcao, "--falha-crc") == 0) {
+            parametros.falha_crc_a_cada = static_cast<uint32_t>(valor);
+        } else if (strcmp(opcao, "--limite-hz") == 0) {
+            parametros.frequencia_maxima_hz = static_cast<uint32_t>(valor);
+        } else {
+            imprimirUso(argv[0]);
+            return 1;
+        }
+    }
+
+    if (setores == 0u || setores > SETORES_MAXIMOS_BANCADA) {
+        fprintf(stderr, "--setores deve ficar entre 1 e %u\n", SETORES_MAXIMOS_BANCADA);
+        return 1;
+    }
+
+    // A imagem não cobra latência própria: todo o tempo vem do modelo SPI.
+    DispositivoBlocoArquivo imagem(argv[1], SETORES_IMAGEM_PADRAO);
+    if (!imagem.iniciar()) {
+        fprintf(stderr, "Nao foi possivel abrir a imagem %s\n", argv[1]);
+        return 1;
+    }
+
+    printf("%-14s %-16s %8s %8s %8s %8s %8s %6s %7s\n",
+           "cenario", "operacao", "us/set", "bytes", "token", "ocupado", "dormindo", "cmds", "MB/s");
+
+    bool tudo_certo = true;
+    for (const CenarioBancada &cenario : CENARIOS) {
+        tudo_certo = executarCenario(cenario, imagem, parametros, setores) && tudo_certo;
+    }
+
+    return tudo_certo ? 0 : 1;
+}
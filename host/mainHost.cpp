@@ -0,0 +1,105 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "CartaoSD.h"
+#include "DispositivoBlocoArquivo.h"
+#include "PortaSerial.h"
+#include "mineBash.h"
+
+// MineBash no Linux: o volume FAT fica em uma imagem de disco e o console usa
+// a entrada e a saída padrão. As latências simuladas partem de um cartão
+// típico a 25 MHz e podem ser trocadas pela linha de comando.
+
+static constexpr uint64_t SETORES_IMAGEM_PADRAO = 131072u;
+static constexpr uint32_t TAXA_BPS_UART = 115200u;
+
+static DispositivoBlocoArquivo *dispositivoAtivo = nullptr;
+
+static void imprimirUso(const char *programa) {
+    fprintf(stderr,
+            "Uso: %s <imagem> [--criar-mb N] [--comando-us N] [--setor-us N]\n"
+            "       [--ocupado-us N] [--apagamento-us N] [--au-setores N]\n",
+            programa);
+}
+
+static void imprimirEstatisticasDispositivo() {
+    if (dispositivoAtivo == nullptr) {
+        return;
+    }
+
+    EstatisticasDispositivoArquivo estatisticas = dispositivoAtivo->obterEstatisticas();
+    fprintf(stderr,
+            "imagem: %u leituras (%llu setores), %u escritas (%llu setores), %u apagamentos, %llu us simulados\n",
+            estatisticas.comandos_leitura,
+            static_cast<unsigned long long>(estatisticas.setores_lidos),
+            estatisticas.comandos_escrita,
+            static_cast<unsigned long long>(estatisticas.setores_escritos),
+            estatisticas.comandos_apagamento,
+            static_cast<unsigned long long>(estatisticas.tempo_simulado_us));
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        imprimirUso(argv[0]);
+        return 1;
+    }
+
+    uint64_t setores_criacao = SETORES_IMAGEM_PADRAO;
+    LatenciaSimulada latencia{};
+    latencia.comando_us = 100u;
+    latencia.transferencia_setor_us = 170u;
+    latencia.ocupado_escrita_us = 700u;
+    latencia.ocupado_apagamento_us = 2000u;
+    uint32_t setores_au = 8192u;
+
+    for (int indice = 2; indice + 1 < argc; indice = indice + 2) {
+        const char *opcao = argv[indice];
+        unsigned long long valor = strtoull(argv[indice + 1], nullptr, 10);
+
+        if (strcmp(opcao, "--criar-mb") == 0) {
+            setores_criacao = valor * 2048u;
+        } else if (strcmp(opcao, "--comando-us") == 0) {
+            latencia.comando_us = static_cast<uint32_t>(valor);
+        } else if (strcmp(opcao, "--setor-us") == 0) {
+            latencia.transferencia_setor_us = static_cast<uint32_t>(valor);
+        } else if (strcmp(opcao, "--ocupado-us") == 0) {
+            latencia.ocupado_escrita_us = static_cast<uint32_t>(valor);
+        } else if (strcmp(opcao, "--apagamento-us") == 0) {
+            latencia.ocupado_apagamento_us = static_cast<uint32_t>(valor);
+        } else if (strcmp(opcao, "--au-setores") == 0) {
+            setores_au = static_cast<uint32_t>(valor);
+        } else {
+            imprimirUso(argv[0]);
+            return 1;
+        }
+    }
+
+    // Estáticos: ao fim da entrada padrão o exit() ainda desmonta o volume.
+    static DispositivoBlocoArquivo dispositivo(argv[1], setores_criacao);
+    dispositivo.definirLatencia(latencia);
+    dispositivo.definirSetoresUnidadeAlocacao(setores_au);
+    if (!dispositivo.iniciar()) {
+        fprintf(stderr, "Nao foi possivel abrir a imagem %s\n", argv[1]);
+        return 1;
+    }
+
+    static CartaoSD cartao(dispositivo);
+    static PortaSerial porta_serial(uart1, TAXA_BPS_UART, 0u, 0u);
+    porta_serial.iniciar();
+
+    dispositivoAtivo = &dispositivo;
+    atexit(imprimirEstatisticasDispositivo);
+
+    static MineBash console;
+    console.registrarPortaSerial(porta_serial);
+    console.registrarCartao(cartao);
+    console.iniciar();
+
+    while (true) {
+        console.processar();
+    }
+
+    return 0;
+}
@@ -0,0 +1,654 @@
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "BarramentoSpiHost.h"
+#include "RelogioHost.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/spi.h"
+#include "hardware/uart.h"
+#include "pico/multicore.h"
+#include "pico/mutex.h"
+#include "pico/platform.h"
+#include "pico/stdlib.h"
+#include "pico/time.h"
+
+struct spi_inst {
+    spi_hw_t registradores;
+    uint taxa_baud;
+    FuncaoTrocaByteHost trocar_byte;
+    void *contexto;
+};
+
+struct uart_inst {
+    int indice;
+};
+
+namespace {
+
+constexpr uint32_t FREQUENCIA_PERIFERICA_HZ = 125000000u;
+
+// Campos de dma_channel_config::ctrl, nas posições do CTRL_TRIG do RP2040.
+constexpr uint32_t DMA_CTRL_TAMANHO_BITS = 2u;
+constexpr uint32_t DMA_CTRL_TAMANHO_MASCARA = 0x3u << DMA_CTRL_TAMANHO_BITS;
+constexpr uint32_t DMA_CTRL_INCREMENTAR_LEITURA = 1u << 4u;
+constexpr uint32_t DMA_CTRL_INCREMENTAR_ESCRITA = 1u << 5u;
+constexpr uint32_t DMA_CTRL_DREQ_BITS = 15u;
+constexpr uint32_t DMA_CTRL_DREQ_MASCARA = 0x3Fu << DMA_CTRL_DREQ_BITS;
+constexpr uint32_t DMA_CTRL_SNIFF = 1u << 23u;
+constexpr uint DREQ_SPI0_TX = 16u;
+constexpr uint QUANTIDADE_CANAIS_DMA = 12u;
+constexpr uint MODO_SNIFFER_CRC16_CCITT = 0x2u;
+
+struct CanalDmaHost {
+    bool reservado;
+    dma_channel_config configuracao;
+    volatile void *destino;
+    const volatile void *origem;
+    uint quantidade;
+};
+
+CanalDmaHost canaisDma[QUANTIDADE_CANAIS_DMA] = {};
+uint canaisDmaDisponiveis = 0u;
+uint32_t transferenciasDma = 0u;
+uint32_t errosConfiguracaoDma = 0u;
+bool snifferHabilitado = false;
+uint canalSniffer = 0u;
+uint modoSniffer = 0u;
+uint32_t acumuladorSniffer = 0u;
+
+spi_inst spiInstancias[2] = {};
+uart_inst uartInstancias[2] = {{0}, {1}};
+std::atomic<uint64_t> tempoSimuladoUs{0u};
+thread_local uint nucleoAtual = 0u;
+// Interrupções habilitadas no NVIC de cada núcleo (bit = número da IRQ).
+std::atomic<uint32_t> irqsHabilitadas[2];
+
+// Núcleo 1 e as duas filas entre núcleos (índice = núcleo que lê).
+std::thread threadNucleo1;
+std::mutex mutexFilas;
+std::condition_variable filaAlterada;
+std::deque<uint32_t> filasNucleos[2];
+
+uint64_t obterTempoRealUs() {
+    static const std::chrono::steady_clock::time_point inicio = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::duration decorrido = std::chrono::steady_clock::now() - inicio;
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(decorrido).count());
+}
+
+bool aguardarEntrada(uint32_t tempo_limite_us) {
+    pollfd descritor{};
+    descritor.fd = STDIN_FILENO;
+    descritor.events = POLLIN;
+    int tempo_limite_ms = static_cast<int>((tempo_limite_us + 999u) / 1000u);
+    return poll(&descritor, 1, tempo_limite_ms) > 0;
+}
+
+int lerEntrada() {
+    int caractere = getchar();
+    if (caractere == EOF) {
+        // Fim da entrada padrão encerra o programa; os destrutores estáticos
+        // desmontam o volume e fecham a imagem.
+        fflush(stdout);
+        exit(0);
+    }
+    return caractere;
+}
+
+uint8_t trocarByteSpi(spi_inst_t *spi, uint8_t enviado) {
+    if (spi->trocar_byte == nullptr) {
+        return 0xFFu;
+    }
+    return spi->trocar_byte(spi->contexto, enviado);
+}
+
+uint32_t atualizarCrc16Ccitt(uint32_t crc, uint8_t dado) {
+    crc = crc ^ (static_cast<uint32_t>(dado) << 8u);
+    for (uint32_t bit = 0u; bit < 8u; bit = bit + 1u) {
+        crc = ((crc & 0x8000u) != 0u) ? ((crc << 1u) ^ 0x1021u) : (crc << 1u);
+    }
+    return crc & 0xFFFFu;
+}
+
+uint dreqDoCanal(const CanalDmaHost &canal) {
+    return (canal.configuracao.ctrl & DMA_CTRL_DREQ_MASCARA) >> DMA_CTRL_DREQ_BITS;
+}
+
+// Identifica o SPI cujo registrador de dados o canal lê ou escreve.
+spi_inst_t *spiDoRegistrador(const volatile void *endereco) {
+    for (spi_inst &instancia : spiInstancias) {
+        if (endereco == &instancia.registradores.dr) {
+            return &instancia;
+        }
+    }
+    return nullptr;
+}
+
+// Executa um par TX/RX como o DMA do RP2040 pareado por DREQ com o SPI:
+// um byte sai para o MOSI e o byte recebido no mesmo ciclo vai para o RX.
+// Qualquer campo fora do que o controlador do cartão programa é recusado.
+bool executarParDma(uint canal_tx, uint canal_rx) {
+    CanalDmaHost &tx = canaisDma[canal_tx];
+    CanalDmaHost &rx = canaisDma[canal_rx];
+    spi_inst_t *spi = spiDoRegistrador(tx.destino);
+    if (spi == nullptr || spiDoRegistrador(rx.origem) != spi) {
+        return false;
+    }
+
+    uint indice_spi = (spi == &spiInstancias[0]) ? 0u : 1u;
+    uint dreq_tx = DREQ_SPI0_TX + (indice_spi * 2u);
+    bool configuracao_valida =
+        dreqDoCanal(tx) == dreq_tx && dreqDoCanal(rx) == dreq_tx + 1u &&
+        (tx.configuracao.ctrl & DMA_CTRL_TAMANHO_MASCARA) == (DMA_SIZE_8 << DMA_CTRL_TAMANHO_BITS) &&
+        (rx.configuracao.ctrl & DMA_CTRL_TAMANHO_MASCARA) == (DMA_SIZE_8 << DMA_CTRL_TAMANHO_BITS) &&
+        (tx.configuracao.ctrl & DMA_CTRL_INCREMENTAR_ESCRITA) == 0u &&
+        (rx.configuracao.ctrl & DMA_CTRL_INCREMENTAR_LEITURA) == 0u &&
+        tx.quantidade == rx.quantidade;
+    if (!configuracao_valida) {
+        return false;
+    }
+
+    bool incrementar_origem = (tx.configuracao.ctrl & DMA_CTRL_INCREMENTAR_LEITURA) != 0u;
+    bool incrementar_destino = (rx.configuracao.ctrl & DMA_CTRL_INCREMENTAR_ESCRITA) != 0u;
+    const volatile uint8_t *origem = static_cast<const volatile uint8_t *>(tx.origem);
+    volatile uint8_t *destino = static_cast<volatile uint8_t *>(rx.destino);
+
+    bool sniffer_tx = snifferHabilitado && canalSniffer == canal_tx && (tx.configuracao.ctrl & DMA_CTRL_SNIFF) != 0u;
+    bool sniffer_rx = snifferHabilitado && canalSniffer == canal_rx && (rx.configuracao.ctrl & DMA_CTRL_SNIFF) != 0u;
+    if ((sniffer_tx || sniffer_rx) && modoSniffer != MODO_SNIFFER_CRC16_CCITT) {
+        return false;
+    }
+
+    for (uint indice = 0u; indice < tx.quantidade; indice = indice + 1u) {
+        uint8_t enviado = origem[incrementar_origem ? indice : 0u];
+        uint8_t recebido = trocarByteSpi(spi, enviado);
+        destino[incrementar_destino ? indice : 0u] = recebido;
+
+        if (sniffer_tx) {
+            acumuladorSniffer = atualizarCrc16Ccitt(acumuladorSniffer, enviado);
+        } else if (sniffer_rx) {
+            acumuladorSniffer = atualizarCrc16Ccitt(acumuladorSniffer, recebido);
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+void conectarDispositivoSpiHost(spi_inst_t *spi, FuncaoTrocaByteHost funcao, void *contexto) {
+    spi->trocar_byte = funcao;
+    spi->contexto = contexto;
+}
+
+void definirCanaisDmaHost(uint quantidade) {
+    for (CanalDmaHost &canal : canaisDma) {
+        canal = CanalDmaHost{};
+    }
+    canaisDmaDisponiveis = (quantidade < QUANTIDADE_CANAIS_DMA) ? quantidade : QUANTIDADE_CANAIS_DMA;
+}
+
+uint32_t obterTransferenciasDmaHost() {
+    return transferenciasDma;
+}
+
+uint32_t obterErrosConfiguracaoDmaHost() {
+    return errosConfiguracaoDma;
+}
+
+void avancarRelogioHost(uint64_t atraso_us) {
+    tempoSimuladoUs.fetch_add(atraso_us);
+}
+
+uint64_t obterTempoSimuladoHost() {
+    return tempoSimuladoUs;
+}
+
+extern "C" {
+
+spi_inst_t *const spi0 = &spiInstancias[0];
+spi_inst_t *const spi1 = &spiInstancias[1];
+uart_inst_t *const uart0 = &uartInstancias[0];
+uart_inst_t *const uart1 = &uartInstancias[1];
+
+void __wfe(void) {}
+void __sev(void) {}
+
+uint get_core_num(void) {
+    return nucleoAtual;
+}
+
+uint64_t time_us_64(void) {
+    return obterTempoRealUs() + tempoSimuladoUs;
+}
+
+uint32_t time_us_32(void) {
+    return static_cast<uint32_t>(time_us_64());
+}
+
+absolute_time_t get_absolute_time(void) {
+    return time_us_64();
+}
+
+absolute_time_t make_timeout_time_us(uint64_t atraso_us) {
+    return time_us_64() + atraso_us;
+}
+
+absolute_time_t make_timeout_time_ms(uint32_t atraso_ms) {
+    return time_us_64() + (static_cast<uint64_t>(atraso_ms) * 1000u);
+}
+
+int64_t absolute_time_diff_us(absolute_time_t de, absolute_time_t ate) {
+    return static_cast<int64_t>(ate - de);
+}
+
+uint64_t to_us_since_boot(absolute_time_t tempo) {
+    return tempo;
+}
+
+bool time_reached(absolute_time_t tempo) {
+    return time_us_64() >= tempo;
+}
+
+void sleep_us(uint64_t atraso_us) {
+    avancarRelogioHost(atraso_us);
+}
+
+void sleep_ms(uint32_t atraso_ms) {
+    avancarRelogioHost(static_cast<uint64_t>(atraso_ms) * 1000u);
+}
+
+bool best_effort_wfe_or_timeout(absolute_time_t tempo_limite) {
+    // Sem eventos no host, o WFE dorme até o prazo.
+    uint64_t agora = time_us_64();
+    if (agora < tempo_limite) {
+        avancarRelogioHost(tempo_limite - agora);
+    }
+    return true;
+}
+
+void mutex_init(mutex_t *mutex) {
+    pthread_mutex_init(&mutex->trava, nullptr);
+}
+
+void mutex_enter_blocking(mutex_t *mutex) {
+    pthread_mutex_lock(&mutex->trava);
+}
+
+bool mutex_enter_timeout_ms(mutex_t *mutex, uint32_t tempo_limite_ms) {
+    timespec prazo{};
+    clock_gettime(CLOCK_REALTIME, &prazo);
+    prazo.tv_sec = prazo.tv_sec + static_cast<time_t>(tempo_limite_ms / 1000u);
+    prazo.tv_nsec = prazo.tv_nsec + static_cast<long>((tempo_limite_ms % 1000u) * 1000000u);
+    if (prazo.tv_nsec >= 1000000000L) {
+        prazo.tv_sec = prazo.tv_sec + 1;
+        prazo.tv_nsec = prazo.tv_nsec - 1000000000L;
+    }
+    return pthread_mutex_timedlock(&mutex->trava, &prazo) == 0;
+}
+
+void mutex_exit(mutex_t *mutex) {
+    pthread_mutex_unlock(&mutex->trava);
+}
+
+void recursive_mutex_init(recursive_mutex_t *mutex) {
+    pthread_mutexattr_t atributos;
+    pthread_mutexattr_init(&atributos);
+    pthread_mutexattr_settype(&atributos, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&mutex->trava, &atributos);
+    pthread_mutexattr_destroy(&atributos);
+}
+
+void recursive_mutex_enter_blocking(recursive_mutex_t *mutex) {
+    pthread_mutex_lock(&mutex->trava);
+}
+
+void recursive_mutex_exit(recursive_mutex_t *mutex) {
+    pthread_mutex_unlock(&mutex->trava);
+}
+
+void multicore_launch_core1(void (*entrada)(void)) {
+    multicore_reset_core1();
+    threadNucleo1 = std::thread([entrada]() {
+        nucleoAtual = 1u;
+        entrada();
+    });
+}
+
+void multicore_launch_core1_with_stack(void (*entrada)(void), uint32_t *base_pilha, size_t tamanho_pilha) {
+    // A thread usa a pilha do sistema.
+    (void)base_pilha;
+    (void)tamanho_pilha;
+    multicore_launch_core1(entrada);
+}
+
+void multicore_reset_core1(void) {
+    // Não há como parar uma thread de fora: espera a entrada do núcleo 1 retornar.
+    if (threadNucleo1.joinable()) {
+        threadNucleo1.join();
+    }
+    // Como no RP2040, o reset do núcleo 1 limpa o NVIC dele.
+    irqsHabilitadas[1] = 0u;
+    std::lock_guard<std::mutex> trava(mutexFilas);
+    filasNucleos[0].clear();
+    filasNucleos[1].clear();
+}
+
+void multicore_fifo_push_blocking(uint32_t valor) {
+    std::lock_guard<std::mutex> trava(mutexFilas);
+    filasNucleos[nucleoAtual == 0u ? 1u : 0u].push_back(valor);
+    filaAlterada.notify_all();
+}
+
+uint32_t multicore_fifo_pop_blocking(void) {
+    std::unique_lock<std::mutex> trava(mutexFilas);
+    std::deque<uint32_t> &fila = filasNucleos[nucleoAtual];
+    filaAlterada.wait(trava, [&fila]() { return !fila.empty(); });
+    uint32_t valor = fila.front();
+    fila.pop_front();
+    return valor;
+}
+
+bool stdio_init_all(void) {
+    return true;
+}
+
+void stdio_uart_init_full(uart_inst_t *uart, uint taxa_baud, int pino_tx, int pino_rx) {
+    (void)uart;
+    (void)taxa_baud;
+    (void)pino_tx;
+    (void)pino_rx;
+}
+
+void stdio_uart_deinit(void) {}
+
+int getchar_timeout_us(uint32_t tempo_limite_us) {
+    fflush(stdout);
+    if (!aguardarEntrada(tempo_limite_us)) {
+        return PICO_ERROR_TIMEOUT;
+    }
+    return lerEntrada();
+}
+
+void gpio_init(uint gpio) {
+    (void)gpio;
+}
+
+void gpio_set_dir(uint gpio, bool saida) {
+    (void)gpio;
+    (void)saida;
+}
+
+void gpio_put(uint gpio, bool valor) {
+    (void)gpio;
+    (void)valor;
+}
+
+bool gpio_get(uint gpio) {
+    (void)gpio;
+    return true;
+}
+
+void gpio_set_function(uint gpio, enum gpio_function funcao) {
+    (void)gpio;
+    (void)funcao;
+}
+
+void gpio_pull_up(uint gpio) {
+    (void)gpio;
+}
+
+void gpio_set_irq_enabled(uint gpio, uint32_t eventos, bool habilitar) {
+    (void)gpio;
+    (void)eventos;
+    (void)habilitar;
+}
+
+void gpio_add_raw_irq_handler(uint gpio, void (*tratador)(void)) {
+    (void)gpio;
+    (void)tratador;
+}
+
+uint32_t gpio_get_irq_event_mask(uint gpio) {
+    (void)gpio;
+    return 0u;
+}
+
+void gpio_acknowledge_irq(uint gpio, uint32_t eventos) {
+    (void)gpio;
+    (void)eventos;
+}
+
+void irq_set_enabled(uint numero, bool habilitar) {
+    uint32_t mascara = 1u << numero;
+    if (habilitar) {
+        irqsHabilitadas[nucleoAtual] |= mascara;
+    } else {
+        irqsHabilitadas[nucleoAtual] &= ~mascara;
+    }
+}
+
+bool irq_is_enabled(uint numero) {
+    return (irqsHabilitadas[nucleoAtual] & (1u << numero)) != 0u;
+}
+
+uint32_t clock_get_hz(enum clock_index relogio) {
+    (void)relogio;
+    return FREQUENCIA_PERIFERICA_HZ;
+}
+
+uint spi_init(spi_inst_t *spi, uint taxa_baud) {
+    return spi_set_baudrate(spi, taxa_baud);
+}
+
+uint spi_set_baudrate(spi_inst_t *spi, uint taxa_baud) {
+    spi->taxa_baud = taxa_baud;
+    return taxa_baud;
+}
+
+void spi_set_format(spi_inst_t *spi, uint bits, enum spi_cpol_t cpol, enum spi_cpha_t cpha, enum spi_order_t ordem) {
+    (void)spi;
+    (void)bits;
+    (void)cpol;
+    (void)cpha;
+    (void)ordem;
+}
+
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *origem, size_t tamanho) {
+    for (size_t indice = 0u; indice < tamanho; indice = indice + 1u) {
+        (void)trocarByteSpi(spi, origem[indice]);
+    }
+    return static_cast<int>(tamanho);
+}
+
+int spi_read_blocking(spi_inst_t *spi, uint8_t repetido, uint8_t *destino, size_t tamanho) {
+    for (size_t indice = 0u; indice < tamanho; indice = indice + 1u) {
+        destino[indice] = trocarByteSpi(spi, repetido);
+    }
+    return static_cast<int>(tamanho);
+}
+
+int spi_write_read_blocking(spi_inst_t *spi, const uint8_t *origem, uint8_t *destino, size_t tamanho) {
+    for (size_t indice = 0u; indice < tamanho; indice = indice + 1u) {
+        destino[indice] = trocarByteSpi(spi, origem[indice]);
+    }
+    return static_cast<int>(tamanho);
+}
+
+bool spi_is_readable(const spi_inst_t *spi) {
+    (void)spi;
+    return false;
+}
+
+spi_hw_t *spi_get_hw(spi_inst_t *spi) {
+    return &spi->registradores;
+}
+
+uint spi_get_dreq(spi_inst_t *spi, bool transmissao) {
+    uint indice_spi = (spi == spi1) ? 1u : 0u;
+    return DREQ_SPI0_TX + (indice_spi * 2u) + (transmissao ? 0u : 1u);
+}
+
+int dma_claim_unused_channel(bool obrigatorio) {
+    for (uint canal = 0u; canal < canaisDmaDisponiveis; canal = canal + 1u) {
+        if (!canaisDma[canal].reservado) {
+            canaisDma[canal].reservado = true;
+            return static_cast<int>(canal);
+        }
+    }
+
+    if (obrigatorio) {
+        fprintf(stderr, "DMA indisponivel no host\n");
+        abort();
+    }
+    return -1;
+}
+
+void dma_channel_unclaim(uint canal) {
+    canaisDma[canal].reservado = false;
+}
+
+dma_channel_config dma_channel_get_default_config(uint canal) {
+    // Padrão do SDK: 32 bits, lê incrementando, escreve fixo, sem DREQ (0x3F).
+    (void)canal;
+    return dma_channel_config{(DMA_SIZE_32 << DMA_CTRL_TAMANHO_BITS) | DMA_CTRL_INCREMENTAR_LEITURA | DMA_CTRL_DREQ_MASCARA};
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *configuracao, enum dma_channel_transfer_size tamanho) {
+    configuracao->ctrl = (configuracao->ctrl & ~DMA_CTRL_TAMANHO_MASCARA) | (static_cast<uint32_t>(tamanho) << DMA_CTRL_TAMANHO_BITS);
+}
+
+void channel_config_set_read_increment(dma_channel_config *configuracao, bool incrementar) {
+    configuracao->ctrl = incrementar ? (configuracao->ctrl | DMA_CTRL_INCREMENTAR_LEITURA)
+                                     : (configuracao->ctrl & ~DMA_CTRL_INCREMENTAR_LEITURA);
+}
+
+void channel_config_set_write_increment(dma_channel_config *configuracao, bool incrementar) {
+    configuracao->ctrl = incrementar ? (configuracao->ctrl | DMA_CTRL_INCREMENTAR_ESCRITA)
+                                     : (configuracao->ctrl & ~DMA_CTRL_INCREMENTAR_ESCRITA);
+}
+
+void channel_config_set_dreq(dma_channel_config *configuracao, uint dreq) {
+    configuracao->ctrl = (configuracao->ctrl & ~DMA_CTRL_DREQ_MASCARA) | ((dreq << DMA_CTRL_DREQ_BITS) & DMA_CTRL_DREQ_MASCARA);
+}
+
+void channel_config_set_sniff_enable(dma_channel_config *configuracao, bool habilitar) {
+    configuracao->ctrl = habilitar ? (configuracao->ctrl | DMA_CTRL_SNIFF) : (configuracao->ctrl & ~DMA_CTRL_SNIFF);
+}
+
+void dma_channel_configure(uint canal, const dma_channel_config *configuracao, volatile void *destino,
+                           const volatile void *origem, uint quantidade, bool iniciar) {
+    CanalDmaHost &registro = canaisDma[canal];
+    registro.configuracao = *configuracao;
+    registro.destino = destino;
+    registro.origem = origem;
+    registro.quantidade = quantidade;
+    if (iniciar) {
+        dma_start_channel_mask(1u << canal);
+    }
+}
+
+void dma_start_channel_mask(uint32_t mascara) {
+    // O controlador sempre dispara o par TX/RX junto; o canal que escreve no
+    // registrador de dados do SPI é o TX.
+    int canal_tx = -1;
+    int canal_rx = -1;
+    for (uint canal = 0u; canal < QUANTIDADE_CANAIS_DMA; canal = canal + 1u) {
+        if ((mascara & (1u << canal)) == 0u) {
+            continue;
+        }
+        if (!canaisDma[canal].reservado) {
+            canal_tx = -1;
+            break;
+        }
+        if (spiDoRegistrador(canaisDma[canal].destino) != nullptr) {
+            canal_tx = static_cast<int>(canal);
+        } else {
+            canal_rx = static_cast<int>(canal);
+        }
+    }
+
+    if (canal_tx < 0 || canal_rx < 0 ||
+        !executarParDma(static_cast<uint>(canal_tx), static_cast<uint>(canal_rx))) {
+        errosConfiguracaoDma = errosConfiguracaoDma + 1u;
+        return;
+    }
+
+    transferenciasDma = transferenciasDma + 1u;
+}
+
+void dma_channel_wait_for_finish_blocking(uint canal) {
+    // A transferência termina dentro de dma_start_channel_mask.
+    (void)canal;
+}
+
+void dma_sniffer_enable(uint canal, uint modo, bool forcar) {
+    (void)forcar;
+    snifferHabilitado = true;
+    canalSniffer = canal;
+    modoSniffer = modo;
+}
+
+void dma_sniffer_disable(void) {
+    snifferHabilitado = false;
+}
+
+void dma_sniffer_set_data_accumulator(uint32_t valor) {
+    acumuladorSniffer = valor;
+}
+
+uint32_t dma_sniffer_get_data_accumulator(void) {
+    return acumuladorSniffer;
+}
+
+bool uart_is_writable(uart_inst_t *uart) {
+    (void)uart;
+    return true;
+}
+
+bool uart_is_readable(uart_inst_t *uart) {
+    (void)uart;
+    return aguardarEntrada(0u);
+}
+
+bool uart_is_readable_within_us(uart_inst_t *uart, uint32_t tempo_limite_us) {
+    (void)uart;
+    return aguardarEntrada(tempo_limite_us);
+}
+
+void uart_putc_raw(uart_inst_t *uart, char caractere) {
+    (void)uart;
+    // O console envia "\r\n"; no terminal do host basta o "\n".
+    if (caractere != '\r') {
+        putchar(caractere);
+    }
+}
+
+void uart_write_blocking(uart_inst_t *uart, const uint8_t *origem, size_t quantidade) {
+    for (size_t indice = 0u; indice < quantidade; indice = indice + 1u) {
+        uart_putc_raw(uart, static_cast<char>(origem[indice]));
+    }
+}
+
+char uart_getc(uart_inst_t *uart) {
+    (void)uart;
+    return static_cast<char>(lerEntrada());
+}
+
+void uart_deinit(uart_inst_t *uart) {
+    (void)uart;
+}
+
+} // extern "C"
@@ -0,0 +1,21 @@
+#ifndef PICO_HOST_CLOCKS_H
+#define PICO_HOST_CLOCKS_H
+
+#include "pico/types.h"
+
+enum clock_index {
+    clk_sys = 5,
+    clk_peri = 6
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t clock_get_hz(enum clock_index relogio);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
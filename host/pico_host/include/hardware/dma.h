@@ -0,0 +1,44 @@
+#ifndef PICO_HOST_DMA_H
+#define PICO_HOST_DMA_H
+
+#include "pico/types.h"
+
+// Nenhum canal fica disponível no host até definirCanaisDmaHost (BarramentoSpiHost.h);
+// sem canais o controlador usa o caminho bloqueante.
+
+typedef struct {
+    uint32_t ctrl;
+} dma_channel_config;
+
+enum dma_channel_transfer_size {
+    DMA_SIZE_8 = 0,
+    DMA_SIZE_16 = 1,
+    DMA_SIZE_32 = 2
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int dma_claim_unused_channel(bool obrigatorio);
+void dma_channel_unclaim(uint canal);
+dma_channel_config dma_channel_get_default_config(uint canal);
+void channel_config_set_transfer_data_size(dma_channel_config *configuracao, enum dma_channel_transfer_size tamanho);
+void channel_config_set_read_increment(dma_channel_config *configuracao, bool incrementar);
+void channel_config_set_write_increment(dma_channel_config *configuracao, bool incrementar);
+void channel_config_set_dreq(dma_channel_config *configuracao, uint dreq);
+void channel_config_set_sniff_enable(dma_channel_config *configuracao, bool habilitar);
+void dma_channel_configure(uint canal, const dma_channel_config *configuracao, volatile void *destino,
+                           const volatile void *origem, uint quantidade, bool iniciar);
+void dma_start_channel_mask(uint32_t mascara);
+void dma_channel_wait_for_finish_blocking(uint canal);
+void dma_sniffer_enable(uint canal, uint modo, bool forcar);
+void dma_sniffer_disable(void);
+void dma_sniffer_set_data_accumulator(uint32_t valor);
+uint32_t dma_sniffer_get_data_accumulator(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
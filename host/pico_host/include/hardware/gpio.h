@@ -0,0 +1,41 @@
+#ifndef PICO_HOST_GPIO_H
+#define PICO_HOST_GPIO_H
+
+#include "pico/types.h"
+
+#define GPIO_OUT 1
+#define GPIO_IN 0
+
+enum gpio_function {
+    GPIO_FUNC_SPI = 1,
+    GPIO_FUNC_UART = 2,
+    GPIO_FUNC_SIO = 5
+};
+
+enum gpio_irq_level {
+    GPIO_IRQ_LEVEL_LOW = 0x1u,
+    GPIO_IRQ_LEVEL_HIGH = 0x2u,
+    GPIO_IRQ_EDGE_FALL = 0x4u,
+    GPIO_IRQ_EDGE_RISE = 0x8u
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void gpio_init(uint gpio);
+void gpio_set_dir(uint gpio, bool saida);
+void gpio_put(uint gpio, bool valor);
+bool gpio_get(uint gpio);
+void gpio_set_function(uint gpio, enum gpio_function funcao);
+void gpio_pull_up(uint gpio);
+void gpio_set_irq_enabled(uint gpio, uint32_t eventos, bool habilitar);
+void gpio_add_raw_irq_handler(uint gpio, void (*tratador)(void));
+uint32_t gpio_get_irq_event_mask(uint gpio);
+void gpio_acknowledge_irq(uint gpio, uint32_t eventos);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef PICO_HOST_IRQ_H
+#define PICO_HOST_IRQ_H
+
+#include "pico/types.h"
+
+#define IO_IRQ_BANK0 13
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void irq_set_enabled(uint numero, bool habilitar);
+bool irq_is_enabled(uint numero);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef PICO_HOST_SPI_H
+#define PICO_HOST_SPI_H
+
+#include "pico/types.h"
+
+// Sem cartão físico o barramento devolve 0xFF como um MISO em repouso, a menos
+// que um dispositivo seja ligado por conectarDispositivoSpiHost (BarramentoSpiHost.h).
+
+typedef struct {
+    volatile uint32_t cr0;
+    volatile uint32_t cr1;
+    volatile uint32_t dr;
+    volatile uint32_t sr;
+    volatile uint32_t cpsr;
+} spi_hw_t;
+
+typedef struct spi_inst spi_inst_t;
+
+enum spi_cpol_t { SPI_CPOL_0 = 0, SPI_CPOL_1 = 1 };
+enum spi_cpha_t { SPI_CPHA_0 = 0, SPI_CPHA_1 = 1 };
+enum spi_order_t { SPI_LSB_FIRST = 0, SPI_MSB_FIRST = 1 };
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern spi_inst_t *const spi0;
+extern spi_inst_t *const spi1;
+
+uint spi_init(spi_inst_t *spi, uint taxa_baud);
+uint spi_set_baudrate(spi_inst_t *spi, uint taxa_baud);
+void spi_set_format(spi_inst_t *spi, uint bits, enum spi_cpol_t cpol, enum spi_cpha_t cpha, enum spi_order_t ordem);
+int spi_write_blocking(spi_inst_t *spi, const uint8_t *origem, size_t tamanho);
+int spi_read_blocking(spi_inst_t *spi, uint8_t repetido, uint8_t *destino, size_t tamanho);
+int spi_write_read_blocking(spi_inst_t *spi, const uint8_t *origem, uint8_t *destino, size_t tamanho);
+bool spi_is_readable(const spi_inst_t *spi);
+spi_hw_t *spi_get_hw(spi_inst_t *spi);
+uint spi_get_dreq(spi_inst_t *spi, bool transmissao);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef PICO_HOST_UART_H
+#define PICO_HOST_UART_H
+
+#include "pico/types.h"
+
+// A UART do console é ligada à entrada e à saída padrão do processo.
+
+typedef struct uart_inst uart_inst_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern uart_inst_t *const uart0;
+extern uart_inst_t *const uart1;
+
+bool uart_is_writable(uart_inst_t *uart);
+bool uart_is_readable(uart_inst_t *uart);
+bool uart_is_readable_within_us(uart_inst_t *uart, uint32_t tempo_limite_us);
+void uart_putc_raw(uart_inst_t *uart, char caractere);
+void uart_write_blocking(uart_inst_t *uart, const uint8_t *origem, size_t quantidade);
+char uart_getc(uart_inst_t *uart);
+void uart_deinit(uart_inst_t *uart);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef PICO_HOST_MULTICORE_H
+#define PICO_HOST_MULTICORE_H
+
+#include "pico/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// O núcleo 1 roda em uma thread própria, na qual get_core_num() devolve 1.
+void multicore_launch_core1(void (*entrada)(void));
+void multicore_launch_core1_with_stack(void (*entrada)(void), uint32_t *base_pilha, size_t tamanho_pilha);
+void multicore_reset_core1(void);
+void multicore_fifo_push_blocking(uint32_t valor);
+uint32_t multicore_fifo_pop_blocking(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef PICO_HOST_MUTEX_H
+#define PICO_HOST_MUTEX_H
+
+#include <pthread.h>
+
+#include "pico/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Os dois núcleos do host são threads; as travas viram mutexes POSIX.
+typedef struct {
+    pthread_mutex_t trava;
+} mutex_t;
+
+typedef struct {
+    pthread_mutex_t trava;
+} recursive_mutex_t;
+
+#define auto_init_mutex(nome) static mutex_t nome = {PTHREAD_MUTEX_INITIALIZER}
+
+void mutex_init(mutex_t *mutex);
+void mutex_enter_blocking(mutex_t *mutex);
+bool mutex_enter_timeout_ms(mutex_t *mutex, uint32_t tempo_limite_ms);
+void mutex_exit(mutex_t *mutex);
+
+void recursive_mutex_init(recursive_mutex_t *mutex);
+void recursive_mutex_enter_blocking(recursive_mutex_t *mutex);
+void recursive_mutex_exit(recursive_mutex_t *mutex);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
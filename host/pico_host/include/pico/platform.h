@@ -0,0 +1,21 @@
+#ifndef PICO_HOST_PLATFORM_H
+#define PICO_HOST_PLATFORM_H
+
+#include "pico/types.h"
+
+#define PICO_ERROR_TIMEOUT (-1)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static inline void tight_loop_contents(void) {}
+void __wfe(void);
+void __sev(void);
+uint get_core_num(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef PICO_HOST_STDLIB_H
+#define PICO_HOST_STDLIB_H
+
+#include <stdio.h>
+
+#include "hardware/gpio.h"
+#include "hardware/uart.h"
+#include "pico/platform.h"
+#include "pico/time.h"
+#include "pico/types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool stdio_init_all(void);
+void stdio_uart_init_full(uart_inst_t *uart, uint taxa_baud, int pino_tx, int pino_rx);
+void stdio_uart_deinit(void);
+int getchar_timeout_us(uint32_t tempo_limite_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef PICO_HOST_TIME_H
+#define PICO_HOST_TIME_H
+
+#include "pico/types.h"
+
+// O relógio do host é o tempo monotônico real somado ao tempo simulado:
+// as esperas (sleep_*, WFE) e as latências de DispositivoBlocoArquivo
+// avançam o relógio sem bloquear o processo.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint64_t time_us_64(void);
+uint32_t time_us_32(void);
+absolute_time_t get_absolute_time(void);
+absolute_time_t make_timeout_time_us(uint64_t atraso_us);
+absolute_time_t make_timeout_time_ms(uint32_t atraso_ms);
+int64_t absolute_time_diff_us(absolute_time_t de, absolute_time_t ate);
+uint64_t to_us_since_boot(absolute_time_t tempo);
+bool time_reached(absolute_time_t tempo);
+void sleep_us(uint64_t atraso_us);
+void sleep_ms(uint32_t atraso_ms);
+bool best_effort_wfe_or_timeout(absolute_time_t tempo_limite);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef PICO_HOST_TYPES_H
+#define PICO_HOST_TYPES_H
+
+// Emulação mínima do Pico SDK para a compilação no Linux (MINEBASH_HOST).
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t;
+
+#endif
@@ -0,0 +1,177 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "CacheSetores.h"
+#include "DispositivoBlocoArquivo.h"
+
+// Confere o CacheSetores sobre uma imagem temporária: acertos, falhas e
+// despejos do LRU, a escrita adiada gravada só no sincronizar e a coerência
+// das linhas depois de escritas de vários setores, inclusive quando o
+// dispositivo falha com parte da sequência já gravada.
+
+using cartao_sd::CacheSetores;
+using cartao_sd::EstatisticasCache;
+using cartao_sd::PoliticaCache;
+using cartao_sd::TAMANHO_SETOR_DISPOSITIVO;
+
+static constexpr const char *CAMINHO_IMAGEM = "teste_cache.img";
+static constexpr uint64_t SETORES_IMAGEM = 256u;
+static constexpr uint32_t SETORES_SEQUENCIA = 4u;
+
+// Imagem que pode falhar a próxima escrita de vários setores depois de gravar
+// só a primeira metade, como um CMD25 interrompido.
+class DispositivoFalhaParcial : public DispositivoBlocoArquivo {
+public:
+    DispositivoFalhaParcial() : DispositivoBlocoArquivo(CAMINHO_IMAGEM, SETORES_IMAGEM), falharProxima(false) {}
+
+    bool escreverSetores(const uint8_t *origem, uint32_t setor_inicial, uint32_t quantidade) override {
+        if (falharProxima && quantidade > 1u) {
+            falharProxima = false;
+            DispositivoBlocoArquivo::escreverSetores(origem, setor_inicial, quantidade / 2u);
+            return false;
+        }
+        return DispositivoBlocoArquivo::escreverSetores(origem, setor_inicial, quantidade);
+    }
+
+    bool falharProxima;
+};
+
+static uint32_t falhas = 0u;
+
+static void conferir(bool condicao, const char *descricao) {
+    if (!condicao) {
+        printf("FALHA: %s\n", descricao);
+        falhas = falhas + 1u;
+    }
+}
+
+static void preencherSetor(uint8_t *destino, uint32_t setor, uint8_t versao) {
+    for (size_t indice = 0u; indice < TAMANHO_SETOR_DISPOSITIVO; indice = indice + 1u) {
+        destino[indice] = static_cast<uint8_t>((setor * 7u) + (indice * 13u) + (versao * 101u));
+    }
+}
+
+static bool setorTemVersao(DispositivoBlocoArquivo &dispositivo, uint32_t setor, uint8_t versao) {
+    uint8_t lido[TAMANHO_SETOR_DISPOSITIVO];
+    uint8_t esperado[TAMANHO_SETOR_DISPOSITIVO];
+    preencherSetor(esperado, setor, versao);
+    return dispositivo.lerSetores(lido, setor, 1u) && memcmp(lido, esperado, sizeof(lido)) == 0;
+}
+
+static bool cacheTemVersao(CacheSetores &cache, uint32_t setor, uint8_t versao) {
+    uint8_t lido[TAMANHO_SETOR_DISPOSITIVO];
+    uint8_t esperado[TAMANHO_SETOR_DISPOSITIVO];
+    preencherSetor(esperado, setor, versao);
+    return cache.lerSetores(lido, setor, 1u) && memcmp(lido, esperado, sizeof(lido)) == 0;
+}
+
+static void testarLru(DispositivoBlocoArquivo &dispositivo, CacheSetores &cache) {
+    cache.zerarEstatisticas();
+    dispositivo.zerarEstatisticas();
+
+    conferir(cacheTemVersao(cache, 0u, 0u), "primeira leitura");
+    conferir(cacheTemVersao(cache, 0u, 0u), "segunda leitura");
+    EstatisticasCache estatisticas = cache.obterEstatisticas();
+    conferir(estatisticas.falhas == 1u && estatisticas.acertos == 1u, "falha e acerto");
+    conferir(dispositivo.obterEstatisticas().comandos_leitura == 1u, "acerto sem ler o dispositivo");
+
+    // Enche as linhas restantes e mais uma: o setor 0 é o menos usado.
+    for (uint32_t setor = 1u; setor <= CARTAO_SD_LINHAS_CACHE; setor = setor + 1u) {
+        conferir(cacheTemVersao(cache, setor, 0u), "leitura para despejo");
+    }
+    estatisticas = cache.obterEstatisticas();
+    conferir(estatisticas.despejos == 1u, "um despejo");
+
+    uint32_t leituras_antes = dispositivo.obterEstatisticas().comandos_leitura;
+    conferir(cacheTemVersao(cache, CARTAO_SD_LINHAS_CACHE, 0u), "linha mais recente");
+    conferir(dispositivo.obterEstatisticas().comandos_leitura == leituras_antes, "linha mais recente no cache");
+    conferir(cacheTemVersao(cache, 0u, 0u), "linha despejada");
+    conferir(dispositivo.obterEstatisticas().comandos_leitura == leituras_antes + 1u, "linha despejada relida");
+}
+
+static void testarEscritaAdiada(DispositivoBlocoArquivo &dispositivo, CacheSetores &cache) {
+    static constexpr uint32_t SETOR = 40u;
+    uint8_t dados[TAMANHO_SETOR_DISPOSITIVO];
+    preencherSetor(dados, SETOR, 1u);
+
+    cache.definirPolitica(PoliticaCache::EscritaAdiada);
+    cache.zerarEstatisticas();
+    dispositivo.zerarEstatisticas();
+
+    conferir(cache.escreverSetores(dados, SETOR, 1u), "escrita adiada");
+    conferir(dispositivo.obterEstatisticas().comandos_escrita == 0u, "escrita adiada fica no cache");
+    conferir(cacheTemVersao(cache, SETOR, 1u), "escrita adiada lida do cache");
+    conferir(setorTemVersao(dispositivo, SETOR, 0u), "imagem antes do sincronizar");
+
+    conferir(cache.sincronizar(), "sincronizar");
+    conferir(cache.obterEstatisticas().descargas == 1u, "uma descarga");
+    conferir(setorTemVersao(dispositivo, SETOR, 1u), "imagem depois do sincronizar");
+}
+
+// Linha limpa no primeiro setor e suja no segundo de uma sequência de quatro.
+static void prepararLinhas(CacheSetores &cache, uint32_t setor_inicial) {
+    uint8_t dados[TAMANHO_SETOR_DISPOSITIVO];
+    conferir(cacheTemVersao(cache, setor_inicial, 0u), "linha limpa");
+    preencherSetor(dados, setor_inicial + 1u, 1u);
+    conferir(cache.escreverSetores(dados, setor_inicial + 1u, 1u), "linha suja");
+}
+
+static void escreverSequencia(CacheSetores &cache, uint32_t setor_inicial, uint8_t versao, bool esperado) {
+    uint8_t sequencia[SETORES_SEQUENCIA * TAMANHO_SETOR_DISPOSITIVO];
+    for (uint32_t indice = 0u; indice < SETORES_SEQUENCIA; indice = indice + 1u) {
+        preencherSetor(&sequencia[indice * TAMANHO_SETOR_DISPOSITIVO], setor_inicial + indice, versao);
+    }
+    conferir(cache.escreverSetores(sequencia, setor_inicial, SETORES_SEQUENCIA) == esperado, "escrita de varios setores");
+}
+
+static void testarCoerencia(DispositivoFalhaParcial &dispositivo, CacheSetores &cache) {
+    static constexpr uint32_t SETOR_SUCESSO = 60u;
+    static constexpr uint32_t SETOR_FALHA = 80u;
+
+    cache.definirPolitica(PoliticaCache::EscritaAdiada);
+
+    prepararLinhas(cache, SETOR_SUCESSO);
+    escreverSequencia(cache, SETOR_SUCESSO, 2u, true);
+    conferir(cacheTemVersao(cache, SETOR_SUCESSO, 2u), "linha limpa atualizada");
+    conferir(cacheTemVersao(cache, SETOR_SUCESSO + 1u, 2u), "linha suja atualizada");
+    conferir(cache.sincronizar(), "sincronizar apos sequencia");
+    conferir(setorTemVersao(dispositivo, SETOR_SUCESSO + 1u, 2u), "linha suja nao sobrescreve a sequencia");
+
+    // Falha com os dois primeiros setores já gravados: a linha suja precisa
+    // levar os dados novos, não os antigos, quando for descarregada.
+    prepararLinhas(cache, SETOR_FALHA);
+    dispositivo.falharProxima = true;
+    escreverSequencia(cache, SETOR_FALHA, 2u, false);
+    conferir(cacheTemVersao(cache, SETOR_FALHA, 2u), "linha limpa relida apos falha");
+    conferir(cacheTemVersao(cache, SETOR_FALHA + 1u, 2u), "linha suja atualizada apos falha");
+    conferir(cache.sincronizar(), "sincronizar apos falha");
+    conferir(setorTemVersao(dispositivo, SETOR_FALHA + 1u, 2u), "linha suja nao volta ao conteudo antigo");
+}
+
+int main() {
+    remove(CAMINHO_IMAGEM);
+    DispositivoFalhaParcial dispositivo;
+    if (!dispositivo.iniciar()) {
+        printf("FALHA: imagem %s\n", CAMINHO_IMAGEM);
+        return 1;
+    }
+
+    uint8_t setor[TAMANHO_SETOR_DISPOSITIVO];
+    for (uint32_t indice = 0u; indice < SETORES_IMAGEM; indice = indice + 1u) {
+        preencherSetor(setor, indice, 0u);
+        dispositivo.escreverSetores(setor, indice, 1u);
+    }
+
+    {
+        CacheSetores cache(dispositivo);
+        conferir(cache.iniciar(), "iniciar");
+        testarLru(dispositivo, cache);
+        testarEscritaAdiada(dispositivo, cache);
+        testarCoerencia(dispositivo, cache);
+    }
+
+    remove(CAMINHO_IMAGEM);
+    printf("cache de setores: %u falhas\n", falhas);
+    return (falhas == 0u) ? 0 : 1;
+}
@@ -0,0 +1,298 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+#include "BarramentoSpiHost.h"
+#include "ControladorSpiCartao.h"
+#include "CrcCartaoSd.h"
+#include "DriverCartaoSd.h"
+#include "SimuladorCartaoSpi.h"
+
+// Confere o caminho DMA do ControladorSpiCartao contra o caminho bloqueante:
+// o mesmo tráfego roda com dois canais DMA emulados e sem nenhum, e os bytes
+// que passam pelo MOSI e pelo MISO precisam sair idênticos. A emulação do DMA
+// em pico_host recusa qualquer canal que não seja o par TX/RX de 8 bits
+// pareado por DREQ com o registrador de dados do SPI.
+
+using cartao_sd::ControladorSpiCartao;
+using cartao_sd::DispositivoBloco;
+using cartao_sd::DriverCartaoSd;
+using cartao_sd::TAMANHO_SETOR_DISPOSITIVO;
+
+static constexpr uint32_t FREQUENCIA_BAIXA_HZ = 400000u;
+static constexpr uint32_t FREQUENCIA_ALTA_HZ = 12500000u;
+static constexpr uint32_t SETORES_MEMORIA = 8192u;
+static constexpr uint32_t SETOR_INICIAL_TESTE = 100u;
+static constexpr uint32_t SETORES_TESTE = 8u;
+
+struct ByteTrocado {
+    uint8_t mosi;
+    uint8_t miso;
+
+    bool operator==(const ByteTrocado &outro) const {
+        return mosi == outro.mosi && miso == outro.miso;
+    }
+};
+
+// Registra cada byte trocado e responde com o dispositivo da vez: um gerador
+// pseudoaleatório que também depende do MOSI ou o modelo do cartão.
+struct MonitorBarramento {
+    std::vector<ByteTrocado> trafego;
+    SimuladorCartaoSpi *simulador;
+    uint32_t estadoGerador;
+};
+
+static uint8_t trocarByteMonitor(void *contexto, uint8_t enviado) {
+    MonitorBarramento *monitor = static_cast<MonitorBarramento *>(contexto);
+    uint8_t recebido = 0u;
+    if (monitor->simulador != nullptr) {
+        recebido = monitor->simulador->transferirByte(enviado);
+    } else {
+        monitor->estadoGerador = (monitor->estadoGerador * 1103515245u) + 12345u + enviado;
+        recebido = static_cast<uint8_t>(monitor->estadoGerador >> 16u);
+    }
+    monitor->trafego.push_back(ByteTrocado{enviado, recebido});
+    return recebido;
+}
+
+// Controlador real sobre o spi0 emulado. Só a seleção do chip e o relógio do
+// barramento são repassados ao simulador; as transferências seguem pelo
+// código do ControladorSpiCartao, com ou sem DMA.
+class ControladorMonitorado : public ControladorSpiCartao {
+public:
+    explicit ControladorMonitorado(SimuladorCartaoSpi &simulador_cartao)
+        : ControladorSpiCartao(spi0, 16u, 19u, 18u, 17u, FREQUENCIA_BAIXA_HZ, FREQUENCIA_ALTA_HZ),
+          simulador(simulador_cartao) {}
+
+    bool configurarHardware() override {
+        return ControladorSpiCartao::configurarHardware() && simulador.configurarHardware();
+    }
+
+    void ajustarFrequenciaBaixa() override {
+        ControladorSpiCartao::ajustarFrequenciaBaixa();
+        simulador.ajustarFrequenciaBaixa();
+    }
+
+    void ajustarFrequenciaAlta() override {
+        ControladorSpiCartao::ajustarFrequenciaAlta();
+        simulador.ajustarFrequenciaAlta();
+    }
+
+    uint32_t ajustarFrequencia(uint32_t frequencia_hz) override {
+        ControladorSpiCartao::ajustarFrequencia(frequencia_hz);
+        return simulador.ajustarFrequencia(frequencia_hz);
+    }
+
+    uint32_t obterFrequenciaAtual() const override {
+        return simulador.obterFrequenciaAtual();
+    }
+
+    void adquirirBarramento() override {
+        ControladorSpiCartao::adquirirBarramento();
+        simulador.adquirirBarramento();
+    }
+
+    void liberarBarramento() override {
+        simulador.liberarBarramento();
+        ControladorSpiCartao::liberarBarramento();
+    }
+
+private:
+    SimuladorCartaoSpi &simulador;
+};
+
+class DispositivoBlocoMemoria : public DispositivoBloco {
+public:
+    DispositivoBlocoMemoria() : dados(static_cast<size_t>(SETORES_MEMORIA) * TAMANHO_SETOR_DISPOSITIVO, 0u) {}
+
+    bool iniciar() override { return true; }
+    bool estaInicializado() const override { return true; }
+
+    bool lerSetores(uint8_t *destino, uint32_t setor_inicial, uint32_t quantidade) override {
+        if (setor_inicial + quantidade > SETORES_MEMORIA) {
+            return false;
+        }
+        memcpy(destino, &dados[static_cast<size_t>(setor_inicial) * TAMANHO_SETOR_DISPOSITIVO],
+               static_cast<size_t>(quantidade) * TAMANHO_SETOR_DISPOSITIVO);
+        return true;
+    }
+
+    bool escreverSetores(const uint8_t *origem, uint32_t setor_inicial, uint32_t quantidade) override {
+        if (setor_inicial + quantidade > SETORES_MEMORIA) {
+            return false;
+        }
+        memcpy(&dados[static_cast<size_t>(setor_inicial) * TAMANHO_SETOR_DISPOSITIVO], origem,
+               static_cast<size_t>(quantidade) * TAMANHO_SETOR_DISPOSITIVO);
+        return true;
+    }
+
+    bool apagarSetores(uint32_t setor_inicial, uint32_t setor_final) override {
+        if (setor_final >= SETORES_MEMORIA || setor_inicial > setor_final) {
+            return false;
+        }
+        memset(&dados[static_cast<size_t>(setor_inicial) * TAMANHO_SETOR_DISPOSITIVO], 0,
+               static_cast<size_t>(setor_final - setor_inicial + 1u) * TAMANHO_SETOR_DISPOSITIVO);
+        return true;
+    }
+
+    bool sincronizar() override { return true; }
+    uint64_t obterQuantidadeSetores() const override { return SETORES_MEMORIA; }
+    uint32_t obterSetoresUnidadeAlocacao() const override { return 0u; }
+
+private:
+    std::vector<uint8_t> dados;
+};
+
+struct ResultadoBuffer {
+    std::vector<ByteTrocado> trafego;
+    std::vector<uint8_t> recebido;
+    uint16_t crc;
+};
+
+static uint32_t falhas = 0u;
+
+static void conferir(bool condicao, const char *descricao) {
+    if (!condicao) {
+        printf("FALHA: %s\n", descricao);
+        falhas = falhas + 1u;
+    }
+}
+
+static void preencherPadrao(uint8_t *destino, size_t tamanho, uint32_t semente) {
+    uint32_t valor = semente * 2654435761u;
+    for (size_t indice = 0u; indice < tamanho; indice = indice + 1u) {
+        valor = (valor * 1103515245u) + 12345u;
+        destino[indice] = static_cast<uint8_t>(valor >> 16u);
+    }
+}
+
+// modo 0: só escrita; 1: só leitura; 2: escrita e leitura simultâneas.
+static ResultadoBuffer transferirComCanais(uint canais_dma, uint32_t modo, size_t tamanho, bool com_crc) {
+    MonitorBarramento monitor{{}, nullptr, 1u};
+    conectarDispositivoSpiHost(spi0, &trocarByteMonitor, &monitor);
+    definirCanaisDmaHost(canais_dma);
+
+    ControladorSpiCartao controlador(spi0, 16u, 19u, 18u, 17u, FREQUENCIA_BAIXA_HZ, FREQUENCIA_ALTA_HZ);
+    controlador.configurarHardware();
+    monitor.trafego.clear();
+
+    std::vector<uint8_t> origem(tamanho);
+    preencherPadrao(origem.data(), tamanho, static_cast<uint32_t>(tamanho));
+
+    ResultadoBuffer resultado{{}, std::vector<uint8_t>(tamanho, 0u), 0u};
+    const uint8_t *ponteiro_origem = (modo == 1u) ? nullptr : origem.data();
+    uint8_t *ponteiro_destino = (modo == 0u) ? nullptr : resultado.recebido.data();
+
+    if (com_crc) {
+        controlador.transferirBufferComCrc(ponteiro_origem, ponteiro_destino, tamanho, resultado.crc);
+    } else {
+        controlador.transferirBuffer(ponteiro_origem, ponteiro_destino, tamanho);
+    }
+
+    resultado.trafego = monitor.trafego;
+    conectarDispositivoSpiHost(spi0, nullptr, nullptr);
+    return resultado;
+}
+
+static void testarBuffers() {
+    static const size_t TAMANHOS[] = {16u, 17u, 64u, 512u, 1024u};
+    static const char *const MODOS[] = {"escrita", "leitura", "troca"};
+
+    for (size_t tamanho : TAMANHOS) {
+        for (uint32_t modo = 0u; modo < 3u; modo = modo + 1u) {
+            for (uint32_t com_crc = 0u; com_crc < 2u; com_crc = com_crc + 1u) {
+                uint32_t transferencias_antes = obterTransferenciasDmaHost();
+                ResultadoBuffer dma = transferirComCanais(2u, modo, tamanho, com_crc != 0u);
+                bool usou_dma = obterTransferenciasDmaHost() == transferencias_antes + 1u;
+                ResultadoBuffer bloqueante = transferirComCanais(0u, modo, tamanho, com_crc != 0u);
+
+                char descricao[96];
+                snprintf(descricao, sizeof(descricao), "%s de %zu bytes%s", MODOS[modo], tamanho,
+                         com_crc != 0u ? " com CRC" : "");
+
+                conferir(usou_dma, descricao);
+                conferir(dma.trafego.size() == tamanho && dma.trafego == bloqueante.trafego, descricao);
+                conferir(dma.recebido == bloqueante.recebido, descricao);
+                if (com_crc != 0u) {
+                    const std::vector<ByteTrocado> &trafego = dma.trafego;
+                    std::vector<uint8_t> carga(tamanho);
+                    for (size_t indice = 0u; indice < tamanho; indice = indice + 1u) {
+                        carga[indice] = (modo == 0u) ? trafego[indice].mosi : trafego[indice].miso;
+                    }
+                    conferir(dma.crc == bloqueante.crc, descricao);
+                    conferir(dma.crc == cartao_sd::calcularCrc16(carga.data(), tamanho), descricao);
+                }
+            }
+        }
+    }
+}
+
+// Escreve e lê setores pelo DriverCartaoSd, por CMD24/CMD17 e por CMD25/CMD18.
+static std::vector<ByteTrocado> executarDriver(uint canais_dma, bool verificacao_crc, std::vector<uint8_t> &lidos) {
+    ParametrosSimuladorSpi parametros{};
+    parametros.atraso_token_us = 300u;
+    parametros.ocupado_escrita_us = 700u;
+    parametros.ocupado_bloco_us = 250u;
+    parametros.ocupado_apagamento_us = 2000u;
+    parametros.respostas_inicializacao = 3u;
+    parametros.codigo_au = 9u;
+    parametros.suporta_alta_velocidade = true;
+
+    DispositivoBlocoMemoria memoria;
+    SimuladorCartaoSpi simulador(memoria, parametros);
+    MonitorBarramento monitor{{}, &simulador, 1u};
+    conectarDispositivoSpiHost(spi0, &trocarByteMonitor, &monitor);
+    definirCanaisDmaHost(canais_dma);
+
+    ControladorMonitorado controlador(simulador);
+    DriverCartaoSd driver(controlador);
+    driver.definirVerificacaoCrc(verificacao_crc);
+
+    std::vector<uint8_t> escritos(static_cast<size_t>(SETORES_TESTE) * TAMANHO_SETOR_DISPOSITIVO);
+    preencherPadrao(escritos.data(), escritos.size(), 7u);
+    lidos.assign(escritos.size() * 2u, 0u);
+
+    bool correto = driver.iniciar();
+    for (uint32_t indice = 0u; indice < SETORES_TESTE && correto; indice = indice + 1u) {
+        correto = driver.escreverSetores(&escritos[indice * TAMANHO_SETOR_DISPOSITIVO], SETOR_INICIAL_TESTE + indice, 1u);
+    }
+    correto = correto && driver.escreverSetores(escritos.data(), SETOR_INICIAL_TESTE + SETORES_TESTE, SETORES_TESTE);
+    for (uint32_t indice = 0u; indice < SETORES_TESTE && correto; indice = indice + 1u) {
+        correto = driver.lerSetores(&lidos[indice * TAMANHO_SETOR_DISPOSITIVO], SETOR_INICIAL_TESTE + indice, 1u);
+    }
+    correto = correto && driver.lerSetores(&lidos[escritos.size()], SETOR_INICIAL_TESTE + SETORES_TESTE, SETORES_TESTE);
+
+    conferir(correto, canais_dma > 0u ? "driver com DMA" : "driver sem DMA");
+    conferir(memcmp(lidos.data(), escritos.data(), escritos.size()) == 0 &&
+             memcmp(&lidos[escritos.size()], escritos.data(), escritos.size()) == 0,
+             canais_dma > 0u ? "dados lidos com DMA" : "dados lidos sem DMA");
+
+    conectarDispositivoSpiHost(spi0, nullptr, nullptr);
+    return monitor.trafego;
+}
+
+static void testarDriver(bool verificacao_crc) {
+    std::vector<uint8_t> lidos_dma;
+    std::vector<uint8_t> lidos_bloqueante;
+    uint32_t transferencias_antes = obterTransferenciasDmaHost();
+    std::vector<ByteTrocado> trafego_dma = executarDriver(2u, verificacao_crc, lidos_dma);
+    bool usou_dma = obterTransferenciasDmaHost() > transferencias_antes;
+    std::vector<ByteTrocado> trafego_bloqueante = executarDriver(0u, verificacao_crc, lidos_bloqueante);
+
+    const char *descricao = verificacao_crc ? "trafego do driver com CRC" : "trafego do driver sem CRC";
+    conferir(usou_dma, descricao);
+    conferir(trafego_dma == trafego_bloqueante, descricao);
+    conferir(lidos_dma == lidos_bloqueante, descricao);
+}
+
+int main() {
+    testarBuffers();
+    testarDriver(false);
+    testarDriver(true);
+    conferir(obterErrosConfiguracaoDmaHost() == 0u, "configuracao dos canais DMA");
+
+    printf("%u transferencias DMA conferidas, %u falhas\n", obterTransferenciasDmaHost(), falhas);
+    return (falhas == 0u) ? 0 : 1;
+}
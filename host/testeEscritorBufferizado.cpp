@@ -0,0 +1,143 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "CartaoSD.h"
+#include "DispositivoBlocoArquivo.h"
+#include "EscritorBufferizadoSd.h"
+
+// Confere o EscritorBufferizadoSd sobre um volume FAT formatado em uma imagem
+// temporária: a conversão de números só com inteiros e as descargas em
+// fronteira de setor do arquivo quando a escrita começa desalinhada.
+
+static constexpr const char *CAMINHO_IMAGEM = "teste_escritor.img";
+static constexpr uint64_t SETORES_IMAGEM = 16384u;
+static constexpr size_t TAMANHO_SETOR = 512u;
+static constexpr size_t TAMANHO_BUFFER = 1024u;
+static constexpr size_t DESLOCAMENTO_INICIAL = 100u;
+static constexpr size_t BYTES_ALINHAMENTO = 5000u;
+
+static uint32_t falhas = 0u;
+
+static void conferir(bool condicao, const char *descricao) {
+    if (!condicao) {
+        printf("FALHA: %s\n", descricao);
+        falhas = falhas + 1u;
+    }
+}
+
+static std::string lerArquivo(CartaoSD &cartao, const char *caminho) {
+    std::string conteudo;
+    ArquivoSd arquivo = cartao.abrir(caminho, MODO_LEITURA);
+    uint8_t bloco[256];
+    size_t lidos = 0u;
+    while (arquivo.estaAberto() && (lidos = arquivo.lerBytes(bloco, sizeof(bloco))) > 0u) {
+        conteudo.append(reinterpret_cast<const char *>(bloco), lidos);
+    }
+    arquivo.fechar();
+    return conteudo;
+}
+
+static void conferirDecimal(CartaoSD &cartao, int64_t valor, uint8_t casas, const char *esperado) {
+    char buffer[64];
+    {
+        ArquivoSd arquivo = cartao.abrir("/decimal.txt", MODO_ESCRITA);
+        bool truncou = arquivo.estaAberto() && arquivo.truncar();
+        EscritorBufferizadoSd escritor(arquivo, buffer, sizeof(buffer));
+        bool escreveu = truncou && escritor.escreverDecimal(valor, casas) && escritor.descarregar();
+        conferir(arquivo.fechar() && escreveu, esperado);
+    }
+    conferir(lerArquivo(cartao, "/decimal.txt") == esperado, esperado);
+}
+
+static void testarNumeros(CartaoSD &cartao) {
+    conferirDecimal(cartao, 1234, 2u, "12.34");
+    conferirDecimal(cartao, -1234, 2u, "-12.34");
+    conferirDecimal(cartao, -5, 2u, "-0.05");
+    conferirDecimal(cartao, -7, 0u, "-7");
+    conferirDecimal(cartao, 123456789, 9u, "0.123456789");
+    conferirDecimal(cartao, -1, 9u, "-0.000000001");
+    conferirDecimal(cartao, -1000000000, 9u, "-1.000000000");
+    conferirDecimal(cartao, INT64_MIN, 0u, "-9223372036854775808");
+    conferirDecimal(cartao, INT64_MIN, 9u, "-9223372036.854775808");
+    conferirDecimal(cartao, INT64_MAX, 9u, "9223372036.854775807");
+
+    char buffer[64];
+    ArquivoSd arquivo = cartao.abrir("/decimal.txt", MODO_ESCRITA);
+    EscritorBufferizadoSd escritor(arquivo, buffer, sizeof(buffer));
+    conferir(!escritor.escreverDecimal(1, ESCRITOR_SD_CASAS_MAXIMAS + 1u), "casas acima do maximo");
+    conferir(escritor.pendentes() == 0u, "casas acima do maximo sem bytes pendentes");
+}
+
+// Começa em DESLOCAMENTO_INICIAL: a primeira descarga por buffer cheio grava
+// só até a fronteira de setor e as seguintes ficam alinhadas.
+static void testarAlinhamento(CartaoSD &cartao) {
+    std::string esperado;
+    for (size_t indice = 0u; indice < DESLOCAMENTO_INICIAL + BYTES_ALINHAMENTO; indice = indice + 1u) {
+        esperado.push_back(static_cast<char>('a' + (indice % 26u)));
+    }
+
+    char buffer[TAMANHO_BUFFER];
+    ArquivoSd arquivo = cartao.abrir("/alinhado.txt", MODO_ESCRITA);
+    bool correto = arquivo.estaAberto() && arquivo.truncar() &&
+                   arquivo.escreverBytes(reinterpret_cast<const uint8_t *>(esperado.data()), DESLOCAMENTO_INICIAL) ==
+                       DESLOCAMENTO_INICIAL;
+    conferir(correto, "inicio desalinhado");
+
+    EstatisticasEscritorBufferizado estatisticas{};
+    {
+        EscritorBufferizadoSd escritor(arquivo, buffer, sizeof(buffer));
+        uint32_t descargas = 0u;
+        for (size_t indice = DESLOCAMENTO_INICIAL; indice < esperado.size() && correto; indice = indice + 1u) {
+            correto = escritor.escreverCaractere(esperado[indice]);
+            EstatisticasEscritorBufferizado atuais = escritor.obterEstatisticas();
+            if (atuais.descargas != descargas) {
+                descargas = atuais.descargas;
+                conferir(static_cast<size_t>(arquivo.posicao()) % TAMANHO_SETOR == 0u, "descarga termina em setor");
+                conferir(static_cast<size_t>(arquivo.posicao()) + escritor.pendentes() == indice + 1u,
+                         "resto volta ao inicio do buffer");
+            }
+        }
+        correto = correto && escritor.descarregar();
+        estatisticas = escritor.obterEstatisticas();
+    }
+    conferir(arquivo.fechar() && correto, "escrita alinhada");
+
+    // 924 bytes até o fim do setor, 3 descargas de 1024 alinhadas e os 1004
+    // restantes no descarregar final.
+    conferir(estatisticas.bytes == BYTES_ALINHAMENTO, "bytes do escritor");
+    conferir(estatisticas.descargas == 5u, "descargas");
+    conferir(estatisticas.descargas_alinhadas == 3u, "descargas alinhadas");
+    conferir(lerArquivo(cartao, "/alinhado.txt") == esperado, "conteudo alinhado");
+}
+
+int main() {
+    remove(CAMINHO_IMAGEM);
+    DispositivoBlocoArquivo dispositivo(CAMINHO_IMAGEM, SETORES_IMAGEM);
+    if (!dispositivo.iniciar()) {
+        printf("FALHA: imagem %s\n", CAMINHO_IMAGEM);
+        return 1;
+    }
+
+    {
+        CartaoSD cartao(dispositivo);
+        static BYTE area_trabalho[4096];
+        ParametrosFormatacaoFat parametros{};
+        parametros.formato = FM_ANY;
+        bool montado = cartao.formatar("0:", parametros, area_trabalho, sizeof(area_trabalho)) &&
+                       cartao.montarSistemaArquivos();
+        conferir(montado, "formatar e montar");
+        if (montado) {
+            testarNumeros(cartao);
+            testarAlinhamento(cartao);
+            cartao.desmontarSistemaArquivos();
+        }
+    }
+
+    remove(CAMINHO_IMAGEM);
+    printf("escritor bufferizado: %u falhas\n", falhas);
+    return (falhas == 0u) ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "CartaoSD.h"
+#include "DispositivoBlocoArquivo.h"
+#include "LeitorLinhasSd.h"
+
+// Confere o LeitorLinhasSd nas fronteiras de bloco, com um buffer de 16 bytes
+// sobre um volume FAT em imagem temporária: linhas que cruzam o bloco, linhas
+// do tamanho do buffer, "\r\n" dividido entre blocos e última linha sem
+// terminador.
+
+static constexpr const char *CAMINHO_IMAGEM = "teste_leitor.img";
+static constexpr const char *CAMINHO_ARQUIVO = "/linhas.txt";
+static constexpr uint64_t SETORES_IMAGEM = 16384u;
+static constexpr size_t TAMANHO_BUFFER = 16u;
+
+static uint32_t falhas = 0u;
+
+static void conferir(bool condicao, const char *descricao) {
+    if (!condicao) {
+        printf("FALHA: %s\n", descricao);
+        falhas = falhas + 1u;
+    }
+}
+
+static void conferirLinhas(CartaoSD &cartao, const char *descricao, const std::string &conteudo,
+                           const std::vector<std::string> &esperadas, uint32_t linhas, uint32_t partidas) {
+    ArquivoSd escrita = cartao.abrir(CAMINHO_ARQUIVO, MODO_ESCRITA);
+    bool escreveu = escrita.estaAberto() && escrita.truncar() &&
+                    escrita.escreverBytes(reinterpret_cast<const uint8_t *>(conteudo.data()), conteudo.size()) ==
+                        conteudo.size();
+    conferir(escrita.fechar() && escreveu, descricao);
+
+    char buffer[TAMANHO_BUFFER];
+    ArquivoSd arquivo = cartao.abrir(CAMINHO_ARQUIVO, MODO_LEITURA);
+    LeitorLinhasSd leitor(arquivo, buffer, sizeof(buffer));
+    std::vector<std::string> lidas;
+    std::string_view linha;
+    while (leitor.proximaLinha(linha)) {
+        lidas.emplace_back(linha);
+    }
+
+    EstatisticasLeitorLinhas estatisticas = leitor.obterEstatisticas();
+    conferir(!leitor.falhou(), descricao);
+    conferir(lidas == esperadas, descricao);
+    conferir(estatisticas.linhas == linhas && estatisticas.linhas_partidas == partidas, descricao);
+    conferir(estatisticas.bytes == conteudo.size(), descricao);
+    arquivo.fechar();
+}
+
+static void testarFronteiras(CartaoSD &cartao) {
+    conferirLinhas(cartao, "linha cruzando o bloco",
+                   "abc\nlinha que cruza\nfim\n",
+                   {"abc", "linha que cruza", "fim"}, 3u, 0u);
+    conferirLinhas(cartao, "linha do tamanho do buffer",
+                   "0123456789abcdef\nxy\n",
+                   {"0123456789abcdef", "xy"}, 2u, 1u);
+    conferirLinhas(cartao, "linha do tamanho do buffer com CRLF",
+                   "0123456789abcdef\r\nxy\r\n",
+                   {"0123456789abcdef", "xy"}, 2u, 1u);
+    conferirLinhas(cartao, "CRLF dividido pelo buffer cheio",
+                   "0123456789abcde\r\nxy\r\n",
+                   {"0123456789abcde", "xy"}, 2u, 1u);
+    conferirLinhas(cartao, "CRLF cruzando o bloco",
+                   "ab\r\ncdefghijklm\r\nfim\r\n",
+                   {"ab", "cdefghijklm", "fim"}, 3u, 0u);
+    conferirLinhas(cartao, "linha maior que o buffer",
+                   "0123456789abcdefghij\r\nxy\n",
+                   {"0123456789abcdef", "ghij", "xy"}, 2u, 1u);
+    conferirLinhas(cartao, "ultima linha sem terminador",
+                   "um\ndois",
+                   {"um", "dois"}, 2u, 0u);
+    conferirLinhas(cartao, "ultima linha longa sem terminador",
+                   "um\n0123456789abcdefghij",
+                   {"um", "0123456789abcdef", "ghij"}, 2u, 1u);
+    conferirLinhas(cartao, "linha vazia de verdade",
+                   "a\n\nb\n",
+                   {"a", "", "b"}, 3u, 0u);
+}
+
+int main() {
+    remove(CAMINHO_IMAGEM);
+    DispositivoBlocoArquivo dispositivo(CAMINHO_IMAGEM, SETORES_IMAGEM);
+    if (!dispositivo.iniciar()) {
+        printf("FALHA: imagem %s\n", CAMINHO_IMAGEM);
+        return 1;
+    }
+
+    {
+        CartaoSD cartao(dispositivo);
+        static BYTE area_trabalho[4096];
+        ParametrosFormatacaoFat parametros{};
+        parametros.formato = FM_ANY;
+        bool montado = cartao.formatar("0:", parametros, area_trabalho, sizeof(area_trabalho)) &&
+                       cartao.montarSistemaArquivos();
+        conferir(montado, "formatar e montar");
+        if (montado) {
+            testarFronteiras(cartao);
+            cartao.desmontarSistemaArquivos();
+        }
+    }
+
+    remove(CAMINHO_IMAGEM);
+    printf("leitor de linhas: %u falhas\n", falhas);
+    return (falhas == 0u) ? 0 : 1;
+}
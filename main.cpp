@@ -17,7 +17,11 @@ static constexpr uint8_t PINO_UART_RX = 9u;
 
 int main()
 {
-    CartaoSD cartao(SPI_CARTAO, PINO_SPI_MISO_CARTAO, PINO_SPI_MOSI_CARTAO, PINO_SPI_SCK_CARTAO, PINO_SPI_CS_CARTAO);
+    // Estático: os setores do cache, da leitura antecipada, do agrupador e a
+    // tabela de descritores ficam dentro do CartaoSD e não cabem na pilha de
+    // 2 KB do núcleo 0.
+    static CartaoSD cartao(SPI_CARTAO, PINO_SPI_MISO_CARTAO, PINO_SPI_MOSI_CARTAO, PINO_SPI_SCK_CARTAO, PINO_SPI_CS_CARTAO);
+    cartao.definirEscritaAdiada(true);
     PortaSerial porta_serial(INTERFACE_UART, TAXA_BPS_UART, PINO_UART_TX, PINO_UART_RX);
     porta_serial.iniciar();
 
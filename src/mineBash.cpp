@@ -3,16 +3,409 @@
 #include <cctype>
 #include <cstdarg>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 
+#include "pico/multicore.h"
 #include "pico/platform.h"
 
+#include "EscritorBufferizadoSd.h"
+#include "LeitorLinhasSd.h"
 #include "ff.h"
 
 namespace {
 constexpr const char* CAMINHO_RAIZ = "/";
 constexpr const char* UNIDADE_PADRAO = "0:";
 constexpr const char* QUEBRA_LINHA = "\r\n";
+
+constexpr UINT BYTES_ENCAMINHAMENTO_EXIBICAO = 4096u;
+constexpr size_t TAMANHO_BLOCO_LINHAS = 4096u;
+constexpr size_t TAMANHO_BLOCO_CSV = 4096u;
+constexpr unsigned long LINHAS_MAXIMAS_CSV = 1000000ul;
+
+constexpr const char* ARQUIVO_BANCADA = "/bench.dat";
+constexpr const char* ARQUIVO_ACRESCIMO_BANCADA = "/bench.log";
+constexpr const char* ARQUIVO_RESULTADOS_BANCADA = "/bench.csv";
+constexpr size_t TAMANHO_BLOCO_BANCADA = 4096u;
+constexpr size_t TAMANHO_ACRESCIMO_BANCADA = 64u;
+constexpr size_t TAMANHO_ACRESCIMO_CURTO_BANCADA = 16u;
+constexpr uint32_t AMOSTRAS_BANCADA = 256u;
+constexpr uint32_t OPERACOES_ALEATORIAS_BANCADA = 128u;
+constexpr uint32_t ARQUIVOS_METADADOS_BANCADA = 32u;
+constexpr uint32_t TAMANHO_PADRAO_BANCADA_KB = 4096u;
+constexpr uint32_t TAMANHO_MAXIMO_BANCADA_KB = 65536u;
+constexpr uint32_t TAMANHO_MINIMO_BANCADA_KB = 16u;
+
+constexpr const char* ARQUIVO_COMUM_ESTRESSE = "/estresse.dat";
+constexpr size_t TAMANHO_BLOCO_ESTRESSE = 512u;
+constexpr uint32_t BLOCOS_COMUM_ESTRESSE = 64u;
+constexpr uint32_t BLOCOS_PROPRIOS_ESTRESSE = 16u;
+constexpr uint32_t LEITURAS_COMUNS_ESTRESSE = 4u;
+constexpr uint32_t SEMENTE_COMUM_ESTRESSE = 0xC0u;
+constexpr uint32_t RODADAS_PADRAO_ESTRESSE = 20u;
+constexpr uint32_t RODADAS_MAXIMAS_ESTRESSE = 1000u;
+constexpr size_t TAMANHO_PILHA_NUCLEO1_ESTRESSE = 8192u;
+
+// Resultado de uma carga do bench. Os percentis saem de até AMOSTRAS_BANCADA
+// latências, uma a cada passo_amostras operações espalhadas pela carga toda; o
+// máximo considera todas as operações.
+struct ResultadoBancada {
+    const char* nome;
+    uint32_t operacoes;
+    uint32_t passo_amostras;
+    uint32_t amostras;
+    uint64_t bytes;
+    uint64_t tempo_us;
+    uint32_t latencias_us[AMOSTRAS_BANCADA];
+    uint32_t p50_us;
+    uint32_t p99_us;
+    uint32_t maximo_us;
+};
+
+int converterDescritor(const char* texto) {
+    if (texto == nullptr || texto[0] < '0' || texto[0] > '9') {
+        return DESCRITOR_INVALIDO;
+    }
+    char* fim_numero = nullptr;
+    long descritor = strtol(texto, &fim_numero, 10);
+    if (*fim_numero != 0 || descritor >= CARTAO_SD_DESCRITORES) {
+        return DESCRITOR_INVALIDO;
+    }
+    return static_cast<int>(descritor);
+}
+
+void iniciarResultadoBancada(ResultadoBancada& resultado, const char* nome, uint32_t operacoes_previstas) {
+    resultado.nome = nome;
+    resultado.operacoes = 0u;
+    resultado.passo_amostras = (operacoes_previstas + AMOSTRAS_BANCADA - 1u) / AMOSTRAS_BANCADA;
+    if (resultado.passo_amostras == 0u) {
+        resultado.passo_amostras = 1u;
+    }
+    resultado.amostras = 0u;
+    resultado.bytes = 0u;
+    resultado.tempo_us = 0u;
+    resultado.p50_us = 0u;
+    resultado.p99_us = 0u;
+    resultado.maximo_us = 0u;
+}
+
+void registrarLatenciaBancada(ResultadoBancada& resultado, uint64_t inicio_us, size_t bytes) {
+    uint32_t latencia_us = static_cast<uint32_t>(time_us_64() - inicio_us);
+    if ((resultado.operacoes % resultado.passo_amostras) == 0u && resultado.amostras < AMOSTRAS_BANCADA) {
+        resultado.latencias_us[resultado.amostras] = latencia_us;
+        resultado.amostras = resultado.amostras + 1u;
+    }
+    if (latencia_us > resultado.maximo_us) {
+        resultado.maximo_us = latencia_us;
+    }
+    resultado.operacoes = resultado.operacoes + 1u;
+    resultado.bytes = resultado.bytes + bytes;
+}
+
+void calcularPercentisBancada(ResultadoBancada& resultado) {
+    uint32_t quantidade = resultado.amostras;
+    if (quantidade == 0u) {
+        return;
+    }
+
+    // Ordenação por inserção: no máximo AMOSTRAS_BANCADA valores por carga.
+    for (uint32_t indice = 1u; indice < quantidade; indice = indice + 1u) {
+        uint32_t valor = resultado.latencias_us[indice];
+        uint32_t posicao = indice;
+        while (posicao > 0u && resultado.latencias_us[posicao - 1u] > valor) {
+            resultado.latencias_us[posicao] = resultado.latencias_us[posicao - 1u];
+            posicao = posicao - 1u;
+        }
+        resultado.latencias_us[posicao] = valor;
+    }
+
+    // Percentil pelo posto mais próximo.
+    resultado.p50_us = resultado.latencias_us[((quantidade * 50u) + 99u) / 100u - 1u];
+    resultado.p99_us = resultado.latencias_us[((quantidade * 99u) + 99u) / 100u - 1u];
+}
+
+uint32_t proximoAleatorioBancada(uint32_t& estado) {
+    estado ^= estado << 13u;
+    estado ^= estado >> 17u;
+    estado ^= estado << 5u;
+    return estado;
+}
+
+bool bancadaEscritaSequencial(CartaoSD& cartao, uint8_t* bloco, uint32_t blocos, ResultadoBancada& resultado) {
+    iniciarResultadoBancada(resultado, "escrita_sequencial", blocos);
+    cartao.removerArquivo(ARQUIVO_BANCADA);
+
+    uint64_t inicio_us = time_us_64();
+    ArquivoSd arquivo = cartao.abrir(ARQUIVO_BANCADA, MODO_LEITURA | MODO_ESCRITA);
+    if (!arquivo.estaAberto()) {
+        return false;
+    }
+
+    bool escreveu = true;
+    for (uint32_t indice = 0u; indice < blocos && escreveu; indice = indice + 1u) {
+        bloco[0] = static_cast<uint8_t>(indice);
+        uint64_t inicio_operacao_us = time_us_64();
+        escreveu = arquivo.escreverBytes(bloco, TAMANHO_BLOCO_BANCADA) == TAMANHO_BLOCO_BANCADA;
+        registrarLatenciaBancada(resultado, inicio_operacao_us, TAMANHO_BLOCO_BANCADA);
+    }
+
+    escreveu = arquivo.fechar() && escreveu;
+    resultado.tempo_us = time_us_64() - inicio_us;
+    return escreveu;
+}
+
+bool bancadaLeituraSequencial(CartaoSD& cartao, uint8_t* bloco, uint32_t blocos, ResultadoBancada& resultado) {
+    iniciarResultadoBancada(resultado, "leitura_sequencial", blocos);
+
+    uint64_t inicio_us = time_us_64();
+    ArquivoSd arquivo = cartao.abrir(ARQUIVO_BANCADA, MODO_LEITURA);
+    if (!arquivo.estaAberto()) {
+        return false;
+    }
+
+    bool leu = true;
+    for (uint32_t indice = 0u; indice < blocos && leu; indice = indice + 1u) {
+        uint64_t inicio_operacao_us = time_us_64();
+        leu = arquivo.lerBytes(bloco, TAMANHO_BLOCO_BANCADA) == TAMANHO_BLOCO_BANCADA;
+        registrarLatenciaBancada(resultado, inicio_operacao_us, TAMANHO_BLOCO_BANCADA);
+    }
+
+    arquivo.fechar();
+    resultado.tempo_us = time_us_64() - inicio_us;
+    return leu;
+}
+
+bool bancadaAleatoria(CartaoSD& cartao, uint8_t* bloco, uint32_t blocos, bool escrita, ResultadoBancada& resultado) {
+    iniciarResultadoBancada(resultado, escrita ? "escrita_aleatoria_4k" : "leitura_aleatoria_4k", OPERACOES_ALEATORIAS_BANCADA);
+    uint32_t estado_aleatorio = 0x2545F491u;
+
+    uint64_t inicio_us = time_us_64();
+    ArquivoSd arquivo = cartao.abrir(ARQUIVO_BANCADA, escrita ? (MODO_LEITURA | MODO_ESCRITA | MODO_ACESSO_ALEATORIO) : MODO_LEITURA);
+    if (!arquivo.estaAberto()) {
+        return false;
+    }
+
+    // Na escrita cada operação termina em sincronizar, para medir o cartão e
+    // não apenas o cache do FatFs.
+    bool sucesso = true;
+    for (uint32_t indice = 0u; indice < OPERACOES_ALEATORIAS_BANCADA && sucesso; indice = indice + 1u) {
+        long posicao = static_cast<long>((proximoAleatorioBancada(estado_aleatorio) % blocos) * TAMANHO_BLOCO_BANCADA);
+        uint64_t inicio_operacao_us = time_us_64();
+        sucesso = arquivo.buscar(posicao);
+        if (sucesso && escrita) {
+            sucesso = arquivo.escreverBytes(bloco, TAMANHO_BLOCO_BANCADA) == TAMANHO_BLOCO_BANCADA && arquivo.sincronizar();
+        } else if (sucesso) {
+            sucesso = arquivo.lerBytes(bloco, TAMANHO_BLOCO_BANCADA) == TAMANHO_BLOCO_BANCADA;
+        }
+        registrarLatenciaBancada(resultado, inicio_operacao_us, TAMANHO_BLOCO_BANCADA);
+    }
+
+    sucesso = arquivo.fechar() && sucesso;
+    resultado.tempo_us = time_us_64() - inicio_us;
+    return sucesso;
+}
+
+bool bancadaAcrescimo(CartaoSD& cartao, const uint8_t* bloco, ResultadoBancada& resultado) {
+    iniciarResultadoBancada(resultado, "acrescimo_64b", AMOSTRAS_BANCADA);
+    cartao.removerArquivo(ARQUIVO_ACRESCIMO_BANCADA);
+
+    uint64_t inicio_us = time_us_64();
+    ArquivoSd arquivo = cartao.abrir(ARQUIVO_ACRESCIMO_BANCADA, MODO_ACRESCENTAR);
+    if (!arquivo.estaAberto()) {
+        return false;
+    }
+
+    // Padrão de log: registros curtos, cada um sincronizado no cartão.
+    bool escreveu = true;
+    for (uint32_t indice = 0u; indice < AMOSTRAS_BANCADA && escreveu; indice = indice + 1u) {
+        uint64_t inicio_operacao_us = time_us_64();
+        escreveu = arquivo.escreverBytes(bloco, TAMANHO_ACRESCIMO_BANCADA) == TAMANHO_ACRESCIMO_BANCADA && arquivo.sincronizar();
+        registrarLatenciaBancada(resultado, inicio_operacao_us, TAMANHO_ACRESCIMO_BANCADA);
+    }
+
+    escreveu = arquivo.fechar() && escreveu;
+    resultado.tempo_us = time_us_64() - inicio_us;
+    cartao.removerArquivo(ARQUIVO_ACRESCIMO_BANCADA);
+    return escreveu;
+}
+
+// Custo por chamada de acréscimos curtos sem sincronizar, no fim do arquivo do
+// bench já escrito (a cadeia de clusters é longa). A variante com busca refaz o
+// f_lseek até o fim antes de cada escrita, como o modo de acréscimo fazia.
+bool bancadaAcrescimoCurto(CartaoSD& cartao, const uint8_t* bloco, bool rebuscar, ResultadoBancada& resultado) {
+    iniciarResultadoBancada(resultado, rebuscar ? "acrescimo_16b_busca" : "acrescimo_16b", AMOSTRAS_BANCADA);
+
+    uint64_t inicio_us = time_us_64();
+    ArquivoSd arquivo = cartao.abrir(ARQUIVO_BANCADA, MODO_ACRESCENTAR);
+    if (!arquivo.estaAberto()) {
+        return false;
+    }
+
+    bool escreveu = true;
+    for (uint32_t indice = 0u; indice < AMOSTRAS_BANCADA && escreveu; indice = indice + 1u) {
+        uint64_t inicio_operacao_us = time_us_64();
+        if (rebuscar) {
+            escreveu = arquivo.buscar(static_cast<long>(arquivo.tamanho()));
+        }
+        escreveu = escreveu && arquivo.escreverBytes(bloco, TAMANHO_ACRESCIMO_CURTO_BANCADA) == TAMANHO_ACRESCIMO_CURTO_BANCADA;
+        registrarLatenciaBancada(resultado, inicio_operacao_us, TAMANHO_ACRESCIMO_CURTO_BANCADA);
+    }
+
+    escreveu = arquivo.fechar() && escreveu;
+    resultado.tempo_us = time_us_64() - inicio_us;
+    return escreveu;
+}
+
+bool bancadaMetadados(CartaoSD& cartao, ResultadoBancada& resultado) {
+    iniciarResultadoBancada(resultado, "criar_apagar", ARQUIVOS_METADADOS_BANCADA);
+
+    uint64_t inicio_us = time_us_64();
+    bool sucesso = true;
+    for (uint32_t indice = 0u; indice < ARQUIVOS_METADADOS_BANCADA && sucesso; indice = indice + 1u) {
+        char caminho[24];
+        snprintf(caminho, sizeof(caminho), "/bench_%02lu.tmp", static_cast<unsigned long>(indice));
+
+        uint64_t inicio_operacao_us = time_us_64();
+        ArquivoSd arquivo = cartao.abrir(caminho, MODO_ESCRITA);
+        sucesso = arquivo.estaAberto() && arquivo.fechar() && cartao.removerArquivo(caminho);
+        registrarLatenciaBancada(resultado, inicio_operacao_us, 0u);
+    }
+
+    resultado.tempo_us = time_us_64() - inicio_us;
+    return sucesso;
+}
+
+// Estado do estresse compartilhado entre os núcleos: cada um só escreve no
+// próprio resultado, e o núcleo 0 só os lê depois do aviso pela FIFO.
+struct ResultadoEstresse {
+    uint32_t rodadas;
+    uint32_t blocos_escritos;
+    uint32_t blocos_lidos;
+    uint32_t falhas;
+    FRESULT primeiro_erro;
+    uint64_t tempo_us;
+};
+
+struct ContextoEstresse {
+    CartaoSD* cartao;
+    uint32_t rodadas;
+    ResultadoEstresse resultados[2];
+};
+
+// Fora da pilha: o bloco do leitor de linhas é maior que a pilha do núcleo 0.
+char blocoLeitorLinhas[TAMANHO_BLOCO_LINHAS];
+char blocoEscritorCsv[TAMANHO_BLOCO_CSV];
+
+ContextoEstresse contextoEstresse;
+uint8_t blocosEstresse[2][TAMANHO_BLOCO_ESTRESSE];
+// Um ArquivoSd carrega o FIL com o buffer de setor: a pilha padrão do
+// núcleo 1 (2 KB) não comporta isso mais a pilha do FatFs.
+uint32_t pilhaNucleo1Estresse[TAMANHO_PILHA_NUCLEO1_ESTRESSE / sizeof(uint32_t)];
+
+void preencherBlocoEstresse(uint8_t* bloco, uint32_t semente, uint32_t indice_bloco) {
+    uint32_t valor = (semente * 2654435761u) ^ (indice_bloco * 40503u);
+    for (size_t indice = 0u; indice < TAMANHO_BLOCO_ESTRESSE; indice = indice + 1u) {
+        valor = (valor * 1103515245u) + 12345u;
+        bloco[indice] = static_cast<uint8_t>(valor >> 16u);
+    }
+}
+
+bool conferirBlocoEstresse(const uint8_t* bloco, uint32_t semente, uint32_t indice_bloco) {
+    uint32_t valor = (semente * 2654435761u) ^ (indice_bloco * 40503u);
+    for (size_t indice = 0u; indice < TAMANHO_BLOCO_ESTRESSE; indice = indice + 1u) {
+        valor = (valor * 1103515245u) + 12345u;
+        if (bloco[indice] != static_cast<uint8_t>(valor >> 16u)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void registrarFalhaEstresse(ResultadoEstresse& resultado, CartaoSD& cartao, ArquivoSd& arquivo) {
+    // O resultado do CartaoSD é por núcleo; o do arquivo só existe se ele abriu.
+    FRESULT erro = arquivo.estaAberto() ? arquivo.resultadoOperacao() : cartao.resultadoOperacao();
+    if (resultado.falhas == 0u) {
+        resultado.primeiro_erro = erro;
+    }
+    resultado.falhas = resultado.falhas + 1u;
+}
+
+bool prepararArquivoComumEstresse(CartaoSD& cartao) {
+    ArquivoSd arquivo = cartao.abrir(ARQUIVO_COMUM_ESTRESSE, MODO_ESCRITA);
+    if (!arquivo.estaAberto()) {
+        return false;
+    }
+    bool escreveu = arquivo.truncar();
+    for (uint32_t indice = 0u; indice < BLOCOS_COMUM_ESTRESSE && escreveu; indice = indice + 1u) {
+        preencherBlocoEstresse(blocosEstresse[0], SEMENTE_COMUM_ESTRESSE, indice);
+        escreveu = arquivo.escreverBytes(blocosEstresse[0], TAMANHO_BLOCO_ESTRESSE) == TAMANHO_BLOCO_ESTRESSE;
+    }
+    return arquivo.fechar() && escreveu;
+}
+
+// Cada rodada regrava e confere o arquivo do próprio núcleo e lê blocos
+// sorteados do arquivo comum, que o outro núcleo lê ao mesmo tempo.
+void executarCargaEstresse(uint32_t nucleo) {
+    ResultadoEstresse& resultado = contextoEstresse.resultados[nucleo];
+    CartaoSD& cartao = *contextoEstresse.cartao;
+    uint8_t* bloco = blocosEstresse[nucleo];
+    uint32_t estado_aleatorio = 0x9E3779B9u + nucleo;
+    // "/estresse_" + até 20 dígitos (unsigned long de 64 bits no host) + ".dat" + NUL.
+    char caminho[36];
+    snprintf(caminho, sizeof(caminho), "/estresse_%lu.dat", static_cast<unsigned long>(nucleo));
+
+    uint64_t inicio_us = time_us_64();
+    for (uint32_t rodada = 0u; rodada < contextoEstresse.rodadas; rodada = rodada + 1u) {
+        uint32_t semente = (nucleo << 16u) | rodada;
+
+        ArquivoSd arquivo = cartao.abrir(caminho, MODO_ESCRITA);
+        bool sucesso = arquivo.estaAberto();
+        for (uint32_t indice = 0u; indice < BLOCOS_PROPRIOS_ESTRESSE && sucesso; indice = indice + 1u) {
+            preencherBlocoEstresse(bloco, semente, indice);
+            sucesso = arquivo.escreverBytes(bloco, TAMANHO_BLOCO_ESTRESSE) == TAMANHO_BLOCO_ESTRESSE;
+            resultado.blocos_escritos = resultado.blocos_escritos + (sucesso ? 1u : 0u);
+        }
+        sucesso = sucesso && arquivo.fechar();
+        if (!sucesso) {
+            registrarFalhaEstresse(resultado, cartao, arquivo);
+            arquivo.fechar();
+        }
+
+        arquivo = cartao.abrir(caminho, MODO_LEITURA);
+        sucesso = arquivo.estaAberto();
+        for (uint32_t indice = 0u; indice < BLOCOS_PROPRIOS_ESTRESSE && sucesso; indice = indice + 1u) {
+            sucesso = arquivo.lerBytes(bloco, TAMANHO_BLOCO_ESTRESSE) == TAMANHO_BLOCO_ESTRESSE &&
+                      conferirBlocoEstresse(bloco, semente, indice);
+            resultado.blocos_lidos = resultado.blocos_lidos + (sucesso ? 1u : 0u);
+        }
+        if (!sucesso) {
+            registrarFalhaEstresse(resultado, cartao, arquivo);
+        }
+        arquivo.fechar();
+
+        arquivo = cartao.abrir(ARQUIVO_COMUM_ESTRESSE, MODO_LEITURA);
+        sucesso = arquivo.estaAberto();
+        for (uint32_t leitura = 0u; leitura < LEITURAS_COMUNS_ESTRESSE && sucesso; leitura = leitura + 1u) {
+            uint32_t indice = proximoAleatorioBancada(estado_aleatorio) % BLOCOS_COMUM_ESTRESSE;
+            sucesso = arquivo.buscar(static_cast<long>(indice * TAMANHO_BLOCO_ESTRESSE)) &&
+                      arquivo.lerBytes(bloco, TAMANHO_BLOCO_ESTRESSE) == TAMANHO_BLOCO_ESTRESSE &&
+                      conferirBlocoEstresse(bloco, SEMENTE_COMUM_ESTRESSE, indice);
+            resultado.blocos_lidos = resultado.blocos_lidos + (sucesso ? 1u : 0u);
+        }
+        if (!sucesso) {
+            registrarFalhaEstresse(resultado, cartao, arquivo);
+        }
+        arquivo.fechar();
+
+        resultado.rodadas = resultado.rodadas + 1u;
+    }
+    resultado.tempo_us = time_us_64() - inicio_us;
+}
+
+void nucleo1Estresse() {
+    executarCargaEstresse(1u);
+    multicore_fifo_push_blocking(1u);
+}
 }
 
 MineBash::MineBash()
@@ -95,6 +488,8 @@ bool MineBash::lerLinha(char* destino, size_t capacidade) {
     for (;;) {
         int caractere = getchar_timeout_us(TEMPO_LEITURA_TIMEOUT_US);
         if (caractere == PICO_ERROR_TIMEOUT) {
+            // Enquanto o terminal está ocioso, escritas agrupadas vencidas vão para o cartão.
+            cartaoSd->verificarPrazoEscrita();
             tight_loop_contents();
             continue;
         }
@@ -223,6 +618,86 @@ void MineBash::executarLinha(const char* linha) {
         return;
     }
 
+    if (strcmp(token_um, "info_cartao") == 0) {
+        executarInfoCartao();
+        return;
+    }
+
+    if (strcmp(token_um, "velocidade") == 0) {
+        executarVelocidade();
+        return;
+    }
+
+    if (strcmp(token_um, "descarte") == 0) {
+        executarDescarte(token_dois);
+        return;
+    }
+
+    if (strcmp(token_um, "espera") == 0) {
+        executarEspera(token_dois);
+        return;
+    }
+
+    if (strcmp(token_um, "cache") == 0) {
+        executarCache(token_dois);
+        return;
+    }
+
+    if (strcmp(token_um, "antecipar") == 0) {
+        executarAntecipar(token_dois);
+        return;
+    }
+
+    if (strcmp(token_um, "agrupar") == 0) {
+        executarAgrupar(token_dois);
+        return;
+    }
+
+    if (strcmp(token_um, "histograma") == 0) {
+        executarHistograma(token_dois);
+        return;
+    }
+
+    if (strcmp(token_um, "bench") == 0) {
+        executarBench(token_dois);
+        return;
+    }
+
+    if (strcmp(token_um, "estresse") == 0) {
+        executarEstresse(token_dois);
+        return;
+    }
+
+    if (strcmp(token_um, "prealocar") == 0) {
+        executarPrealocar(argumento_pos_primeiro);
+        return;
+    }
+
+    if (strcmp(token_um, "linhas") == 0) {
+        executarLinhas(argumento_pos_primeiro);
+        return;
+    }
+
+    if (strcmp(token_um, "registrar_csv") == 0) {
+        executarRegistrarCsv(token_dois, argumento_pos_segundo);
+        return;
+    }
+
+    if (strcmp(token_um, "abrir") == 0) {
+        executarAbrir(argumento_pos_primeiro);
+        return;
+    }
+
+    if (strcmp(token_um, "gravar") == 0) {
+        executarGravar(token_dois, argumento_pos_segundo);
+        return;
+    }
+
+    if (strcmp(token_um, "fechar") == 0) {
+        executarFechar(token_dois);
+        return;
+    }
+
     imprimirMensagem("Comando desconhecido. Digite 'ajuda' para ajuda.\n");
 }
 
@@ -239,7 +714,23 @@ void MineBash::executarAjuda() {
     imprimirMensagem("  entrar <caminho>                        - entra em um subdiretorio\n");
     imprimirMensagem("  sair                                    - retorna ao diretorio anterior\n");
     imprimirMensagem("  escrever_arquivo [-n] <caminho> \"txt\" - acrescenta texto (use -n para nova linha)\n");
-    imprimirMensagem("  exibir_arquivo <caminho>                - mostra o conteudo do arquivo\n\n");
+    imprimirMensagem("  exibir_arquivo <caminho>                - mostra o conteudo do arquivo\n");
+    imprimirMensagem("  linhas <arquivo>                        - conta linhas e bytes lendo em blocos de 4 KB\n");
+    imprimirMensagem("  registrar_csv <linhas> <arquivo>        - grava um CSV de teste com o escritor bufferizado\n");
+    imprimirMensagem("  abrir <arquivo>                         - abre para acrescimo e mostra o descritor\n");
+    imprimirMensagem("  gravar <descritor> <texto>              - acrescenta uma linha pelo descritor aberto\n");
+    imprimirMensagem("  fechar <descritor>                      - grava e fecha o descritor\n");
+    imprimirMensagem("  info_cartao                             - mostra CID, CSD e SD Status do cartao\n");
+    imprimirMensagem("  velocidade                              - mostra a frequencia SPI negociada com o cartao\n");
+    imprimirMensagem("  descarte [ligar|desligar]               - apaga no cartao os setores liberados (remocao/formatacao)\n");
+    imprimirMensagem("  espera [varredura|evento|zerar]         - estrategia e tempos de espera do cartao\n");
+    imprimirMensagem("  cache [direta|adiada|zerar]             - politica e contadores do cache de setores\n");
+    imprimirMensagem("  antecipar [ligar|desligar|zerar]        - leitura antecipada de setores sequenciais\n");
+    imprimirMensagem("  agrupar [ligar|desligar|zerar|<ms>]     - agrupamento de escritas por unidade de alocacao\n");
+    imprimirMensagem("  histograma [zerar]                      - latencias por comando e fase (resposta, token, ocupado)\n");
+    imprimirMensagem("  prealocar <arquivo> <tamanho>[k|m]      - reserva o arquivo em clusters contiguos\n");
+    imprimirMensagem("  bench [kb]                              - mede o cartao e grava os resultados em /bench.csv\n");
+    imprimirMensagem("  estresse [rodadas]                      - leituras e escritas simultaneas nos dois nucleos\n\n");
 }
 
 void MineBash::executarListar(const char* argumento) {
@@ -256,37 +747,24 @@ void MineBash::executarListar(const char* argumento) {
         caminho[sizeof(caminho) - 1u] = 0;
     }
 
-    ArquivoSd diretorio = cartaoSd->abrir(caminho, MODO_DIRETORIO | MODO_LEITURA);
+    DiretorioSd diretorio = cartaoSd->abrirDiretorio(caminho);
     if (!diretorio.estaAberto()) {
         imprimirMensagem("Falha ao abrir diretorio.\n");
         return;
     }
 
     for (;;) {
-        ArquivoSd entrada = diretorio.abrirProximaEntrada();
-        if (!entrada.estaAberto()) {
+        EntradaDiretorio entrada = diretorio.proximaEntrada();
+        if (!entrada.valida()) {
             break;
         }
 
-        InformacoesEntradaFat info;
-        if (!entrada.obterInformacoes(info)) {
-            entrada.fechar();
+        const char* nome_exibicao = entrada.nome();
+        if (strcmp(nome_exibicao, ".") == 0 || strcmp(nome_exibicao, "..") == 0) {
             continue;
         }
 
-        if (strcmp(info.nome_curto, ".") == 0 || strcmp(info.nome_curto, "..") == 0) {
-            entrada.fechar();
-            continue;
-        }
-
-#if FF_USE_LFN
-        const char* nome_exibicao = info.nome_completo[0] != 0 ? info.nome_completo : info.nome_curto;
-#else
-        const char* nome_exibicao = info.nome_curto;
-#endif
-        bool eh_diretorio = (info.atributos & AM_DIR) != 0;
-    imprimirMensagem("%s%s\n", nome_exibicao, eh_diretorio ? "/" : "");
-        entrada.fechar();
+    imprimirMensagem("%s%s\n", nome_exibicao, entrada.eDiretorio() ? "/" : "");
     }
 
     diretorio.fechar();
@@ -659,19 +1137,222 @@ void MineBash::executarExibirArquivo(const char* argumento) {
         return;
     }
 
-    uint8_t buffer[TAMANHO_AUXILIAR];
+    // f_forward entrega o buffer de setor do arquivo direto à UART, sem cópia
+    // intermediária nem passagem pelo vsnprintf de imprimirMensagem.
+    PortaSerial::definirDestinoEncaminhamento(portaSerial);
+    bool encaminhou = true;
     for (;;) {
-        size_t lidos = arquivo.lerBytes(buffer, sizeof(buffer) - 1u);
-        if (lidos == 0u) {
+        UINT encaminhados = 0u;
+        encaminhou = arquivo.encaminharDados(&PortaSerial::encaminharBytes, BYTES_ENCAMINHAMENTO_EXIBICAO, encaminhados);
+        if (!encaminhou || encaminhados < BYTES_ENCAMINHAMENTO_EXIBICAO) {
             break;
         }
-        buffer[lidos] = 0;
-    imprimirMensagem("%s", reinterpret_cast<char*>(buffer));
     }
+    PortaSerial::definirDestinoEncaminhamento(nullptr);
     imprimirMensagem("\n");
+    if (!encaminhou) {
+        imprimirMensagem("Falha ao ler o arquivo.\n");
+    }
     arquivo.fechar();
 }
 
+void MineBash::executarLinhas(const char* argumento) {
+    if (argumento == nullptr || argumento[0] == 0) {
+        imprimirMensagem("Use: linhas <arquivo>\n");
+        return;
+    }
+
+    ArquivoSd arquivo = cartaoSd->abrir(argumento, MODO_LEITURA);
+    if (!arquivo.estaAberto()) {
+        imprimirMensagem("Falha ao abrir o arquivo.\n");
+        return;
+    }
+
+    LeitorLinhasSd leitor(arquivo, blocoLeitorLinhas, sizeof(blocoLeitorLinhas));
+    std::string_view linha;
+    size_t maior_linha = 0u;
+    uint64_t inicio_us = time_us_64();
+    while (leitor.proximaLinha(linha)) {
+        if (linha.size() > maior_linha) {
+            maior_linha = linha.size();
+        }
+    }
+    uint64_t tempo_us = time_us_64() - inicio_us;
+    bool falhou = leitor.falhou();
+    FRESULT resultado = arquivo.resultadoOperacao();
+    arquivo.fechar();
+
+    if (falhou) {
+        imprimirMensagem("Falha na leitura. Codigo erro: %d\n", resultado);
+        return;
+    }
+    EstatisticasLeitorLinhas estatisticas = leitor.obterEstatisticas();
+    imprimirMensagem("%lu linhas, %llu bytes, maior linha %lu bytes, %lu leituras de bloco, %llu ms\n",
+                     static_cast<unsigned long>(estatisticas.linhas),
+                     static_cast<unsigned long long>(estatisticas.bytes),
+                     static_cast<unsigned long>(maior_linha),
+                     static_cast<unsigned long>(estatisticas.leituras),
+                     static_cast<unsigned long long>(tempo_us / 1000u));
+    if (estatisticas.linhas_partidas > 0u) {
+        imprimirMensagem("%lu pedacos de linhas maiores que o bloco.\n", static_cast<unsigned long>(estatisticas.linhas_partidas));
+    }
+}
+
+// Simula um registrador: cada linha leva o índice, o tempo desde o início e uma
+// leitura em centésimos, formatados pelo EscritorBufferizadoSd em blocos de 4 KB.
+void MineBash::executarRegistrarCsv(const char* token_linhas, const char* argumento) {
+    char* fim_numero = nullptr;
+    unsigned long linhas = strtoul(token_linhas, &fim_numero, 10);
+    if (fim_numero == token_linhas || *fim_numero != 0 || linhas == 0u || linhas > LINHAS_MAXIMAS_CSV ||
+        argumento == nullptr || argumento[0] == 0) {
+        imprimirMensagem("Use: registrar_csv <linhas> <arquivo> (ate %lu linhas)\n", LINHAS_MAXIMAS_CSV);
+        return;
+    }
+
+    ArquivoSd arquivo = cartaoSd->abrir(argumento, MODO_ESCRITA);
+    if (!arquivo.estaAberto()) {
+        imprimirMensagem("Falha ao abrir o arquivo. Codigo erro: %d\n", cartaoSd->resultadoOperacao());
+        return;
+    }
+    // MODO_ESCRITA não trunca: sem isso um CSV menor deixaria o fim do anterior.
+    if (!arquivo.truncar()) {
+        imprimirMensagem("Falha ao truncar o arquivo. Codigo erro: %d\n", arquivo.resultadoOperacao());
+        arquivo.fechar();
+        return;
+    }
+
+    EscritorBufferizadoSd escritor(arquivo, blocoEscritorCsv, sizeof(blocoEscritorCsv));
+    uint64_t inicio_us = time_us_64();
+    bool escreveu = escritor.escreverTexto("indice,tempo_us,valor") && escritor.terminarLinha();
+    for (unsigned long indice = 0u; indice < linhas && escreveu; indice = indice + 1u) {
+        int32_t centesimos = static_cast<int32_t>((indice * 7919u) % 20000u) - 5000;
+        escreveu = escritor.escreverNatural(indice) &&
+                   escritor.escreverCaractere(',') &&
+                   escritor.escreverNatural(time_us_64() - inicio_us) &&
+                   escritor.escreverCaractere(',') &&
+                   escritor.escreverDecimal(centesimos, 2u) &&
+                   escritor.terminarLinha();
+    }
+    escreveu = escritor.descarregar() && escreveu;
+    uint64_t tempo_us = time_us_64() - inicio_us;
+    FRESULT resultado = arquivo.resultadoOperacao();
+    escreveu = arquivo.fechar() && escreveu;
+
+    if (!escreveu) {
+        imprimirMensagem("Falha na escrita. Codigo erro: %d\n", resultado);
+        return;
+    }
+    EstatisticasEscritorBufferizado estatisticas = escritor.obterEstatisticas();
+    uint64_t tempo_valido_us = tempo_us > 0u ? tempo_us : 1u;
+    imprimirMensagem("%lu linhas, %llu bytes em %llu ms (%lu linhas/s), %lu descargas, %lu alinhadas em setor\n",
+                     linhas,
+                     static_cast<unsigned long long>(estatisticas.bytes),
+                     static_cast<unsigned long long>(tempo_us / 1000u),
+                     static_cast<unsigned long>((static_cast<uint64_t>(linhas) * 1000000u) / tempo_valido_us),
+                     static_cast<unsigned long>(estatisticas.descargas),
+                     static_cast<unsigned long>(estatisticas.descargas_alinhadas));
+}
+
+// O arquivo fica aberto na tabela de descritores do CartaoSD entre comandos:
+// cada gravar só acrescenta, sem reabrir o arquivo nem buscar o fim.
+void MineBash::executarAbrir(const char* argumento) {
+    if (argumento == nullptr || argumento[0] == 0) {
+        imprimirMensagem("Use: abrir <arquivo>\n");
+        return;
+    }
+
+    int descritor = cartaoSd->abrirDescritor(argumento, MODO_LEITURA | MODO_ESCRITA | MODO_ACRESCENTAR);
+    if (descritor == DESCRITOR_INVALIDO) {
+        imprimirMensagem("Falha ao abrir o arquivo. Codigo erro: %d\n", cartaoSd->resultadoOperacao());
+        return;
+    }
+    imprimirMensagem("Descritor %d aberto para %s.\n", descritor, argumento);
+}
+
+void MineBash::executarGravar(const char* token_descritor, const char* texto) {
+    int descritor = converterDescritor(token_descritor);
+    if (descritor == DESCRITOR_INVALIDO || texto == nullptr || texto[0] == 0) {
+        imprimirMensagem("Use: gravar <descritor> <texto>\n");
+        return;
+    }
+
+    size_t tamanho_texto = strlen(texto);
+    size_t tamanho_quebra = strlen(QUEBRA_LINHA);
+    bool gravou = cartaoSd->escreverDescritor(descritor, reinterpret_cast<const uint8_t*>(texto), tamanho_texto) == tamanho_texto &&
+                  cartaoSd->escreverDescritor(descritor, reinterpret_cast<const uint8_t*>(QUEBRA_LINHA), tamanho_quebra) == tamanho_quebra;
+    if (!gravou) {
+        imprimirMensagem("Falha ao gravar no descritor %d. Codigo erro: %d\n", descritor, cartaoSd->resultadoOperacao());
+        return;
+    }
+    imprimirMensagem("%lu bytes gravados no descritor %d.\n",
+                     static_cast<unsigned long>(tamanho_texto + tamanho_quebra), descritor);
+}
+
+void MineBash::executarFechar(const char* token_descritor) {
+    int descritor = converterDescritor(token_descritor);
+    if (descritor == DESCRITOR_INVALIDO) {
+        imprimirMensagem("Use: fechar <descritor>\n");
+        return;
+    }
+
+    if (!cartaoSd->fecharDescritor(descritor)) {
+        imprimirMensagem("Falha ao fechar o descritor %d. Codigo erro: %d\n", descritor, cartaoSd->resultadoOperacao());
+        return;
+    }
+    imprimirMensagem("Descritor %d fechado.\n", descritor);
+}
+
+void MineBash::executarVelocidade() {
+    uint32_t frequencia_hz = cartaoSd->obterFrequenciaSpi();
+    imprimirMensagem("Frequencia SPI: %lu.%03lu MHz\n",
+                     static_cast<unsigned long>(frequencia_hz / 1000000u),
+                     static_cast<unsigned long>((frequencia_hz % 1000000u) / 1000u));
+    imprimirMensagem("Modo do cartao: %s\n", cartaoSd->estaEmAltaVelocidade() ? "alta velocidade" : "padrao");
+    imprimirMensagem("Motivo: %s\n", cartao_sd::descreverMotivoFrequencia(cartaoSd->obterMotivoFrequencia()));
+    imprimirMensagem("CRC: %s (%lu erros)\n",
+                     cartaoSd->estaComVerificacaoCrc() ? "ativo" : "inativo",
+                     static_cast<unsigned long>(cartaoSd->obterErrosCrc()));
+}
+
+void MineBash::executarDescarte(const char* argumento) {
+    if (strcmp(argumento, "ligar") == 0) {
+        cartaoSd->definirDescarte(true);
+    } else if (strcmp(argumento, "desligar") == 0) {
+        cartaoSd->definirDescarte(false);
+    } else if (argumento[0] != 0) {
+        imprimirMensagem("Use: descarte [ligar|desligar]\n");
+        return;
+    }
+
+    imprimirMensagem("Descarte de setores %s.\n", cartaoSd->descarteHabilitado() ? "ligado" : "desligado");
+}
+
+void MineBash::executarEspera(const char* argumento) {
+    if (strcmp(argumento, "varredura") == 0) {
+        cartaoSd->definirEstrategiaEspera(cartao_sd::EstrategiaEspera::Varredura);
+    } else if (strcmp(argumento, "evento") == 0) {
+        cartaoSd->definirEstrategiaEspera(cartao_sd::EstrategiaEspera::Evento);
+    } else if (strcmp(argumento, "zerar") == 0) {
+        cartaoSd->zerarEstatisticasEspera();
+    } else if (argumento[0] != 0) {
+        imprimirMensagem("Use: espera [varredura|evento|zerar]\n");
+        return;
+    }
+
+    bool por_evento = cartaoSd->obterEstrategiaEspera() == cartao_sd::EstrategiaEspera::Evento;
+    cartao_sd::EstatisticasEspera estatisticas = cartaoSd->obterEstatisticasEspera();
+
+    imprimirMensagem("Estrategia atual: %s\n", por_evento ? "evento" : "varredura");
+    imprimirMensagem("  varredura: %lu esperas, %llu us, %lu bytes\n",
+                     static_cast<unsigned long>(estatisticas.esperas_varredura),
+                     static_cast<unsigned long long>(estatisticas.tempo_varredura_us),
+                     static_cast<unsigned long>(estatisticas.bytes_varredura));
+    imprimirMensagem("  evento:    %lu esperas, %llu us, %lu bytes\n",
+                     static_cast<unsigned long>(estatisticas.esperas_evento),
+                     static_cast<unsigned long long>(estatisticas.tempo_evento_us),
+                     static_cast<unsigned long>(estatisticas.bytes_evento));
+}
+
 void MineBash::atualizarDiretorioAtual() {
     if (!cartaoRegistrado) {
         strncpy(diretorioAtual, CAMINHO_RAIZ, sizeof(diretorioAtual) - 1u);
@@ -814,3 +1495,369 @@ void MineBash::removerEspacosLaterais(char* texto) {
     texto[indice_destino] = 0;
 }
 
+void MineBash::executarCache(const char* argumento) {
+    if (strcmp(argumento, "direta") == 0) {
+        cartaoSd->definirPoliticaCache(cartao_sd::PoliticaCache::EscritaDireta);
+    } else if (strcmp(argumento, "adiada") == 0) {
+        cartaoSd->definirPoliticaCache(cartao_sd::PoliticaCache::EscritaAdiada);
+    } else if (strcmp(argumento, "zerar") == 0) {
+        cartaoSd->zerarEstatisticasCache();
+    } else if (argumento[0] != 0) {
+        imprimirMensagem("Use: cache [direta|adiada|zerar]\n");
+        return;
+    }
+
+    bool adiada = cartaoSd->obterPoliticaCache() == cartao_sd::PoliticaCache::EscritaAdiada;
+    cartao_sd::EstatisticasCache estatisticas = cartaoSd->obterEstatisticasCache();
+
+    imprimirMensagem("Politica de escrita: %s\n", adiada ? "adiada" : "direta");
+    imprimirMensagem("  acertos: %lu  falhas: %lu  despejos: %lu  descargas: %lu\n",
+                     static_cast<unsigned long>(estatisticas.acertos),
+                     static_cast<unsigned long>(estatisticas.falhas),
+                     static_cast<unsigned long>(estatisticas.despejos),
+                     static_cast<unsigned long>(estatisticas.descargas));
+}
+
+void MineBash::executarAntecipar(const char* argumento) {
+    if (strcmp(argumento, "ligar") == 0) {
+        cartaoSd->definirLeituraAntecipada(true);
+    } else if (strcmp(argumento, "desligar") == 0) {
+        cartaoSd->definirLeituraAntecipada(false);
+    } else if (strcmp(argumento, "zerar") == 0) {
+        cartaoSd->zerarEstatisticasLeituraAntecipada();
+    } else if (argumento[0] != 0) {
+        imprimirMensagem("Use: antecipar [ligar|desligar|zerar]\n");
+        return;
+    }
+
+    cartao_sd::EstatisticasLeituraAntecipada estatisticas = cartaoSd->obterEstatisticasLeituraAntecipada();
+
+    imprimirMensagem("Leitura antecipada: %s\n", cartaoSd->leituraAntecipadaHabilitada() ? "ligada" : "desligada");
+    imprimirMensagem("  antecipacoes: %lu  setores lidos: %lu  aproveitados: %lu  recuos: %lu\n",
+                     static_cast<unsigned long>(estatisticas.antecipacoes),
+                     static_cast<unsigned long>(estatisticas.setores_antecipados),
+                     static_cast<unsigned long>(estatisticas.setores_aproveitados),
+                     static_cast<unsigned long>(estatisticas.recuos));
+}
+
+void MineBash::executarAgrupar(const char* argumento) {
+    if (strcmp(argumento, "ligar") == 0) {
+        cartaoSd->definirAgrupamentoEscrita(true);
+    } else if (strcmp(argumento, "desligar") == 0) {
+        cartaoSd->definirAgrupamentoEscrita(false);
+    } else if (strcmp(argumento, "zerar") == 0) {
+        cartaoSd->zerarEstatisticasAgrupamento();
+    } else if (argumento[0] >= '0' && argumento[0] <= '9') {
+        cartaoSd->definirPrazoAgrupamento(static_cast<uint32_t>(strtoul(argumento, nullptr, 10)));
+    } else if (argumento[0] != 0) {
+        imprimirMensagem("Use: agrupar [ligar|desligar|zerar|<prazo_ms>]\n");
+        return;
+    }
+
+    cartao_sd::EstatisticasAgrupamento estatisticas = cartaoSd->obterEstatisticasAgrupamento();
+
+    imprimirMensagem("Agrupamento de escrita: %s (prazo %lu ms)\n",
+                     cartaoSd->agrupamentoEscritaHabilitado() ? "ligado" : "desligado",
+                     static_cast<unsigned long>(cartaoSd->obterPrazoAgrupamento()));
+    imprimirMensagem("  setores recebidos: %lu  gravados: %lu  rajadas: %lu\n",
+                     static_cast<unsigned long>(estatisticas.setores_recebidos),
+                     static_cast<unsigned long>(estatisticas.setores_gravados),
+                     static_cast<unsigned long>(estatisticas.rajadas));
+    imprimirMensagem("  descargas: sync %lu  cheio %lu  prazo %lu\n",
+                     static_cast<unsigned long>(estatisticas.descargas_sincronizacao),
+                     static_cast<unsigned long>(estatisticas.descargas_cheio),
+                     static_cast<unsigned long>(estatisticas.descargas_prazo));
+}
+
+void MineBash::executarInfoCartao() {
+    cartao_sd::InformacoesCartao informacoes = cartaoSd->obterInformacoesCartao();
+    if (!informacoes.csd_valido) {
+        imprimirMensagem("Cartao nao inicializado.\n");
+        return;
+    }
+
+    if (informacoes.cid_valido) {
+        const cartao_sd::IdentificacaoCartao &cid = informacoes.cid;
+        imprimirMensagem("CID:\n");
+        imprimirMensagem("  fabricante: 0x%02X  aplicacao: %s  produto: %s  revisao: %u.%u\n",
+                         cid.fabricante, cid.aplicacao, cid.produto, cid.revisao_maior, cid.revisao_menor);
+        imprimirMensagem("  serie: %08lX  fabricacao: %02u/%u\n",
+                         static_cast<unsigned long>(cid.numero_serie), cid.mes_fabricacao, cid.ano_fabricacao);
+    }
+
+    const cartao_sd::RegistroCsd &csd = informacoes.csd;
+    imprimirMensagem("CSD (versao %u):\n", csd.versao + 1u);
+    imprimirMensagem("  setores: %llu (%llu MB)  C_SIZE: %lu\n",
+                     static_cast<unsigned long long>(csd.quantidade_setores),
+                     static_cast<unsigned long long>(csd.quantidade_setores / 2048u),
+                     static_cast<unsigned long>(csd.c_size));
+    imprimirMensagem("  classes de comando: 0x%03X  TRAN_SPEED: 0x%02X  TAAC: 0x%02X  NSAC: %u\n",
+                     csd.classes_comando, csd.velocidade_transferencia, csd.taac, csd.nsac);
+    imprimirMensagem("  bloco leitura: %u B  bloco escrita: %u B  R2W: x%u\n",
+                     1u << csd.log2_bloco_leitura, 1u << csd.log2_bloco_escrita, 1u << csd.fator_escrita);
+    imprimirMensagem("  apagamento por bloco: %s  setor de apagamento: %u blocos\n",
+                     csd.apagamento_por_bloco ? "sim" : "nao", csd.setores_apagamento);
+    imprimirMensagem("  protecao: temporaria %s, permanente %s\n",
+                     csd.protecao_temporaria ? "sim" : "nao", csd.protecao_permanente ? "sim" : "nao");
+
+    if (!informacoes.status_valido) {
+        imprimirMensagem("SD Status indisponivel.\n");
+        return;
+    }
+
+    const cartao_sd::StatusSd &status = informacoes.status;
+    imprimirMensagem("SD Status:\n");
+    imprimirMensagem("  unidade de alocacao: %lu KB  (UHS: %lu KB)\n",
+                     static_cast<unsigned long>(status.setores_unidade_alocacao / 2u),
+                     static_cast<unsigned long>(status.setores_unidade_alocacao_uhs / 2u));
+    imprimirMensagem("  classe de velocidade: %u  UHS: U%u  video: V%u  aplicacao: A%u  movimento: %u MB/s\n",
+                     status.classe_velocidade, status.classe_uhs, status.classe_video,
+                     status.classe_aplicacao, status.desempenho_movimento_mbs);
+    imprimirMensagem("  apagamento: %u AUs em %u s (+%u s)\n",
+                     status.unidades_apagamento, status.tempo_apagamento_s, status.deslocamento_apagamento_s);
+}
+
+void MineBash::executarBench(const char* argumento) {
+    uint32_t tamanho_kb = TAMANHO_PADRAO_BANCADA_KB;
+    if (argumento[0] >= '0' && argumento[0] <= '9') {
+        tamanho_kb = static_cast<uint32_t>(strtoul(argumento, nullptr, 10));
+    } else if (argumento[0] != 0) {
+        imprimirMensagem("Use: bench [tamanho_kb]\n");
+        return;
+    }
+
+    if (tamanho_kb < TAMANHO_MINIMO_BANCADA_KB || tamanho_kb > TAMANHO_MAXIMO_BANCADA_KB) {
+        imprimirMensagem("Tamanho entre %lu e %lu KB.\n",
+                         static_cast<unsigned long>(TAMANHO_MINIMO_BANCADA_KB),
+                         static_cast<unsigned long>(TAMANHO_MAXIMO_BANCADA_KB));
+        return;
+    }
+
+    static uint8_t bloco[TAMANHO_BLOCO_BANCADA];
+    static ResultadoBancada resultados[8];
+    for (size_t indice = 0u; indice < sizeof(bloco); indice = indice + 1u) {
+        bloco[indice] = static_cast<uint8_t>('A' + (indice % 26u));
+    }
+
+    uint32_t blocos = (tamanho_kb * 1024u) / TAMANHO_BLOCO_BANCADA;
+    imprimirMensagem("Bench com %lu KB em %s (SPI %lu Hz)...\n",
+                     static_cast<unsigned long>(tamanho_kb), ARQUIVO_BANCADA,
+                     static_cast<unsigned long>(cartaoSd->obterFrequenciaSpi()));
+
+    bool sucesso = bancadaEscritaSequencial(*cartaoSd, bloco, blocos, resultados[0]) &&
+                   bancadaLeituraSequencial(*cartaoSd, bloco, blocos, resultados[1]) &&
+                   bancadaAleatoria(*cartaoSd, bloco, blocos, false, resultados[2]) &&
+                   bancadaAleatoria(*cartaoSd, bloco, blocos, true, resultados[3]) &&
+                   bancadaAcrescimo(*cartaoSd, bloco, resultados[4]) &&
+                   bancadaAcrescimoCurto(*cartaoSd, bloco, false, resultados[5]) &&
+                   bancadaAcrescimoCurto(*cartaoSd, bloco, true, resultados[6]) &&
+                   bancadaMetadados(*cartaoSd, resultados[7]);
+    cartaoSd->removerArquivo(ARQUIVO_BANCADA);
+
+    if (!sucesso) {
+        imprimirMensagem("Falha durante o bench. Codigo erro: %d\n", cartaoSd->resultadoOperacao());
+        return;
+    }
+
+    ArquivoSd csv = cartaoSd->abrir(ARQUIVO_RESULTADOS_BANCADA, MODO_ACRESCENTAR);
+    bool gravou_csv = csv.estaAberto();
+    if (gravou_csv && csv.tamanho() == 0) {
+        gravou_csv = csv.escreverLinha("compilacao,produto,serie,frequencia_hz,carga,operacoes,bytes,tempo_us,kb_s,iops,p50_us,p99_us,max_us\r\n");
+    }
+
+    cartao_sd::InformacoesCartao informacoes = cartaoSd->obterInformacoesCartao();
+    imprimirMensagem("%-22s %5s %9s %7s %8s %8s %8s\n", "carga", "ops", "MB/s", "IOPS", "p50 us", "p99 us", "max us");
+
+    for (ResultadoBancada& resultado : resultados) {
+        calcularPercentisBancada(resultado);
+        uint64_t tempo_us = resultado.tempo_us > 0u ? resultado.tempo_us : 1u;
+        unsigned long centesimos_mb_s = static_cast<unsigned long>((resultado.bytes * 100u) / tempo_us);
+        unsigned long iops = static_cast<unsigned long>((static_cast<uint64_t>(resultado.operacoes) * 1000000u) / tempo_us);
+
+        imprimirMensagem("%-22s %5lu %6lu.%02lu %7lu %8lu %8lu %8lu\n",
+                         resultado.nome,
+                         static_cast<unsigned long>(resultado.operacoes),
+                         centesimos_mb_s / 100u, centesimos_mb_s % 100u,
+                         iops,
+                         static_cast<unsigned long>(resultado.p50_us),
+                         static_cast<unsigned long>(resultado.p99_us),
+                         static_cast<unsigned long>(resultado.maximo_us));
+
+        if (gravou_csv) {
+            char linha[TAMANHO_AUXILIAR];
+            snprintf(linha, sizeof(linha), "%s %s,%s,%08lX,%lu,%s,%lu,%llu,%llu,%lu,%lu,%lu,%lu,%lu\r\n",
+                     __DATE__, __TIME__,
+                     informacoes.cid_valido ? informacoes.cid.produto : "",
+                     static_cast<unsigned long>(informacoes.cid_valido ? informacoes.cid.numero_serie : 0u),
+                     static_cast<unsigned long>(cartaoSd->obterFrequenciaSpi()),
+                     resultado.nome,
+                     static_cast<unsigned long>(resultado.operacoes),
+                     static_cast<unsigned long long>(resultado.bytes),
+                     static_cast<unsigned long long>(resultado.tempo_us),
+                     static_cast<unsigned long>((resultado.bytes * 1000u) / tempo_us),
+                     iops,
+                     static_cast<unsigned long>(resultado.p50_us),
+                     static_cast<unsigned long>(resultado.p99_us),
+                     static_cast<unsigned long>(resultado.maximo_us));
+            gravou_csv = csv.escreverLinha(linha);
+        }
+    }
+
+    gravou_csv = csv.fechar() && gravou_csv;
+    if (!gravou_csv) {
+        imprimirMensagem("Falha ao gravar %s.\n", ARQUIVO_RESULTADOS_BANCADA);
+        return;
+    }
+    imprimirMensagem("Resultados acrescentados em %s.\n", ARQUIVO_RESULTADOS_BANCADA);
+}
+
+void MineBash::executarPrealocar(const char* argumento) {
+    char caminho[TAMANHO_AUXILIAR];
+    size_t indice_origem = pularEspacos(argumento, 0u);
+    size_t indice_caminho = 0u;
+    while (argumento[indice_origem] != 0 && argumento[indice_origem] != ' ' && argumento[indice_origem] != '\t') {
+        if (indice_caminho + 1u < sizeof(caminho)) {
+            caminho[indice_caminho] = argumento[indice_origem];
+            indice_caminho = indice_caminho + 1u;
+        }
+        indice_origem = indice_origem + 1u;
+    }
+    caminho[indice_caminho] = 0;
+
+    indice_origem = pularEspacos(argumento, indice_origem);
+    char* fim_numero = nullptr;
+    unsigned long long tamanho_bytes = strtoull(argumento + indice_origem, &fim_numero, 10);
+    if (fim_numero != nullptr && (*fim_numero == 'k' || *fim_numero == 'K')) {
+        tamanho_bytes = tamanho_bytes * 1024u;
+        fim_numero = fim_numero + 1;
+    } else if (fim_numero != nullptr && (*fim_numero == 'm' || *fim_numero == 'M')) {
+        tamanho_bytes = tamanho_bytes * 1024u * 1024u;
+        fim_numero = fim_numero + 1;
+    }
+    if (caminho[0] == 0 || tamanho_bytes == 0u || fim_numero == argumento + indice_origem || *fim_numero != 0) {
+        imprimirMensagem("Use: prealocar <arquivo> <tamanho>[k|m]\n");
+        return;
+    }
+
+    uint64_t inicio_us = time_us_64();
+    if (!cartaoSd->prealocar(caminho, static_cast<FSIZE_t>(tamanho_bytes))) {
+        // FR_DENIED aqui costuma ser falta de uma área livre contígua do tamanho pedido.
+        imprimirMensagem("Falha ao pre-alocar. Codigo erro: %d\n", cartaoSd->resultadoOperacao());
+        return;
+    }
+    uint64_t tempo_us = time_us_64() - inicio_us;
+
+    ArquivoSd arquivo = cartaoSd->abrir(caminho, MODO_ESCRITA | MODO_PREALOCADO);
+    bool escrita_direta = arquivo.escritaDiretaAtiva();
+    arquivo.fechar();
+    imprimirMensagem("%s: %llu KB contiguos em %llu ms; escrita direta com MODO_PREALOCADO: %s\n",
+                     caminho,
+                     static_cast<unsigned long long>(tamanho_bytes / 1024u),
+                     static_cast<unsigned long long>(tempo_us / 1000u),
+                     escrita_direta ? "sim" : "nao");
+}
+
+void MineBash::executarEstresse(const char* argumento) {
+    uint32_t rodadas = RODADAS_PADRAO_ESTRESSE;
+    if (argumento[0] >= '0' && argumento[0] <= '9') {
+        rodadas = static_cast<uint32_t>(strtoul(argumento, nullptr, 10));
+    } else if (argumento[0] != 0) {
+        imprimirMensagem("Use: estresse [rodadas]\n");
+        return;
+    }
+    if (rodadas == 0u || rodadas > RODADAS_MAXIMAS_ESTRESSE) {
+        imprimirMensagem("Rodadas entre 1 e %lu.\n", static_cast<unsigned long>(RODADAS_MAXIMAS_ESTRESSE));
+        return;
+    }
+
+    if (!prepararArquivoComumEstresse(*cartaoSd)) {
+        imprimirMensagem("Falha ao criar %s. Codigo erro: %d\n", ARQUIVO_COMUM_ESTRESSE, cartaoSd->resultadoOperacao());
+        return;
+    }
+
+    memset(&contextoEstresse, 0, sizeof(contextoEstresse));
+    contextoEstresse.cartao = cartaoSd;
+    contextoEstresse.rodadas = rodadas;
+
+    imprimirMensagem("Estresse com %lu rodadas nos dois nucleos...\n", static_cast<unsigned long>(rodadas));
+    multicore_launch_core1_with_stack(nucleo1Estresse, pilhaNucleo1Estresse, sizeof(pilhaNucleo1Estresse));
+    executarCargaEstresse(0u);
+    multicore_fifo_pop_blocking();
+    multicore_reset_core1();
+
+    uint32_t falhas = 0u;
+    for (uint32_t nucleo = 0u; nucleo < 2u; nucleo = nucleo + 1u) {
+        const ResultadoEstresse& resultado = contextoEstresse.resultados[nucleo];
+        imprimirMensagem("  nucleo %lu: %lu rodadas  escritos %lu KB  lidos %lu KB  %llu ms  falhas %lu",
+                         static_cast<unsigned long>(nucleo),
+                         static_cast<unsigned long>(resultado.rodadas),
+                         static_cast<unsigned long>((resultado.blocos_escritos * TAMANHO_BLOCO_ESTRESSE) / 1024u),
+                         static_cast<unsigned long>((resultado.blocos_lidos * TAMANHO_BLOCO_ESTRESSE) / 1024u),
+                         static_cast<unsigned long long>(resultado.tempo_us / 1000u),
+                         static_cast<unsigned long>(resultado.falhas));
+        if (resultado.falhas > 0u) {
+            imprimirMensagem(" (primeiro erro %d)", resultado.primeiro_erro);
+        }
+        imprimirMensagem("\n");
+        falhas = falhas + resultado.falhas;
+    }
+
+    cartaoSd->removerArquivo("/estresse_0.dat");
+    cartaoSd->removerArquivo("/estresse_1.dat");
+    cartaoSd->removerArquivo(ARQUIVO_COMUM_ESTRESSE);
+    imprimirMensagem(falhas == 0u ? "Estresse concluido sem erros.\n" : "Estresse concluido com falhas.\n");
+}
+
+void MineBash::executarHistograma(const char* argumento) {
+#ifdef HABILITAR_HISTOGRAMAS_CARTAO_SD
+    if (strcmp(argumento, "zerar") == 0) {
+        cartaoSd->zerarHistogramasComandos();
+    } else if (argumento[0] != 0) {
+        imprimirMensagem("Use: histograma [zerar]\n");
+        return;
+    }
+
+    // Cada faixa mostra o limite superior e a contagem; faixas vazias são omitidas.
+    const cartao_sd::HistogramasComandos& histogramas = cartaoSd->obterHistogramasComandos();
+    bool algum = false;
+    for (size_t tipo = 0u; tipo < cartao_sd::QUANTIDADE_TIPOS_COMANDO; tipo = tipo + 1u) {
+        for (size_t fase = 0u; fase < cartao_sd::QUANTIDADE_FASES_COMANDO; fase = fase + 1u) {
+            cartao_sd::TipoComando tipo_comando = static_cast<cartao_sd::TipoComando>(tipo);
+            cartao_sd::FaseComando fase_comando = static_cast<cartao_sd::FaseComando>(fase);
+            const cartao_sd::HistogramaLatencia& histograma = histogramas.obter(tipo_comando, fase_comando);
+            if (histograma.amostras == 0u) {
+                continue;
+            }
+
+            algum = true;
+            imprimirMensagem("%-12s %-9s n=%lu max=%lu us\n ",
+                             cartao_sd::descreverTipoComando(tipo_comando),
+                             cartao_sd::descreverFaseComando(fase_comando),
+                             static_cast<unsigned long>(histograma.amostras),
+                             static_cast<unsigned long>(histograma.maximo_us));
+            for (size_t faixa = 0u; faixa < cartao_sd::QUANTIDADE_FAIXAS_HISTOGRAMA; faixa = faixa + 1u) {
+                if (histograma.faixas[faixa] == 0u) {
+                    continue;
+                }
+                uint32_t limite_us = cartao_sd::HistogramasComandos::limiteSuperiorFaixaUs(faixa);
+                bool ultima = faixa + 1u == cartao_sd::QUANTIDADE_FAIXAS_HISTOGRAMA;
+                if (limite_us >= 1000u) {
+                    imprimirMensagem(" %s%lums:%lu", ultima ? ">=" : "<", static_cast<unsigned long>((ultima ? limite_us / 2u : limite_us) / 1000u),
+                                     static_cast<unsigned long>(histograma.faixas[faixa]));
+                } else {
+                    imprimirMensagem(" <%luus:%lu", static_cast<unsigned long>(limite_us),
+                                     static_cast<unsigned long>(histograma.faixas[faixa]));
+                }
+            }
+            imprimirMensagem("\n");
+        }
+    }
+
+    if (!algum) {
+        imprimirMensagem("Nenhuma amostra registrada.\n");
+    }
+#else
+    (void)argumento;
+    imprimirMensagem("Histogramas desativados; compile com HABILITAR_HISTOGRAMAS_CARTAO_SD (CARTAO_SD_HISTOGRAMAS=ON).\n");
+#endif
+}
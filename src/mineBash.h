@@ -50,6 +50,22 @@ private:
     void executarSair();
     void executarEscreverArquivo(const char *argumento);
     void executarExibirArquivo(const char *argumento);
+    void executarEspera(const char *argumento);
+    void executarCache(const char *argumento);
+    void executarAntecipar(const char *argumento);
+    void executarAgrupar(const char *argumento);
+    void executarInfoCartao();
+    void executarBench(const char *argumento);
+    void executarEstresse(const char *argumento);
+    void executarPrealocar(const char *argumento);
+    void executarLinhas(const char *argumento);
+    void executarRegistrarCsv(const char *token_linhas, const char *argumento);
+    void executarAbrir(const char *argumento);
+    void executarGravar(const char *token_descritor, const char *texto);
+    void executarFechar(const char *token_descritor);
+    void executarHistograma(const char *argumento);
+    void executarDescarte(const char *argumento);
+    void executarVelocidade();
     void atualizarDiretorioAtual();
     const char *obterArgumento(const char *linha, size_t indice_inicio);
     size_t extrairToken(const char *linha, size_t indice_inicio, char *destino, size_t capacidade, size_t &indice_token_inicio, size_t &indice_token_fim);